@@ -0,0 +1,343 @@
+#include "DiskWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef HAS_SPDLOG
+#include <spdlog/spdlog.h>
+#endif
+
+DiskWriter::DiskWriter(size_t blockSize, size_t blockCount)
+    : blockSize_((std::max(blockSize, ALIGNMENT) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT)
+    , blockCount_(std::max<size_t>(2, blockCount))
+    , memory_(nullptr)
+    , freeBlocks_(blockCount_ + 1)
+    , fullBlocks_(blockCount_ + 1)
+    , current_(nullptr)
+    , fd_(-1)
+    , directIO_(false)
+    , fileOffset_(0)
+    , preallocatedTo_(0)
+    , preallocateSupported_(true)
+    , running_(false)
+    , bytesAccepted_(0)
+    , bytesWritten_(0)
+    , bytesDropped_(0)
+    , dropEvents_(0)
+    , blocksQueued_(0)
+    , peakBlocksQueued_(0)
+    , slowestWriteMs_(0)
+    , failed_(false) {
+    
+    // One allocation for the whole pool, page aligned so O_DIRECT can use it
+    memory_ = static_cast<uint8_t*>(std::aligned_alloc(ALIGNMENT, blockSize_ * blockCount_));
+    blocks_.resize(blockCount_);
+    for (size_t i = 0; i < blockCount_; i++) {
+        blocks_[i].data = memory_ + i * blockSize_;
+        blocks_[i].used = 0;
+    }
+}
+
+DiskWriter::~DiskWriter() {
+    close();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    std::free(memory_);
+}
+
+bool DiskWriter::open(const std::string& path, bool directIO) {
+    if (running_ || !memory_) {
+        return false;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    if (transform_) {
+        directIO = false;
+    }
+#ifdef O_DIRECT
+    if (directIO) {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        // Not every filesystem takes O_DIRECT (tmpfs, some FUSE); fall back
+        if (fd_ < 0 && errno == EINVAL) {
+            directIO = false;
+        }
+    }
+#else
+    directIO = false;
+#endif
+    if (fd_ < 0) {
+        fd_ = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        fail(std::string("Failed to create file: ") + strerror(errno));
+        return false;
+    }
+    
+    path_ = path;
+    directIO_ = directIO;
+    fileOffset_ = 0;
+    preallocatedTo_ = 0;
+    preallocateSupported_ = true;
+    bytesAccepted_ = 0;
+    bytesWritten_ = 0;
+    bytesDropped_ = 0;
+    dropEvents_ = 0;
+    blocksQueued_ = 0;
+    peakBlocksQueued_ = 0;
+    slowestWriteMs_ = 0;
+    failed_ = false;
+    
+    // Every block starts out free
+    freeBlocks_.reset();
+    fullBlocks_.reset();
+    for (size_t i = 0; i < blockCount_; i++) {
+        blocks_[i].used = 0;
+        freeBlocks_.write(&i, 1);
+    }
+    current_ = nullptr;
+    
+    preallocate(PREALLOCATE_STEP);
+    
+    running_ = true;
+    writerThread_ = std::thread(&DiskWriter::writerLoop, this);
+
+#ifdef HAS_SPDLOG
+    spdlog::debug("DiskWriter: {} ({} x {} KiB blocks{})", path, blockCount_, blockSize_ / 1024,
+                  directIO_ ? ", O_DIRECT" : "");
+#endif
+    return true;
+}
+
+void DiskWriter::close() {
+    if (!running_) {
+        return;
+    }
+    
+    // Hand over the partial block; the writer drains the queue before exiting
+    if (current_ && current_->used > 0) {
+        size_t index = current_ - blocks_.data();
+        blocksQueued_++;
+        fullBlocks_.write(&index, 1);
+    }
+    current_ = nullptr;
+    
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        running_ = false;
+    }
+    wake_.notify_one();
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+    
+    // Padding written for O_DIRECT and preallocated space beyond the data
+    if (ftruncate(fd_, static_cast<off_t>(bytesWritten_.load())) != 0) {
+        fail(std::string("Failed to truncate file: ") + strerror(errno));
+    }
+
+#ifdef O_DIRECT
+    // Later patches are small and unaligned
+    if (directIO_) {
+        fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+        directIO_ = false;
+    }
+#endif
+
+#ifdef HAS_SPDLOG
+    if (bytesDropped_ > 0) {
+        spdlog::warn("DiskWriter: {} dropped {} bytes in {} overruns, slowest write {} ms",
+                     path_, bytesDropped_.load(), dropEvents_.load(), slowestWriteMs_.load());
+    }
+#endif
+}
+
+bool DiskWriter::write(const void* data, size_t bytes) {
+    if (!running_) {
+        return false;
+    }
+    
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    bool queuedAny = false;
+    while (bytes > 0) {
+        if (!current_) {
+            size_t index;
+            if (!freeBlocks_.read(&index, 1)) {
+                // Disk is behind and every block is in flight
+                bytesDropped_ += bytes;
+                dropEvents_++;
+                break;
+            }
+            current_ = &blocks_[index];
+            current_->used = 0;
+        }
+        
+        size_t take = std::min(bytes, blockSize_ - current_->used);
+        std::memcpy(current_->data + current_->used, source, take);
+        current_->used += take;
+        bytesAccepted_ += take;
+        source += take;
+        bytes -= take;
+        
+        if (current_->used == blockSize_) {
+            // Count before publishing so the writer never decrements past zero
+            uint32_t queued = ++blocksQueued_;
+            uint32_t peak = peakBlocksQueued_.load(std::memory_order_relaxed);
+            while (queued > peak && !peakBlocksQueued_.compare_exchange_weak(peak, queued)) {
+            }
+            
+            size_t index = current_ - blocks_.data();
+            fullBlocks_.write(&index, 1);
+            current_ = nullptr;
+            queuedAny = true;
+        }
+    }
+    
+    // No lock on this side; a missed wakeup only costs the writer's poll interval
+    if (queuedAny) {
+        wake_.notify_one();
+    }
+    return bytes == 0;
+}
+
+void DiskWriter::writerLoop() {
+    for (;;) {
+        size_t index;
+        if (fullBlocks_.read(&index, 1)) {
+            blocksQueued_--;
+            Block& block = blocks_[index];
+            if (!failed_ && transform_) {
+                transformed_.clear();
+                transform_(block.data, block.used, transformed_);
+                writeData(transformed_.data(), transformed_.size(), transformed_.size());
+            } else if (!failed_) {
+                // Only the final block of a recording may be partial
+                writeBlock(block, block.used < blockSize_);
+            }
+            block.used = 0;
+            freeBlocks_.write(&index, 1);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        if (!running_ && fullBlocks_.getReadAvailable() == 0) {
+            break;
+        }
+        wake_.wait_for(lock, std::chrono::milliseconds(20));
+    }
+    
+    if (transform_ && !failed_) {
+        transformed_.clear();
+        transform_(nullptr, 0, transformed_);
+        writeData(transformed_.data(), transformed_.size(), transformed_.size());
+    }
+}
+
+bool DiskWriter::writeBlock(Block& block, bool last) {
+    size_t length = block.used;
+    if (directIO_ && last) {
+        // O_DIRECT needs whole sectors; close() truncates the padding away
+        size_t padded = (length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        std::memset(block.data + length, 0, padded - length);
+        length = padded;
+    }
+    return writeData(block.data, length, block.used);
+}
+
+bool DiskWriter::writeData(const uint8_t* data, size_t length, size_t payload) {
+    if (fileOffset_ + length > preallocatedTo_) {
+        preallocate(fileOffset_ + length + PREALLOCATE_STEP);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    size_t done = 0;
+    while (done < length) {
+        ssize_t result = pwrite(fd_, data + done, length - done,
+                                static_cast<off_t>(fileOffset_ + done));
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail(std::string("Write failed: ") + strerror(errno));
+            return false;
+        }
+        done += static_cast<size_t>(result);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    fileOffset_ += length;
+    bytesWritten_ += payload;
+    if (static_cast<uint32_t>(elapsed) > slowestWriteMs_) {
+        slowestWriteMs_ = static_cast<uint32_t>(elapsed);
+    }
+    return true;
+}
+
+void DiskWriter::preallocate(uint64_t upTo) {
+    if (!preallocateSupported_ || upTo <= preallocatedTo_) {
+        return;
+    }
+
+#ifdef __linux__
+    // Reserve extents ahead of the data so the filesystem does not allocate
+    // (and fragment) on every write; the visible size still tracks the data
+    if (fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(preallocatedTo_),
+                  static_cast<off_t>(upTo - preallocatedTo_)) == 0) {
+        preallocatedTo_ = upTo;
+        return;
+    }
+#else
+    (void)upTo;
+#endif
+    preallocateSupported_ = false;
+}
+
+bool DiskWriter::patch(uint64_t offset, const void* data, size_t bytes) {
+    if (running_ || fd_ < 0) {
+        return false;
+    }
+    if (pwrite(fd_, data, bytes, static_cast<off_t>(offset)) != static_cast<ssize_t>(bytes)) {
+        fail(std::string("Header update failed: ") + strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+DiskWriter::Stats DiskWriter::getStats() const {
+    Stats stats;
+    stats.bytesAccepted = bytesAccepted_;
+    stats.bytesWritten = bytesWritten_;
+    stats.bytesDropped = bytesDropped_;
+    stats.dropEvents = dropEvents_;
+    stats.blocksQueued = blocksQueued_;
+    stats.peakBlocksQueued = peakBlocksQueued_;
+    stats.slowestWriteMs = slowestWriteMs_;
+    return stats;
+}
+
+std::string DiskWriter::getError() const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    return error_;
+}
+
+void DiskWriter::fail(const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        error_ = error;
+    }
+    failed_ = true;
+
+#ifdef HAS_SPDLOG
+    spdlog::error("DiskWriter: {}: {}", path_, error);
+#endif
+}
@@ -0,0 +1,116 @@
+#ifndef DISK_WRITER_H
+#define DISK_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../core/RingBuffer.h"
+
+// Streams a recording to disk from a dedicated thread. The producer (USB or
+// DSP thread) copies into preallocated, page-aligned blocks and hands full
+// blocks over through a lock-free queue; it never blocks on the disk. If the
+// disk falls behind and every block is in flight, new data is dropped and
+// counted instead of stalling the caller.
+class DiskWriter {
+public:
+    struct Stats {
+        uint64_t bytesAccepted;     // handed to write()
+        uint64_t bytesWritten;      // on disk, after any transform
+        uint64_t bytesDropped;      // rejected because no block was free
+        uint32_t dropEvents;
+        uint32_t blocksQueued;      // full blocks waiting for the writer
+        uint32_t peakBlocksQueued;
+        uint32_t slowestWriteMs;
+    };
+    
+    // Runs on the writer thread over each block before it goes to disk, e.g.
+    // a compressor; called once more with no data to flush at the end
+    using Transform = std::function<void(const uint8_t* data, size_t bytes, std::vector<uint8_t>& out)>;
+    
+    explicit DiskWriter(size_t blockSize = DEFAULT_BLOCK_SIZE, size_t blockCount = DEFAULT_BLOCK_COUNT);
+    ~DiskWriter();
+    
+    // Only while closed; cleared again by passing an empty function
+    void setTransform(Transform transform) { transform_ = std::move(transform); }
+    
+    // directIO bypasses the page cache (O_DIRECT) where the filesystem allows
+    // it; not with a transform, whose output is not block aligned
+    bool open(const std::string& path, bool directIO = false);
+    
+    // Flushes what is buffered, stops the thread and closes the file
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+    
+    // Producer side, from a single thread. Returns false if (part of) the data
+    // had to be dropped.
+    bool write(const void* data, size_t bytes);
+    
+    // Overwrite bytes already on disk, e.g. a header's size fields. Only
+    // after close(), which leaves the file reachable for this call.
+    bool patch(uint64_t offset, const void* data, size_t bytes);
+    
+    Stats getStats() const;
+    bool hasFailed() const { return failed_; }
+    std::string getError() const;
+    
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+    static constexpr size_t DEFAULT_BLOCK_COUNT = 32;
+    
+private:
+    struct Block {
+        uint8_t* data;
+        size_t used;
+    };
+    
+    void writerLoop();
+    bool writeBlock(Block& block, bool last);
+    bool writeData(const uint8_t* data, size_t length, size_t payload);
+    void preallocate(uint64_t upTo);
+    void fail(const std::string& error);
+    
+    size_t blockSize_;
+    size_t blockCount_;
+    uint8_t* memory_;
+    std::vector<Block> blocks_;
+    
+    // Block indices: free ones travel writer -> producer, full ones back
+    RingBuffer<size_t> freeBlocks_;
+    RingBuffer<size_t> fullBlocks_;
+    Block* current_;                    // producer's fill block, may be null
+    Transform transform_;
+    std::vector<uint8_t> transformed_;  // writer thread only
+    
+    int fd_;
+    std::string path_;
+    bool directIO_;
+    uint64_t fileOffset_;               // writer thread only
+    uint64_t preallocatedTo_;
+    bool preallocateSupported_;
+    
+    std::thread writerThread_;
+    std::atomic<bool> running_;
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    
+    std::atomic<uint64_t> bytesAccepted_;
+    std::atomic<uint64_t> bytesWritten_;
+    std::atomic<uint64_t> bytesDropped_;
+    std::atomic<uint32_t> dropEvents_;
+    std::atomic<uint32_t> blocksQueued_;
+    std::atomic<uint32_t> peakBlocksQueued_;
+    std::atomic<uint32_t> slowestWriteMs_;
+    std::atomic<bool> failed_;
+    mutable std::mutex errorMutex_;
+    std::string error_;
+    
+    static constexpr size_t ALIGNMENT = 4096;
+    static constexpr uint64_t PREALLOCATE_STEP = 64ull * 1024 * 1024;
+};
+
+#endif // DISK_WRITER_H
@@ -0,0 +1,416 @@
+#include "FlacEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+// Frame header CRC-8, polynomial x^8 + x^2 + x + 1
+static const std::array<uint8_t, 256>& crc8Table() {
+    static const std::array<uint8_t, 256> table = [] {
+        std::array<uint8_t, 256> t{};
+        for (int i = 0; i < 256; i++) {
+            uint8_t crc = static_cast<uint8_t>(i);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+            }
+            t[i] = crc;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Frame footer CRC-16, polynomial x^16 + x^15 + x^2 + 1
+static const std::array<uint16_t, 256>& crc16Table() {
+    static const std::array<uint16_t, 256> table = [] {
+        std::array<uint16_t, 256> t{};
+        for (int i = 0; i < 256; i++) {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005) : static_cast<uint16_t>(crc << 1);
+            }
+            t[i] = crc;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// MSB-first bit packer appending to a byte vector
+class FlacEncoder::BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out), acc_(0), count_(0) {}
+    
+    void write(uint32_t value, uint32_t bits) {
+        if (bits == 0) {
+            return;
+        }
+        acc_ = (acc_ << bits) | (value & ((1ull << bits) - 1));
+        count_ += bits;
+        while (count_ >= 8) {
+            count_ -= 8;
+            out_.push_back(static_cast<uint8_t>(acc_ >> count_));
+        }
+    }
+    
+    void writeSigned(int32_t value, uint32_t bits) { write(static_cast<uint32_t>(value), bits); }
+    
+    // Quotient in unary (zeros, then a one), then the low k bits
+    void writeRice(uint32_t value, uint32_t k) {
+        uint32_t quotient = value >> k;
+        if (quotient + 1 + k <= 32) {
+            write((1u << k) | (value & ((1u << k) - 1)), quotient + 1 + k);
+            return;
+        }
+        while (quotient >= 32) {
+            write(0, 32);
+            quotient -= 32;
+        }
+        write(1, quotient + 1);
+        write(value, k);
+    }
+    
+    void alignToByte() {
+        if (count_ > 0) {
+            write(0, 8 - count_);
+        }
+    }
+    
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t acc_;
+    uint32_t count_;
+};
+
+static inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+FlacEncoder::FlacEncoder(uint32_t sampleRate, uint32_t channels, uint32_t bitsPerSample,
+                         uint32_t blockSize)
+    : sampleRate_(sampleRate)
+    , channels_(std::max<uint32_t>(1, std::min<uint32_t>(8, channels)))
+    , bitsPerSample_(bitsPerSample <= 8 ? 8 : (bitsPerSample <= 16 ? 16 : 24))
+    , bytesPerSample_(bitsPerSample_ / 8)
+    , blockSize_(std::max<uint32_t>(16, std::min<uint32_t>(65535, blockSize)))
+    , blockFill_(0)
+    , headerWritten_(false)
+    , frameNumber_(0)
+    , totalSamples_(0)
+    , minFrameBytes_(UINT32_MAX)
+    , maxFrameBytes_(0) {
+    
+    block_.resize(static_cast<size_t>(blockSize_) * channels_);
+    residual_.resize(blockSize_);
+}
+
+void FlacEncoder::encode(const uint8_t* data, size_t bytes, std::vector<uint8_t>& out) {
+    if (!headerWritten_) {
+        std::vector<uint8_t> header = streamHeader();
+        out.insert(out.end(), header.begin(), header.end());
+        headerWritten_ = true;
+    }
+    
+    const size_t frameBytes = static_cast<size_t>(bytesPerSample_) * channels_;
+    auto appendFrame = [&](const uint8_t* p) {
+        for (uint32_t ch = 0; ch < channels_; ch++) {
+            int32_t sample;
+            switch (bytesPerSample_) {
+                case 1:
+                    sample = static_cast<int32_t>(p[0]) - 128;
+                    break;
+                case 2:
+                    sample = static_cast<int16_t>(p[0] | (p[1] << 8));
+                    break;
+                default:
+                    sample = static_cast<int32_t>(static_cast<uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16)) << 8) >> 8;
+                    break;
+            }
+            block_[ch * blockSize_ + blockFill_] = sample;
+            p += bytesPerSample_;
+        }
+        if (++blockFill_ == blockSize_) {
+            encodeFrame(blockSize_, out);
+            blockFill_ = 0;
+        }
+    };
+    
+    // Complete an interleaved frame split across calls
+    while (!carry_.empty() && bytes > 0) {
+        carry_.push_back(*data++);
+        bytes--;
+        if (carry_.size() == frameBytes) {
+            appendFrame(carry_.data());
+            carry_.clear();
+        }
+    }
+    
+    while (bytes >= frameBytes) {
+        appendFrame(data);
+        data += frameBytes;
+        bytes -= frameBytes;
+    }
+    carry_.insert(carry_.end(), data, data + bytes);
+}
+
+void FlacEncoder::finish(std::vector<uint8_t>& out) {
+    if (!headerWritten_) {
+        std::vector<uint8_t> header = streamHeader();
+        out.insert(out.end(), header.begin(), header.end());
+        headerWritten_ = true;
+    }
+    if (blockFill_ > 0) {
+        encodeFrame(blockFill_, out);
+        blockFill_ = 0;
+    }
+    carry_.clear();
+}
+
+void FlacEncoder::encodeFrame(uint32_t samples, std::vector<uint8_t>& out) {
+    const size_t start = out.size();
+    BitWriter bits(out);
+    
+    // Frame header: sync, fixed blocking
+    bits.write(0x3FFE, 14);
+    bits.write(0, 1);
+    bits.write(0, 1);
+    
+    uint32_t sizeCode;
+    if (samples >= 256 && samples <= 32768 && (samples & (samples - 1)) == 0) {
+        sizeCode = 8;
+        while ((256u << (sizeCode - 8)) < samples) {
+            sizeCode++;
+        }
+    } else {
+        sizeCode = (samples <= 256) ? 6 : 7;
+    }
+    bits.write(sizeCode, 4);
+    bits.write(0, 4);                   // sample rate from STREAMINFO
+    bits.write(channels_ - 1, 4);       // independent channels
+    bits.write(bitsPerSample_ == 8 ? 1 : (bitsPerSample_ == 16 ? 4 : 6), 3);
+    bits.write(0, 1);
+    
+    // Frame number, UTF-8 style
+    uint32_t number = static_cast<uint32_t>(frameNumber_);
+    if (number < 0x80) {
+        bits.write(number, 8);
+    } else {
+        uint32_t length = 2;
+        while (length < 6 && number >= (1u << (5 * length + 1))) {
+            length++;
+        }
+        bits.write(((0xFF00u >> length) & 0xFF) | (number >> (6 * (length - 1))), 8);
+        for (uint32_t i = length - 1; i > 0; i--) {
+            bits.write(0x80 | ((number >> (6 * (i - 1))) & 0x3F), 8);
+        }
+    }
+    if (sizeCode == 6) {
+        bits.write(samples - 1, 8);
+    } else if (sizeCode == 7) {
+        bits.write(samples - 1, 16);
+    }
+    
+    uint8_t crc8 = 0;
+    for (size_t i = start; i < out.size(); i++) {
+        crc8 = crc8Table()[crc8 ^ out[i]];
+    }
+    bits.write(crc8, 8);
+    
+    for (uint32_t ch = 0; ch < channels_; ch++) {
+        encodeSubframe(bits, block_.data() + ch * blockSize_, samples);
+    }
+    bits.alignToByte();
+    
+    uint16_t crc16 = 0;
+    for (size_t i = start; i < out.size(); i++) {
+        crc16 = static_cast<uint16_t>((crc16 << 8) ^ crc16Table()[(crc16 >> 8) ^ out[i]]);
+    }
+    bits.write(crc16, 16);
+    
+    uint32_t frameBytes = static_cast<uint32_t>(out.size() - start);
+    minFrameBytes_ = std::min(minFrameBytes_, frameBytes);
+    maxFrameBytes_ = std::max(maxFrameBytes_, frameBytes);
+    totalSamples_ += samples;
+    frameNumber_++;
+}
+
+void FlacEncoder::encodeSubframe(BitWriter& bits, const int32_t* x, uint32_t count) {
+    // Silence and stuck inputs collapse to a single value
+    bool constant = true;
+    for (uint32_t i = 1; i < count && constant; i++) {
+        constant = (x[i] == x[0]);
+    }
+    if (constant) {
+        bits.write(0, 8);
+        bits.writeSigned(x[0], bitsPerSample_);
+        return;
+    }
+    
+    // Pick the fixed predictor order with the smallest total residual
+    uint32_t order = 0;
+    if (count > MAX_FIXED_ORDER) {
+        uint64_t sums[MAX_FIXED_ORDER + 1] = {0, 0, 0, 0, 0};
+        for (uint32_t i = MAX_FIXED_ORDER; i < count; i++) {
+            int32_t e0 = x[i];
+            int32_t e1 = e0 - x[i - 1];
+            int32_t e2 = e1 - (x[i - 1] - x[i - 2]);
+            int32_t e3 = e2 - (x[i - 1] - 2 * x[i - 2] + x[i - 3]);
+            int32_t e4 = e3 - (x[i - 1] - 3 * x[i - 2] + 3 * x[i - 3] - x[i - 4]);
+            sums[0] += std::abs(e0);
+            sums[1] += std::abs(e1);
+            sums[2] += std::abs(e2);
+            sums[3] += std::abs(e3);
+            sums[4] += std::abs(e4);
+        }
+        for (uint32_t k = 1; k <= MAX_FIXED_ORDER; k++) {
+            if (sums[k] < sums[order]) {
+                order = k;
+            }
+        }
+    }
+    
+    int32_t* residual = residual_.data();
+    for (uint32_t i = order; i < count; i++) {
+        int32_t prediction;
+        switch (order) {
+            case 0: prediction = 0; break;
+            case 1: prediction = x[i - 1]; break;
+            case 2: prediction = 2 * x[i - 1] - x[i - 2]; break;
+            case 3: prediction = 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3]; break;
+            default: prediction = 4 * x[i - 1] - 6 * x[i - 2] + 4 * x[i - 3] - x[i - 4]; break;
+        }
+        residual[i - order] = x[i] - prediction;
+    }
+    
+    // Rough Rice cost against storing the samples as they are
+    uint64_t magnitude = 0;
+    for (uint32_t i = 0; i < count - order; i++) {
+        magnitude += zigzag(residual[i]);
+    }
+    uint64_t mean = magnitude / std::max<uint32_t>(1, count - order);
+    uint32_t k = 0;
+    while ((2ull << k) <= mean) {
+        k++;
+    }
+    uint64_t estimate = static_cast<uint64_t>(count - order) * (k + 1) + (magnitude >> k) +
+                        order * bitsPerSample_;
+    if (estimate >= static_cast<uint64_t>(count) * bitsPerSample_) {
+        bits.write(1 << 1, 8);          // VERBATIM
+        for (uint32_t i = 0; i < count; i++) {
+            bits.writeSigned(x[i], bitsPerSample_);
+        }
+        return;
+    }
+    
+    bits.write((0x08 | order) << 1, 8); // FIXED, no wasted bits
+    for (uint32_t i = 0; i < order; i++) {
+        bits.writeSigned(x[i], bitsPerSample_);
+    }
+    writeResidual(bits, residual, count, order);
+}
+
+void FlacEncoder::writeResidual(BitWriter& bits, const int32_t* residual, uint32_t count, uint32_t order) {
+    // Largest partition order that divides the block and leaves room for the
+    // warm-up samples in the first partition
+    uint32_t maxOrder = 0;
+    while (maxOrder < MAX_PARTITION_ORDER && (count % (2u << maxOrder)) == 0 &&
+           (count >> (maxOrder + 1)) > order) {
+        maxOrder++;
+    }
+    
+    // Sums at the finest split, merged pairwise for the coarser ones
+    std::array<uint64_t, 1u << MAX_PARTITION_ORDER> sums;
+    const uint32_t finest = 1u << maxOrder;
+    const uint32_t partitionLength = count >> maxOrder;
+    uint32_t index = 0;
+    for (uint32_t p = 0; p < finest; p++) {
+        uint32_t end = (p + 1) * partitionLength - order;
+        uint64_t sum = 0;
+        for (; index < end; index++) {
+            sum += zigzag(residual[index]);
+        }
+        sums[p] = sum;
+    }
+    
+    auto riceParameter = [](uint64_t sum, uint32_t n) {
+        uint32_t k = 0;
+        while (k < 30 && (static_cast<uint64_t>(n) << (k + 1)) < sum) {
+            k++;
+        }
+        return k;
+    };
+    
+    uint32_t bestOrder = maxOrder;
+    uint64_t bestBits = UINT64_MAX;
+    for (int32_t p = static_cast<int32_t>(maxOrder); p >= 0; p--) {
+        const uint32_t partitions = 1u << p;
+        const uint32_t length = count >> p;
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < partitions; i++) {
+            uint32_t n = length - (i == 0 ? order : 0);
+            uint32_t k = riceParameter(sums[i], n);
+            total += 5 + static_cast<uint64_t>(n) * (k + 1) + (sums[i] >> k);
+        }
+        if (total < bestBits) {
+            bestBits = total;
+            bestOrder = static_cast<uint32_t>(p);
+        }
+        for (uint32_t i = 0; i < partitions / 2; i++) {
+            sums[i] = sums[2 * i] + sums[2 * i + 1];
+        }
+    }
+    
+    // Recompute the chosen split's parameters and write
+    const uint32_t partitions = 1u << bestOrder;
+    const uint32_t length = count >> bestOrder;
+    std::array<uint32_t, 1u << MAX_PARTITION_ORDER> parameters{};
+    uint32_t widest = 0;
+    index = 0;
+    for (uint32_t i = 0; i < partitions; i++) {
+        uint32_t n = length - (i == 0 ? order : 0);
+        uint64_t sum = 0;
+        for (uint32_t j = 0; j < n; j++) {
+            sum += zigzag(residual[index + j]);
+        }
+        parameters[i] = riceParameter(sum, n);
+        widest = std::max(widest, parameters[i]);
+        index += n;
+    }
+    
+    // Method 0 has 4-bit parameters up to 14; 24-bit input may need method 1
+    const uint32_t method = (widest > 14) ? 1 : 0;
+    bits.write(method, 2);
+    bits.write(bestOrder, 4);
+    index = 0;
+    for (uint32_t i = 0; i < partitions; i++) {
+        uint32_t n = length - (i == 0 ? order : 0);
+        bits.write(parameters[i], method ? 5 : 4);
+        for (uint32_t j = 0; j < n; j++) {
+            bits.writeRice(zigzag(residual[index + j]), parameters[i]);
+        }
+        index += n;
+    }
+}
+
+std::vector<uint8_t> FlacEncoder::streamHeader() const {
+    std::vector<uint8_t> header = {'f', 'L', 'a', 'C', 0x80, 0x00, 0x00, 34};
+    BitWriter bits(header);
+    
+    bits.write(blockSize_, 16);         // min block size
+    bits.write(blockSize_, 16);         // max block size
+    bits.write(minFrameBytes_ == UINT32_MAX ? 0 : minFrameBytes_, 24);
+    bits.write(maxFrameBytes_, 24);
+    bits.write(storedSampleRate(sampleRate_), 20);
+    bits.write(channels_ - 1, 3);
+    bits.write(bitsPerSample_ - 1, 5);
+    bits.write(static_cast<uint32_t>(totalSamples_ >> 32), 4);
+    bits.write(static_cast<uint32_t>(totalSamples_), 32);
+    
+    // MD5 left as zero: "not computed" is valid and saves a hash per sample
+    header.insert(header.end(), 16, 0);
+    return header;
+}
+
+uint32_t FlacEncoder::storedSampleRate(uint32_t sampleRate) {
+    return (sampleRate < (1u << 20)) ? sampleRate : 0;
+}
@@ -0,0 +1,68 @@
+#ifndef FLAC_ENCODER_H
+#define FLAC_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streaming FLAC encoder for recordings, with no external library. Uses the
+// fixed polynomial predictors (orders 0-4) and partitioned Rice residuals,
+// which is most of what FLAC gains on 8-bit IQ and noisy audio at a small
+// fraction of LPC's cost. Output is a plain FLAC stream that any decoder reads.
+//
+// Input is interleaved PCM in WAV byte layout: 8-bit unsigned (RTL-SDR IQ),
+// or 16/24-bit signed little endian.
+class FlacEncoder {
+public:
+    FlacEncoder(uint32_t sampleRate, uint32_t channels, uint32_t bitsPerSample,
+                uint32_t blockSize = DEFAULT_BLOCK_SIZE);
+    
+    // Appends encoded bytes to out; the first call also emits the stream header
+    void encode(const uint8_t* data, size_t bytes, std::vector<uint8_t>& out);
+    
+    // Encodes the remaining partial block
+    void finish(std::vector<uint8_t>& out);
+    
+    // "fLaC" plus STREAMINFO with the final sample count and frame sizes, to
+    // overwrite the start of the file once the stream is complete
+    std::vector<uint8_t> streamHeader() const;
+    
+    uint64_t getTotalSamples() const { return totalSamples_; }
+    
+    // STREAMINFO has 20 bits for the rate. Faster IQ rates are stored as 0,
+    // which FLAC allows for non-audio streams, and the real rate goes in the
+    // SigMF sidecar
+    static uint32_t storedSampleRate(uint32_t sampleRate);
+    
+    static constexpr uint32_t DEFAULT_BLOCK_SIZE = 4096;
+    
+private:
+    class BitWriter;
+    
+    void encodeFrame(uint32_t samples, std::vector<uint8_t>& out);
+    void encodeSubframe(BitWriter& bits, const int32_t* samples, uint32_t count);
+    void writeResidual(BitWriter& bits, const int32_t* residual, uint32_t count, uint32_t order);
+    
+    uint32_t sampleRate_;
+    uint32_t channels_;
+    uint32_t bitsPerSample_;
+    uint32_t bytesPerSample_;
+    uint32_t blockSize_;
+    
+    // Deinterleaved block being filled, one run of blockSize_ per channel
+    std::vector<int32_t> block_;
+    uint32_t blockFill_;
+    std::vector<uint8_t> carry_;        // partial interleaved frame between calls
+    std::vector<int32_t> residual_;
+    
+    bool headerWritten_;
+    uint64_t frameNumber_;
+    uint64_t totalSamples_;
+    uint32_t minFrameBytes_;
+    uint32_t maxFrameBytes_;
+    
+    static constexpr uint32_t MAX_PARTITION_ORDER = 6;
+    static constexpr uint32_t MAX_FIXED_ORDER = 4;
+};
+
+#endif // FLAC_ENCODER_H
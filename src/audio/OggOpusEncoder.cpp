@@ -0,0 +1,232 @@
+#include "OggOpusEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+#ifdef HAS_OPUS
+#include <opus.h>
+#endif
+
+// Ogg page CRC-32, polynomial 0x04C11DB7, unreflected, zero initial value
+static const std::array<uint32_t, 256>& oggCrcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i << 24;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+            }
+            t[i] = crc;
+        }
+        return t;
+    }();
+    return table;
+}
+
+static void putLE(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+OggOpusEncoder::OggOpusEncoder(uint32_t sampleRate, uint32_t channels, int bitrate, int complexity)
+    : sampleRate_(sampleRate)
+    , channels_(channels)
+    , frameSize_(sampleRate / 50)
+    , granuleScale_(sampleRate > 0 ? 48000 / sampleRate : 1)
+    , encoder_(nullptr)
+    , preSkip_(0)
+    , frameFill_(0)
+    , pagePackets_(0)
+    , serial_(static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count()))
+    , pageSequence_(0)
+    , headerWritten_(false)
+    , samplesIn_(0)
+    , samplesEncoded_(0) {
+    
+#ifdef HAS_OPUS
+    int error = OPUS_OK;
+    encoder_ = opus_encoder_create(static_cast<opus_int32>(sampleRate), static_cast<int>(channels),
+                                   OPUS_APPLICATION_VOIP, &error);
+    if (error != OPUS_OK) {
+        encoder_ = nullptr;
+        return;
+    }
+    
+    opus_encoder_ctl(encoder_, OPUS_SET_BITRATE(bitrate));
+    opus_encoder_ctl(encoder_, OPUS_SET_COMPLEXITY(complexity));
+    opus_encoder_ctl(encoder_, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
+    opus_encoder_ctl(encoder_, OPUS_SET_DTX(1));
+    
+    opus_int32 lookahead = 0;
+    opus_encoder_ctl(encoder_, OPUS_GET_LOOKAHEAD(&lookahead));
+    preSkip_ = static_cast<uint16_t>(lookahead * granuleScale_);
+#else
+    (void)bitrate;
+    (void)complexity;
+#endif
+    
+    frame_.resize(frameSize_ * channels_);
+    packet_.resize(4000);   // libopus' recommended maximum packet size
+}
+
+OggOpusEncoder::~OggOpusEncoder() {
+#ifdef HAS_OPUS
+    if (encoder_) {
+        opus_encoder_destroy(encoder_);
+    }
+#endif
+}
+
+bool OggOpusEncoder::isAvailable() {
+#ifdef HAS_OPUS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void OggOpusEncoder::encode(const uint8_t* data, size_t bytes, std::vector<uint8_t>& out) {
+    if (!encoder_) {
+        return;
+    }
+    if (!headerWritten_) {
+        writeHeaders(out);
+    }
+    
+    // Rejoin a sample split across calls
+    if (!carry_.empty() && bytes > 0) {
+        addSample(static_cast<int16_t>(carry_[0] | (data[0] << 8)), out);
+        carry_.clear();
+        data++;
+        bytes--;
+    }
+    
+    for (size_t i = 0; i + 1 < bytes; i += 2) {
+        addSample(static_cast<int16_t>(data[i] | (data[i + 1] << 8)), out);
+    }
+    if (bytes % 2) {
+        carry_.push_back(data[bytes - 1]);
+    }
+}
+
+void OggOpusEncoder::finish(std::vector<uint8_t>& out) {
+    if (!encoder_) {
+        return;
+    }
+    if (!headerWritten_) {
+        writeHeaders(out);
+    }
+    
+    // Pad out the last frame, plus enough silence to flush the encoder's
+    // lookahead; the end granule trims the padding off again on decode
+    const uint64_t endGranule = preSkip_ + (samplesIn_ / channels_) * granuleScale_;
+    while (frameFill_ > 0 || samplesEncoded_ * granuleScale_ < endGranule) {
+        std::fill(frame_.begin() + frameFill_, frame_.end(), int16_t(0));
+        encodeFrame(out);
+    }
+    flushPage(out, 0x04, endGranule);
+}
+
+void OggOpusEncoder::writeHeaders(std::vector<uint8_t>& out) {
+    headerWritten_ = true;
+    
+    // Identification header, alone on the first page
+    std::vector<uint8_t> head = {'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1};
+    head.push_back(static_cast<uint8_t>(channels_));
+    putLE(head, preSkip_, 2);
+    putLE(head, sampleRate_, 4);
+    putLE(head, 0, 2);          // output gain
+    head.push_back(0);          // mapping family: mono/stereo
+    addPacket(head.data(), head.size(), out);
+    flushPage(out, 0x02, 0);
+    
+    // Comment header
+    static const char vendor[] = "vintage-tactical-radio";
+    std::vector<uint8_t> tags = {'O', 'p', 'u', 's', 'T', 'a', 'g', 's'};
+    putLE(tags, sizeof(vendor) - 1, 4);
+    tags.insert(tags.end(), vendor, vendor + sizeof(vendor) - 1);
+    putLE(tags, 0, 4);          // no user comments
+    addPacket(tags.data(), tags.size(), out);
+    flushPage(out, 0x00, 0);
+}
+
+void OggOpusEncoder::addSample(int16_t value, std::vector<uint8_t>& out) {
+    frame_[frameFill_++] = value;
+    samplesIn_++;
+    if (frameFill_ == frame_.size()) {
+        encodeFrame(out);
+    }
+}
+
+void OggOpusEncoder::encodeFrame(std::vector<uint8_t>& out) {
+    frameFill_ = 0;
+    
+    // Close the page before adding to it, so finish() always has a packet
+    // left for the end-of-stream page
+    if (pagePackets_ >= PACKETS_PER_PAGE) {
+        flushPage(out, 0x00, samplesEncoded_ * granuleScale_);
+    }
+    
+#ifdef HAS_OPUS
+    opus_int32 bytes = opus_encode(encoder_, frame_.data(), static_cast<int>(frameSize_),
+                                   packet_.data(), static_cast<opus_int32>(packet_.size()));
+    if (bytes < 0) {
+        // Keep the timeline intact with a TOC-only packet, decoded as a gap:
+        // config 1 (SILK narrowband, 20 ms), one frame, so it covers the
+        // same 20 ms the granule position advances by
+        packet_[0] = 0x08;
+        bytes = 1;
+    }
+    addPacket(packet_.data(), static_cast<size_t>(bytes), out);
+#endif
+    
+    samplesEncoded_ += frameSize_;
+}
+
+void OggOpusEncoder::addPacket(const uint8_t* packet, size_t bytes, std::vector<uint8_t>& out) {
+    // A page holds at most 255 lacing values
+    if (lacing_.size() + bytes / 255 + 1 > 255) {
+        flushPage(out, 0x00, samplesEncoded_ * granuleScale_);
+    }
+    
+    pageBody_.insert(pageBody_.end(), packet, packet + bytes);
+    for (size_t n = bytes; ; n -= 255) {
+        if (n < 255) {
+            lacing_.push_back(static_cast<uint8_t>(n));
+            break;
+        }
+        lacing_.push_back(255);
+    }
+    pagePackets_++;
+}
+
+void OggOpusEncoder::flushPage(std::vector<uint8_t>& out, uint8_t flags, uint64_t granule) {
+    size_t start = out.size();
+    const uint8_t capture[4] = {'O', 'g', 'g', 'S'};
+    out.insert(out.end(), capture, capture + 4);
+    out.push_back(0);           // version
+    out.push_back(flags);
+    putLE(out, granule, 8);
+    putLE(out, serial_, 4);
+    putLE(out, pageSequence_++, 4);
+    putLE(out, 0, 4);           // CRC, filled in below
+    out.push_back(static_cast<uint8_t>(lacing_.size()));
+    out.insert(out.end(), lacing_.begin(), lacing_.end());
+    out.insert(out.end(), pageBody_.begin(), pageBody_.end());
+    
+    const std::array<uint32_t, 256>& table = oggCrcTable();
+    uint32_t crc = 0;
+    for (size_t i = start; i < out.size(); i++) {
+        crc = (crc << 8) ^ table[((crc >> 24) ^ out[i]) & 0xFF];
+    }
+    for (int i = 0; i < 4; i++) {
+        out[start + 22 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+    
+    lacing_.clear();
+    pageBody_.clear();
+    pagePackets_ = 0;
+}
@@ -0,0 +1,75 @@
+#ifndef OGG_OPUS_ENCODER_H
+#define OGG_OPUS_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct OpusEncoder;
+
+// Streaming Ogg Opus encoder for long-running voice logs. libopus does the
+// coding; the Ogg pages are written here. Tuned for speech: VoIP mode, a low
+// fixed bitrate and DTX, so squelched (silent) stretches shrink to a byte or
+// two per frame. Complexity caps the per-stream CPU when many run at once.
+//
+// Input is interleaved 16-bit signed little endian PCM at 8, 12, 16, 24 or
+// 48 kHz. Built without libopus (HAS_OPUS unset), isValid() is always false.
+class OggOpusEncoder {
+public:
+    OggOpusEncoder(uint32_t sampleRate, uint32_t channels,
+                   int bitrate = DEFAULT_BITRATE, int complexity = DEFAULT_COMPLEXITY);
+    ~OggOpusEncoder();
+    
+    OggOpusEncoder(const OggOpusEncoder&) = delete;
+    OggOpusEncoder& operator=(const OggOpusEncoder&) = delete;
+    
+    bool isValid() const { return encoder_ != nullptr; }
+    
+    // Appends whole Ogg pages to out; the first call also emits the headers
+    void encode(const uint8_t* data, size_t bytes, std::vector<uint8_t>& out);
+    
+    // Pads and encodes the last frame and closes the stream
+    void finish(std::vector<uint8_t>& out);
+    
+    static bool isAvailable();
+    
+    static constexpr int DEFAULT_BITRATE = 16000;
+    static constexpr int DEFAULT_COMPLEXITY = 5;
+    
+private:
+    void writeHeaders(std::vector<uint8_t>& out);
+    void addSample(int16_t value, std::vector<uint8_t>& out);
+    void encodeFrame(std::vector<uint8_t>& out);
+    void addPacket(const uint8_t* packet, size_t bytes, std::vector<uint8_t>& out);
+    
+    // Granule: 48 kHz samples decoded up to the end of the page's last packet,
+    // pre-skip included
+    void flushPage(std::vector<uint8_t>& out, uint8_t flags, uint64_t granule);
+    
+    uint32_t sampleRate_;
+    uint32_t channels_;
+    uint32_t frameSize_;                // samples per channel in a 20 ms frame
+    uint32_t granuleScale_;             // granules are always 48 kHz samples
+    OpusEncoder* encoder_;
+    uint16_t preSkip_;
+    
+    std::vector<int16_t> frame_;        // interleaved frame being filled
+    size_t frameFill_;                  // values (not frames) in frame_
+    std::vector<uint8_t> carry_;        // odd byte between calls
+    std::vector<uint8_t> packet_;
+    
+    // Ogg page being built
+    std::vector<uint8_t> pageBody_;
+    std::vector<uint8_t> lacing_;
+    uint32_t pagePackets_;
+    uint32_t serial_;
+    uint32_t pageSequence_;
+    
+    bool headerWritten_;
+    uint64_t samplesIn_;                // values in, all channels
+    uint64_t samplesEncoded_;           // per channel at the input rate, padding included
+    
+    static constexpr uint32_t PACKETS_PER_PAGE = 50;   // one page a second
+};
+
+#endif // OGG_OPUS_ENCODER_H
@@ -0,0 +1,390 @@
+#include "RecordingCatalog.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#ifdef HAS_SPDLOG
+#include <spdlog/spdlog.h>
+#endif
+
+static const char CATALOG_MAGIC[4] = {'V', 'T', 'R', 'C'};
+
+// Copies UTF-8 into a fixed field, NUL padded; false if it had to be cut
+template<size_t N>
+static bool putString(char (&field)[N], const QString& value) {
+    QByteArray utf8 = value.toUtf8();
+    size_t length = std::min(static_cast<size_t>(utf8.size()), N - 1);
+    std::memset(field, 0, N);
+    std::memcpy(field, utf8.constData(), length);
+    return length == static_cast<size_t>(utf8.size());
+}
+
+template<size_t N>
+static QString getString(const char (&field)[N]) {
+    return QString::fromUtf8(field, static_cast<int>(std::find(field, field + N, '\0') - field));
+}
+
+RecordingCatalog::RecordingCatalog()
+    : map_(nullptr)
+    , capacity_(0)
+    , longestMs_(0) {
+}
+
+RecordingCatalog::~RecordingCatalog() {
+    close();
+}
+
+bool RecordingCatalog::open(const QString& directory) {
+    close();
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+    QDir().mkpath(directory_);
+    QString path = directory_ + "/" + FILE_NAME;
+    file_.setFileName(path);
+    
+    bool existing = QFileInfo(path).exists() && QFileInfo(path).size() > 0;
+    if (!file_.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    
+    if (existing) {
+        Header header;
+        qint64 records = (file_.size() - static_cast<qint64>(sizeof(Header))) / static_cast<qint64>(sizeof(Record));
+        bool valid = file_.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header) &&
+                     std::memcmp(header.magic, CATALOG_MAGIC, 4) == 0 &&
+                     header.version == VERSION &&
+                     header.recordSize == sizeof(Record) &&
+                     records >= 0 && header.count <= static_cast<uint64_t>(records);
+        
+        if (!valid) {
+            // Keep the unreadable file for inspection and start over
+            file_.close();
+            QFile::remove(path + ".bad");
+            QFile::rename(path, path + ".bad");
+#ifdef HAS_SPDLOG
+            spdlog::warn("Recording catalog {} unreadable, rebuilding", path.toStdString());
+#endif
+            if (!file_.open(QIODevice::ReadWrite)) {
+                return false;
+            }
+            existing = false;
+        } else if (!map(static_cast<uint64_t>(records))) {
+            file_.close();
+            return false;
+        }
+    }
+    
+    if (!existing) {
+        if (!create()) {
+            file_.close();
+            return false;
+        }
+        buildIndexes();
+        importDirectory();
+        return true;
+    }
+    
+    buildIndexes();
+    return true;
+}
+
+void RecordingCatalog::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unmap();
+    if (file_.isOpen()) {
+        file_.close();
+    }
+    byTime_.clear();
+    byFrequency_.clear();
+    longestMs_ = 0;
+}
+
+bool RecordingCatalog::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return map_ != nullptr;
+}
+
+size_t RecordingCatalog::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return byTime_.size();
+}
+
+bool RecordingCatalog::create() {
+    file_.resize(0);
+    
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CATALOG_MAGIC, 4);
+    header.version = VERSION;
+    header.recordSize = sizeof(Record);
+    header.count = 0;
+    if (!file_.seek(0) ||
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+    return map(GROWTH);
+}
+
+bool RecordingCatalog::map(uint64_t capacity) {
+    qint64 bytes = static_cast<qint64>(sizeof(Header) + capacity * sizeof(Record));
+    if (file_.size() < bytes && !file_.resize(bytes)) {
+        return false;
+    }
+    
+    map_ = file_.map(0, bytes);
+    capacity_ = map_ ? capacity : 0;
+    return map_ != nullptr;
+}
+
+void RecordingCatalog::unmap() {
+    if (map_) {
+        file_.unmap(map_);
+        map_ = nullptr;
+    }
+    capacity_ = 0;
+}
+
+void RecordingCatalog::importDirectory() {
+    QDir dir(directory_);
+    QStringList files = dir.entryList(QStringList() << "*.wav" << "*.flac" << "*.opus" << "*.mp3",
+                                      QDir::Files, QDir::Name);
+    
+    for (const QString& name : files) {
+        QFileInfo info(dir.filePath(name));
+        Entry entry;
+        entry.fileName = name;
+        entry.start = info.lastModified();
+        entry.durationSeconds = 0.0;
+        entry.frequency = 0.0;
+        entry.ctcssTone = 0.0f;
+        entry.bytes = info.size();
+        
+        // Our own names carry "<MHz>MHz", followed by the mode for manual
+        // recordings
+        QStringList parts = info.completeBaseName().split('_');
+        for (int i = 0; i < parts.size(); i++) {
+            if (parts[i].endsWith("MHz")) {
+                entry.frequency = parts[i].left(parts[i].size() - 3).toDouble() * 1e6;
+                if (i + 1 < parts.size() && !parts[i + 1].isEmpty() && !parts[i + 1][0].isDigit()) {
+                    entry.mode = parts[i + 1];
+                }
+                break;
+            }
+        }
+        
+        appendLocked(entry);
+    }
+    
+#ifdef HAS_SPDLOG
+    spdlog::info("Recording catalog created with {} existing recordings", byTime_.size());
+#endif
+}
+
+bool RecordingCatalog::append(const Entry& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return appendLocked(entry);
+}
+
+bool RecordingCatalog::appendLocked(const Entry& entry) {
+    if (!map_) {
+        return false;
+    }
+    
+    Record r;
+    std::memset(&r, 0, sizeof(r));
+    if (!putString(r.fileName, QDir(directory_).relativeFilePath(entry.fileName))) {
+#ifdef HAS_SPDLOG
+        spdlog::warn("Recording name too long for the catalog: {}", entry.fileName.toStdString());
+#endif
+        return false;
+    }
+    putString(r.mode, entry.mode);
+    putString(r.programService, entry.programService);
+    r.startMs = entry.start.toMSecsSinceEpoch();
+    r.durationMs = static_cast<uint32_t>(std::clamp(entry.durationSeconds * 1000.0, 0.0, 4294967295.0));
+    r.ctcssTone = entry.ctcssTone;
+    r.frequency = entry.frequency;
+    r.bytes = entry.bytes;
+    
+    uint64_t count = reinterpret_cast<const Header*>(map_)->count;
+    if (count == capacity_) {
+        uint64_t capacity = capacity_ + GROWTH;
+        unmap();
+        if (!map(capacity)) {
+            return false;
+        }
+    }
+    
+    // The record first, then the count that makes it visible
+    std::memcpy(map_ + sizeof(Header) + count * sizeof(Record), &r, sizeof(r));
+    reinterpret_cast<Header*>(map_)->count = count + 1;
+    
+    insertIndexes(static_cast<uint32_t>(count));
+    return true;
+}
+
+const RecordingCatalog::Record& RecordingCatalog::record(uint32_t index) const {
+    return reinterpret_cast<const Record*>(map_ + sizeof(Header))[index];
+}
+
+void RecordingCatalog::buildIndexes() {
+    uint32_t count = map_ ? static_cast<uint32_t>(reinterpret_cast<const Header*>(map_)->count) : 0;
+    
+    byTime_.resize(count);
+    longestMs_ = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        byTime_[i] = i;
+        longestMs_ = std::max(longestMs_, record(i).durationMs);
+    }
+    byFrequency_ = byTime_;
+    
+    std::stable_sort(byTime_.begin(), byTime_.end(), [this](uint32_t a, uint32_t b) {
+        return record(a).startMs < record(b).startMs;
+    });
+    std::stable_sort(byFrequency_.begin(), byFrequency_.end(), [this](uint32_t a, uint32_t b) {
+        return record(a).frequency < record(b).frequency;
+    });
+}
+
+void RecordingCatalog::insertIndexes(uint32_t index) {
+    const Record& r = record(index);
+    longestMs_ = std::max(longestMs_, r.durationMs);
+    
+    // Usually the newest, so the insert is at or near the end
+    auto time = std::upper_bound(byTime_.begin(), byTime_.end(), r.startMs, [this](int64_t start, uint32_t i) {
+        return start < record(i).startMs;
+    });
+    byTime_.insert(time, index);
+    
+    auto frequency = std::upper_bound(byFrequency_.begin(), byFrequency_.end(), r.frequency,
+                                      [this](double f, uint32_t i) {
+        return f < record(i).frequency;
+    });
+    byFrequency_.insert(frequency, index);
+}
+
+bool RecordingCatalog::matches(const Record& r, const Query& query, int64_t fromMs, int64_t toMs) const {
+    if (r.startMs > toMs || r.startMs + static_cast<int64_t>(r.durationMs) < fromMs) {
+        return false;
+    }
+    if (query.lowFrequency > 0.0 && r.frequency < query.lowFrequency) {
+        return false;
+    }
+    if (query.highFrequency > 0.0 && r.frequency > query.highFrequency) {
+        return false;
+    }
+    if (query.toneOnly && r.ctcssTone <= 0.0f) {
+        return false;
+    }
+    return query.mode.isEmpty() || getString(r.mode) == query.mode;
+}
+
+RecordingCatalog::Entry RecordingCatalog::toEntry(const Record& r) const {
+    Entry entry;
+    entry.fileName = getString(r.fileName);
+    entry.start = QDateTime::fromMSecsSinceEpoch(r.startMs);
+    entry.durationSeconds = r.durationMs / 1000.0;
+    entry.frequency = r.frequency;
+    entry.mode = getString(r.mode);
+    entry.ctcssTone = r.ctcssTone;
+    entry.programService = getString(r.programService);
+    entry.bytes = r.bytes;
+    return entry;
+}
+
+std::vector<RecordingCatalog::Entry> RecordingCatalog::query(const Query& query) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Entry> entries;
+    if (!map_) {
+        return entries;
+    }
+    
+    const int64_t fromMs = query.from.isValid() ? query.from.toMSecsSinceEpoch()
+                                                : std::numeric_limits<int64_t>::min() / 2;
+    const int64_t toMs = query.to.isValid() ? query.to.toMSecsSinceEpoch()
+                                            : std::numeric_limits<int64_t>::max() / 2;
+    
+    // Candidates by start time: nothing that started longer ago than the
+    // longest recording can still be running at from
+    auto timeBegin = std::lower_bound(byTime_.begin(), byTime_.end(), fromMs - static_cast<int64_t>(longestMs_),
+                                      [this](uint32_t i, int64_t start) {
+        return record(i).startMs < start;
+    });
+    auto timeEnd = std::upper_bound(timeBegin, byTime_.end(), toMs, [this](int64_t start, uint32_t i) {
+        return start < record(i).startMs;
+    });
+    
+    // and by frequency
+    const double low = query.lowFrequency;
+    const double high = query.highFrequency > 0.0 ? query.highFrequency : std::numeric_limits<double>::max();
+    auto frequencyBegin = std::lower_bound(byFrequency_.begin(), byFrequency_.end(), low,
+                                           [this](uint32_t i, double f) {
+        return record(i).frequency < f;
+    });
+    auto frequencyEnd = std::upper_bound(frequencyBegin, byFrequency_.end(), high, [this](double f, uint32_t i) {
+        return f < record(i).frequency;
+    });
+    
+    // Walk whichever range is narrower
+    std::vector<uint32_t> found;
+    if (frequencyEnd - frequencyBegin < timeEnd - timeBegin) {
+        for (auto it = frequencyBegin; it != frequencyEnd; ++it) {
+            if (matches(record(*it), query, fromMs, toMs)) {
+                found.push_back(*it);
+            }
+        }
+        std::stable_sort(found.begin(), found.end(), [this](uint32_t a, uint32_t b) {
+            return record(a).startMs < record(b).startMs;
+        });
+    } else {
+        for (auto it = timeBegin; it != timeEnd; ++it) {
+            if (matches(record(*it), query, fromMs, toMs)) {
+                found.push_back(*it);
+            }
+        }
+    }
+    
+    size_t first = 0;
+    if (query.limit > 0 && found.size() > static_cast<size_t>(query.limit)) {
+        first = found.size() - query.limit;
+    }
+    entries.reserve(found.size() - first);
+    for (size_t i = first; i < found.size(); i++) {
+        entries.push_back(toEntry(record(found[i])));
+    }
+    return entries;
+}
+
+bool RecordingCatalog::exportJson(const QString& path, const Query& query) const {
+    QJsonArray array;
+    for (const Entry& entry : this->query(query)) {
+        QJsonObject json;
+        json["file"] = entry.fileName;
+        json["start"] = entry.start.toUTC().toString(Qt::ISODateWithMs);
+        json["duration"] = entry.durationSeconds;
+        json["frequency"] = entry.frequency;
+        json["mode"] = entry.mode;
+        if (entry.ctcssTone > 0.0f) {
+            json["ctcss"] = entry.ctcssTone;
+        }
+        if (!entry.programService.isEmpty()) {
+            json["rds_ps"] = entry.programService;
+        }
+        json["bytes"] = entry.bytes;
+        array.append(json);
+    }
+    
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(array).toJson(QJsonDocument::Indented));
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef RECORDING_CATALOG_H
+#define RECORDING_CATALOG_H
+
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Index of the recordings in one directory, kept in a compact binary file
+// (catalog.vtrc) beside them so that finding "all traffic on 155.xxx last
+// night" does not mean listing and stat-ing thousands of files.
+//
+// The file is a 64-byte header followed by fixed 256-byte records, one per
+// recording, appended as each file is closed. It is memory-mapped and grown
+// in chunks, so appending is a copy into the mapping followed by bumping the
+// count in the header, which is what commits the record. Reads go straight
+// to the mapping through two in-memory indexes, by start time and by
+// frequency, rebuilt when the catalog is opened.
+//
+// Safe to use from several threads; recordings are closed on the GUI thread
+// and on the triggered recording worker.
+class RecordingCatalog {
+public:
+    struct Entry {
+        QString fileName;           // relative to the catalog directory
+        QDateTime start;
+        double durationSeconds;
+        double frequency;           // Hz
+        QString mode;
+        float ctcssTone;            // Hz, 0 for none
+        QString programService;     // RDS PS, empty for none
+        qint64 bytes;
+    };
+    
+    // Zero frequencies and invalid times leave that side open. A recording
+    // matches the time range if any part of it falls inside.
+    struct Query {
+        double lowFrequency = 0.0;
+        double highFrequency = 0.0;
+        QDateTime from;
+        QDateTime to;
+        QString mode;               // empty for any
+        bool toneOnly = false;      // only recordings with a CTCSS tone
+        int limit = 0;              // keep only the most recent; 0 for all
+    };
+    
+    RecordingCatalog();
+    ~RecordingCatalog();
+    
+    RecordingCatalog(const RecordingCatalog&) = delete;
+    RecordingCatalog& operator=(const RecordingCatalog&) = delete;
+    
+    // Opens or creates the catalog of a directory. A new catalog starts with
+    // the recordings already there, with what their names tell.
+    bool open(const QString& directory);
+    void close();
+    bool isOpen() const;
+    
+    // fileName may be absolute; it is stored relative to the directory.
+    // Fails for names longer than the record holds.
+    bool append(const Entry& entry);
+    
+    // Matching entries in start-time order
+    std::vector<Entry> query(const Query& query) const;
+    size_t size() const;
+    
+    // Matching entries as a JSON array, for other tools
+    bool exportJson(const QString& path, const Query& query) const;
+    
+    static constexpr const char* FILE_NAME = "catalog.vtrc";
+    
+private:
+    // On-disk layout; native (little-endian on every supported target)
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t reserved0;
+        uint64_t count;             // committed records
+        uint8_t reserved[40];
+    };
+    
+    struct Record {
+        int64_t startMs;            // since the epoch, UTC
+        uint32_t durationMs;
+        float ctcssTone;
+        double frequency;
+        int64_t bytes;
+        uint8_t reserved[8];
+        char mode[16];              // UTF-8, NUL padded
+        char programService[16];
+        char fileName[184];
+    };
+    
+    bool create();
+    bool map(uint64_t capacity);
+    void unmap();
+    void importDirectory();
+    void buildIndexes();
+    void insertIndexes(uint32_t index);
+    bool appendLocked(const Entry& entry);
+    
+    const Record& record(uint32_t index) const;
+    Entry toEntry(const Record& record) const;
+    bool matches(const Record& record, const Query& query, int64_t fromMs, int64_t toMs) const;
+    
+    mutable std::mutex mutex_;
+    QString directory_;
+    QFile file_;
+    uchar* map_;
+    uint64_t capacity_;             // records the mapping has room for
+    
+    std::vector<uint32_t> byTime_;
+    std::vector<uint32_t> byFrequency_;
+    uint32_t longestMs_;            // bounds the time-index search
+    
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t GROWTH = 4096;    // records added per resize
+    
+    static_assert(sizeof(Header) == 64, "catalog header layout");
+    static_assert(sizeof(Record) == 256, "catalog record layout");
+};
+
+#endif // RECORDING_CATALOG_H
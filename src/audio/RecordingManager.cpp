@@ -3,7 +3,14 @@
 #include <QTimer>
 #include <QDir>
 #include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <chrono>
 #include <cstring>
+#include <thread>
 
 #ifdef HAS_SPDLOG
 #include <spdlog/spdlog.h>
@@ -12,34 +19,51 @@
 RecordingManager::RecordingManager(QObject* parent)
     : QObject(parent)
     , isRecording_(false)
-    , timeShiftWritePos_(0)
+    , writer_(std::make_unique<DiskWriter>())
+    , activeProducers_(0)
+    , directIO_(false)
+    , reportedDropped_(0)
+    , headerBytes_(0)
+    , opusBitrate_(OggOpusEncoder::DEFAULT_BITRATE)
+    , iqSampleRate_(2400000)
+    , iqGain_(0.0)
+    , channelIQ_(CHANNEL_QUEUE_BYTES)
+    , channelTap_(false)
+    , channelDropped_(0)
+    , channelPosition_(0)
     , timeShiftEnabled_(false)
-    , dataChunkSizePos_(0)
-    , fileSizePos_(0) {
+    , timeShiftSaving_(false)
+    , playbackActive_(false)
+    , playbackPos_(0)
+    , triggerFrequency_(0.0)
+    , triggerActive_(false)
+    , triggerOpen_(false)
+    , triggerEdges_(64)
+    , sharedCatalog_(nullptr)
+    , lastTone_(0.0f)
+    , wavSampleRate_(0)
+    , wavChannels_(0)
+    , wavBitDepth_(0) {
     
     // Set default recording directory
     recordingDirectory_ = QDir::homePath() + "/VintageRadio/Recordings";
     QDir().mkpath(recordingDirectory_);
+    catalog_.open(recordingDirectory_);
     
     // Initialize timers
     updateTimer_ = new QTimer(this);
     updateTimer_->setInterval(1000); // Update every second
     connect(updateTimer_, &QTimer::timeout, this, &RecordingManager::onUpdateTimer);
-    
-    scheduledTimer_ = new QTimer(this);
-    scheduledTimer_->setSingleShot(true);
-    connect(scheduledTimer_, &QTimer::timeout, this, &RecordingManager::onScheduledTimer);
-    
-    // Pre-allocate time-shift buffer
-    if (timeShiftEnabled_) {
-        timeShiftBuffer_.resize(TIME_SHIFT_BUFFER_SIZE);
-    }
 }
 
 RecordingManager::~RecordingManager() {
     if (isRecording_) {
         stopRecording();
     }
+    stopTriggeredRecording();
+    if (timeShiftSaveThread_.joinable()) {
+        timeShiftSaveThread_.join();
+    }
 }
 
 bool RecordingManager::startRecording(const QString& fileName, Format format, RecordingType type,
@@ -60,6 +84,28 @@ bool RecordingManager::startRecording(const QString& fileName, Format format, Re
         fullPath += ".wav";
     } else if (format == Format::IQ_WAV && !fullPath.endsWith(".wav")) {
         fullPath += "_iq.wav";
+    } else if (format == Format::FLAC && !fullPath.endsWith(".flac")) {
+        fullPath += ".flac";
+    } else if (format == Format::IQ_FLAC && !fullPath.endsWith(".flac")) {
+        fullPath += "_iq.flac";
+    } else if (format == Format::OPUS && !fullPath.endsWith(".opus")) {
+        fullPath += ".opus";
+    }
+    
+    // IQ is always the tuner's unsigned 8-bit pairs at the device rate
+    if (type == RecordingType::IQ) {
+        sampleRate = iqSampleRate_;
+        bitDepth = 8;
+    }
+    
+    // Opus takes 16-bit audio only
+    if (format == Format::OPUS) {
+        if (!OggOpusEncoder::isAvailable()) {
+            emit recordingError("Built without Opus support");
+            return false;
+        }
+        type = RecordingType::AUDIO;
+        bitDepth = 16;
     }
     
     // Initialize recording info
@@ -72,24 +118,71 @@ bool RecordingManager::startRecording(const QString& fileName, Format format, Re
     currentRecording_.mode = mode;
     currentRecording_.sampleRate = sampleRate;
     currentRecording_.bitDepth = bitDepth;
+    lastTone_ = 0.0f;
     
-    // For now, only implement WAV recording
-    if (format == Format::WAV || format == Format::IQ_WAV) {
-        recordingFile_ = std::make_unique<QFile>(fullPath);
-        if (!recordingFile_->open(QIODevice::WriteOnly)) {
-            emit recordingError("Failed to create file: " + recordingFile_->errorString());
+    if (format == Format::WAV || format == Format::IQ_WAV ||
+        format == Format::FLAC || format == Format::IQ_FLAC || format == Format::OPUS) {
+        // IQ pairs are two channels; the demodulated audio path is mono
+        const int channels = (type == RecordingType::IQ) ? 2 : 1;
+        
+        // FLAC and Opus are encoded on the writer thread, block by block
+        const bool flac = (format == Format::FLAC || format == Format::IQ_FLAC);
+        const bool opus = (format == Format::OPUS);
+        flacEncoder_.reset();
+        opusEncoder_.reset();
+        if (opus) {
+            opusEncoder_ = std::make_unique<OggOpusEncoder>(sampleRate, channels, opusBitrate_);
+            if (!opusEncoder_->isValid()) {
+                opusEncoder_.reset();
+                emit recordingError(QString("Opus cannot encode at %1 Hz").arg(sampleRate));
+                return false;
+            }
+            OggOpusEncoder* encoder = opusEncoder_.get();
+            writer_->setTransform([encoder](const uint8_t* data, size_t bytes, std::vector<uint8_t>& out) {
+                if (bytes > 0) {
+                    encoder->encode(data, bytes, out);
+                } else {
+                    encoder->finish(out);
+                }
+            });
+        } else if (flac) {
+            flacEncoder_ = std::make_unique<FlacEncoder>(sampleRate, channels, bitDepth);
+            FlacEncoder* encoder = flacEncoder_.get();
+            writer_->setTransform([encoder](const uint8_t* data, size_t bytes, std::vector<uint8_t>& out) {
+                if (bytes > 0) {
+                    encoder->encode(data, bytes, out);
+                } else {
+                    encoder->finish(out);
+                }
+            });
+        } else {
+            writer_->setTransform(nullptr);
+        }
+        
+        if (!writer_->open(fullPath.toStdString(), directIO_)) {
+            emit recordingError(QString::fromStdString(writer_->getError()));
             return false;
         }
         
-        // Create WAV file with appropriate settings
-        int channels = (type == RecordingType::IQ) ? 2 : 2; // Stereo for both
-        if (!createWavFile(fullPath, sampleRate, channels, bitDepth)) {
-            recordingFile_->close();
-            recordingFile_.reset();
+        if (flac || opus) {
+            wavSampleRate_ = sampleRate;
+            wavChannels_ = channels;
+            wavBitDepth_ = bitDepth;
+            headerBytes_ = 0;
+        } else if (!createWavFile(sampleRate, channels, bitDepth)) {
+            writer_->close();
             emit recordingError("Failed to create WAV header");
             return false;
         }
         
+        captures_.clear();
+        captures_.push_back({0, frequency, currentRecording_.startTime});
+        annotations_.clear();
+        if (type == RecordingType::IQ) {
+            writeSigMFMeta();
+        }
+        
+        reportedDropped_ = 0;
         isRecording_ = true;
         recordingStartTime_ = QDateTime::currentDateTime();
         updateTimer_->start();
@@ -116,10 +209,34 @@ void RecordingManager::stopRecording() {
     isRecording_ = false;
     updateTimer_->stop();
     
-    if (recordingFile_ && recordingFile_->isOpen()) {
-        // Finalize WAV file
-        finalizeWavFile();
-        recordingFile_->close();
+    // A producer that saw isRecording_ just before it went false may still be
+    // queueing its last block
+    while (activeProducers_ > 0) {
+        std::this_thread::yield();
+    }
+    stopChannels();
+    
+    if (writer_->isOpen()) {
+        // Drain the queue, then fix up the container header
+        writer_->close();
+        if (flacEncoder_) {
+            std::vector<uint8_t> header = flacEncoder_->streamHeader();
+            writer_->patch(0, header.data(), header.size());
+        } else if (!opusEncoder_) {
+            // Ogg pages are complete as written
+            finalizeWavFile();
+        }
+        if (currentRecording_.type == RecordingType::IQ) {
+            writeSigMFMeta();
+        }
+        
+        DiskWriter::Stats stats = writer_->getStats();
+        currentRecording_.bytesWritten = stats.bytesWritten > headerBytes_ ?
+                                         stats.bytesWritten - headerBytes_ : 0;
+        catalogRecording(currentRecording_.fileName, currentRecording_.startTime,
+                         recordingStartTime_.msecsTo(QDateTime::currentDateTime()) / 1000.0,
+                         currentRecording_.frequency, currentRecording_.mode, lastTone_,
+                         static_cast<qint64>(stats.bytesWritten));
         
         emit recordingStopped(currentRecording_.fileName, currentRecording_.bytesWritten);
         
@@ -127,94 +244,83 @@ void RecordingManager::stopRecording() {
         spdlog::info("Stopped recording: {}, {} bytes written", 
                     currentRecording_.fileName.toStdString(), 
                     currentRecording_.bytesWritten);
+        if (stats.bytesDropped > 0) {
+            spdlog::warn("Recording dropped {} bytes; peak queue {} blocks, slowest write {} ms",
+                        stats.bytesDropped, stats.peakBlocksQueued, stats.slowestWriteMs);
+        }
 #endif
     }
-    
-    recordingFile_.reset();
 }
 
 void RecordingManager::writeAudioData(const float* data, size_t samples) {
-    if (!isRecording_ || currentRecording_.type != RecordingType::AUDIO) {
-        // Update time-shift buffer even when not recording
-        if (timeShiftEnabled_) {
-            updateTimeShiftBuffer(data, samples);
-        }
-        return;
+    activeProducers_++;
+    
+    // Update time-shift buffer even when not recording
+    if (timeShiftEnabled_) {
+        timeShift_->write(data, samples);
     }
     
-    if (!recordingFile_ || !recordingFile_->isOpen()) {
+    if (!isRecording_ || currentRecording_.type != RecordingType::AUDIO) {
+        activeProducers_--;
         return;
     }
     
-    // Convert float samples to appropriate bit depth
-    QByteArray buffer;
+    // Convert float samples to appropriate bit depth, reusing one buffer
+    const size_t bytesPerSample = (currentRecording_.bitDepth == 24) ? 3 : sizeof(int16_t);
+    if (conversionBuffer_.size() < samples * bytesPerSample) {
+        conversionBuffer_.resize(samples * bytesPerSample);
+    }
     
-    if (currentRecording_.bitDepth == 16) {
-        // Convert to 16-bit signed integers
-        buffer.resize(samples * sizeof(int16_t));
-        int16_t* outData = reinterpret_cast<int16_t*>(buffer.data());
+    if (currentRecording_.bitDepth == 24) {
+        // Convert to 24-bit signed integers
+        uint8_t* outData = conversionBuffer_.data();
         
         for (size_t i = 0; i < samples; i++) {
             float sample = data[i];
             // Clamp to [-1, 1]
             if (sample > 1.0f) sample = 1.0f;
             if (sample < -1.0f) sample = -1.0f;
-            // Convert to int16
-            outData[i] = static_cast<int16_t>(sample * 32767.0f);
+            // Convert to int32 then extract lower 24 bits
+            int32_t sample32 = static_cast<int32_t>(sample * 8388607.0f);
+            outData[i * 3] = sample32 & 0xFF;
+            outData[i * 3 + 1] = (sample32 >> 8) & 0xFF;
+            outData[i * 3 + 2] = (sample32 >> 16) & 0xFF;
         }
-    } else if (currentRecording_.bitDepth == 24) {
-        // Convert to 24-bit signed integers
-        buffer.resize(samples * 3);
-        uint8_t* outData = reinterpret_cast<uint8_t*>(buffer.data());
+    } else {
+        // Convert to 16-bit signed integers
+        int16_t* outData = reinterpret_cast<int16_t*>(conversionBuffer_.data());
         
         for (size_t i = 0; i < samples; i++) {
             float sample = data[i];
             // Clamp to [-1, 1]
             if (sample > 1.0f) sample = 1.0f;
             if (sample < -1.0f) sample = -1.0f;
-            // Convert to int32 then extract lower 24 bits
-            int32_t sample32 = static_cast<int32_t>(sample * 8388607.0f);
-            outData[i * 3] = sample32 & 0xFF;
-            outData[i * 3 + 1] = (sample32 >> 8) & 0xFF;
-            outData[i * 3 + 2] = (sample32 >> 16) & 0xFF;
+            // Convert to int16
+            outData[i] = static_cast<int16_t>(sample * 32767.0f);
         }
     }
     
-    // Write to file
-    qint64 written = recordingFile_->write(buffer);
-    if (written > 0) {
-        currentRecording_.bytesWritten += written;
-    }
-    
-    // Update time-shift buffer
-    if (timeShiftEnabled_) {
-        updateTimeShiftBuffer(data, samples);
-    }
+    // Queued for the writer thread; drops are counted there
+    writer_->write(conversionBuffer_.data(), samples * bytesPerSample);
+    activeProducers_--;
 }
 
 void RecordingManager::writeIQData(const uint8_t* data, size_t bytes) {
-    if (!isRecording_ || currentRecording_.type != RecordingType::IQ) {
-        return;
-    }
-    
-    if (!recordingFile_ || !recordingFile_->isOpen()) {
-        return;
-    }
-    
-    // For IQ data, we need to convert from unsigned 8-bit to signed values
-    // and potentially interleave as I/Q pairs
-    QByteArray buffer(reinterpret_cast<const char*>(data), bytes);
-    
-    qint64 written = recordingFile_->write(buffer);
-    if (written > 0) {
-        currentRecording_.bytesWritten += written;
+    activeProducers_++;
+    if (isRecording_ && currentRecording_.type == RecordingType::IQ) {
+        // Straight from the USB buffer into the writer's block, no copy on the heap
+        writer_->write(data, bytes);
+        
+        // A full channel queue costs the channel logs the block, never the recording
+        if (channelTap_ && !channelIQ_.write(data, bytes)) {
+            channelDropped_ += bytes;
+        }
     }
+    activeProducers_--;
 }
 
-bool RecordingManager::createWavFile(const QString& fileName, int sampleRate, int channels, int bitDepth) {
-    Q_UNUSED(fileName);
-    
-    if (!recordingFile_ || !recordingFile_->isOpen()) {
+bool RecordingManager::createWavFile(int sampleRate, int channels, int bitDepth) {
+    if (!writer_->isOpen()) {
         return false;
     }
     
@@ -222,175 +328,789 @@ bool RecordingManager::createWavFile(const QString& fileName, int sampleRate, in
     wavChannels_ = channels;
     wavBitDepth_ = bitDepth;
     
-    // Write WAV header
-    writeWavHeader();
-    
-    return true;
+    // Sizes are zero until finalizeWavFile() patches them in; the header
+    // keeps its length either way, so the patch fits exactly
+    QByteArray header = buildWavHeader(0, sampleRate, channels, bitDepth,
+                                       currentRecording_.type == RecordingType::IQ);
+    headerBytes_ = header.size();
+    return writer_->write(header.constData(), header.size());
 }
 
-void RecordingManager::writeWavHeader() {
-    QDataStream stream(recordingFile_.get());
+QByteArray RecordingManager::buildWavHeader(quint64 dataBytes, int sampleRate, int channels, int bitDepth,
+                                            bool iq, const QDateTime& stopTime) const {
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
     stream.setByteOrder(QDataStream::LittleEndian);
     
+    const quint16 blockAlign = channels * bitDepth / 8;
+    const quint64 headerSize = 12 + (8 + DS64_SIZE) + (8 + 16) + (iq ? 8 + AUXI_SIZE : 0) + 8;
+    const quint64 riffSize = dataBytes + headerSize - 8;
+    
+    // Past 4 GB the 32-bit sizes overflow: switch to RF64 and carry the real
+    // sizes in ds64, which takes the place of the JUNK chunk reserved for it
+    const bool rf64 = riffSize > 0xFFFFFFFFull;
+    
     // RIFF header
-    stream.writeRawData("RIFF", 4);
-    fileSizePos_ = recordingFile_->pos();
-    stream << quint32(0); // File size - 8 (will be updated later)
+    stream.writeRawData(rf64 ? "RF64" : "RIFF", 4);
+    stream << quint32(rf64 ? 0xFFFFFFFFu : riffSize); // File size - 8
     stream.writeRawData("WAVE", 4);
     
-    // Format chunk
+    if (rf64) {
+        stream.writeRawData("ds64", 4);
+        stream << quint32(DS64_SIZE);
+        stream << quint64(riffSize);
+        stream << quint64(dataBytes);
+        stream << quint64(blockAlign ? dataBytes / blockAlign : 0); // Sample frames
+        stream << quint32(0); // No extra chunk size table
+    } else {
+        stream.writeRawData("JUNK", 4);
+        stream << quint32(DS64_SIZE);
+        for (quint32 i = 0; i < DS64_SIZE; i++) {
+            stream << quint8(0);
+        }
+    }
+    
+    // Format chunk; 8-bit PCM is unsigned, which is exactly the tuner's output
     stream.writeRawData("fmt ", 4);
     stream << quint32(16); // Chunk size
     stream << quint16(1);  // Audio format (1 = PCM)
-    stream << quint16(wavChannels_); // Number of channels
-    stream << quint32(wavSampleRate_); // Sample rate
-    stream << quint32(wavSampleRate_ * wavChannels_ * wavBitDepth_ / 8); // Byte rate
-    stream << quint16(wavChannels_ * wavBitDepth_ / 8); // Block align
-    stream << quint16(wavBitDepth_); // Bits per sample
+    stream << quint16(channels); // Number of channels
+    stream << quint32(sampleRate); // Sample rate
+    stream << quint32(sampleRate * blockAlign); // Byte rate
+    stream << quint16(blockAlign); // Block align
+    stream << quint16(bitDepth); // Bits per sample
+    
+    // auxi chunk as read by SpectraVue, HDSDR and SDR#: start/stop time as
+    // Windows SYSTEMTIME, then centre frequency and rate
+    if (iq) {
+        auto writeSystemTime = [&stream](const QDateTime& time) {
+            QDate date = time.date();
+            QTime clock = time.time();
+            bool valid = time.isValid();
+            stream << quint16(valid ? date.year() : 0);
+            stream << quint16(valid ? date.month() : 0);
+            stream << quint16(valid ? date.dayOfWeek() % 7 : 0); // Sunday = 0
+            stream << quint16(valid ? date.day() : 0);
+            stream << quint16(valid ? clock.hour() : 0);
+            stream << quint16(valid ? clock.minute() : 0);
+            stream << quint16(valid ? clock.second() : 0);
+            stream << quint16(valid ? clock.msec() : 0);
+        };
+        
+        stream.writeRawData("auxi", 4);
+        stream << quint32(AUXI_SIZE);
+        writeSystemTime(currentRecording_.startTime);
+        writeSystemTime(stopTime);
+        stream << quint32(currentRecording_.frequency); // Centre frequency (Hz)
+        stream << quint32(sampleRate); // A/D frequency
+        stream << quint32(0); // IF frequency
+        stream << quint32(sampleRate); // Bandwidth
+        stream << quint32(0); // IQ offset
+        for (int i = 0; i < 4; i++) {
+            stream << quint32(0); // Unused
+        }
+    }
     
     // Data chunk
     stream.writeRawData("data", 4);
-    dataChunkSizePos_ = recordingFile_->pos();
-    stream << quint32(0); // Data size (will be updated later)
+    stream << quint32(rf64 ? 0xFFFFFFFFu : dataBytes);
+    
+    return header;
 }
 
 void RecordingManager::finalizeWavFile() {
-    if (!recordingFile_ || !recordingFile_->isOpen()) {
+    // The writer is closed; only what actually reached the disk counts
+    DiskWriter::Stats stats = writer_->getStats();
+    if (stats.bytesWritten < headerBytes_) {
         return;
     }
     
-    qint64 currentPos = recordingFile_->pos();
+    QByteArray header = buildWavHeader(stats.bytesWritten - headerBytes_,
+                                       wavSampleRate_, wavChannels_, wavBitDepth_,
+                                       currentRecording_.type == RecordingType::IQ,
+                                       QDateTime::currentDateTime());
+    writer_->patch(0, header.constData(), header.size());
+}
+
+void RecordingManager::setIQSource(int sampleRate, double gainDb) {
+    iqSampleRate_ = sampleRate;
+    iqGain_ = gainDb;
+}
+
+void RecordingManager::noteFrequencyChange(double frequency) {
+    triggerFrequency_ = frequency;
+    {
+        // A new station has yet to send its name
+        std::lock_guard<std::mutex> lock(stationMutex_);
+        programService_.clear();
+    }
     
-    // Update file size
-    recordingFile_->seek(fileSizePos_);
-    QDataStream stream(recordingFile_.get());
-    stream.setByteOrder(QDataStream::LittleEndian);
-    stream << quint32(currentPos - 8);
+    if (!isRecording_ || currentRecording_.type != RecordingType::IQ || captures_.empty()) {
+        return;
+    }
     
-    // Update data chunk size
-    recordingFile_->seek(dataChunkSizePos_);
-    stream << quint32(currentPos - dataChunkSizePos_ - 4);
+    // New SigMF capture segment from the next sample on
+    DiskWriter::Stats stats = writer_->getStats();
+    quint64 sampleStart = (stats.bytesAccepted - headerBytes_) / 2;
+    if (captures_.back().sampleStart == sampleStart) {
+        captures_.pop_back();
+    }
+    captures_.push_back({sampleStart, frequency, QDateTime::currentDateTime()});
+}
+
+void RecordingManager::noteModeChange(const QString& mode) {
+    std::lock_guard<std::mutex> lock(stationMutex_);
+    stationMode_ = mode;
+}
+
+void RecordingManager::noteProgramService(const QString& ps) {
+    std::lock_guard<std::mutex> lock(stationMutex_);
+    programService_ = ps.trimmed();
+}
+
+void RecordingManager::catalogRecording(const QString& fileName, const QDateTime& start, double seconds,
+                                        double frequency, const QString& mode, float tone, qint64 bytes) {
+    RecordingCatalog::Entry entry;
+    entry.fileName = fileName;
+    entry.start = start;
+    entry.durationSeconds = seconds;
+    entry.frequency = frequency;
+    entry.ctcssTone = tone;
+    entry.bytes = bytes;
+    {
+        std::lock_guard<std::mutex> lock(stationMutex_);
+        entry.mode = mode.isEmpty() ? stationMode_ : mode;
+        entry.programService = programService_;
+    }
     
-    // Return to end of file
-    recordingFile_->seek(currentPos);
+    RecordingCatalog& catalog = sharedCatalog_ ? *sharedCatalog_ : catalog_;
+    if (!catalog.append(entry)) {
+#ifdef HAS_SPDLOG
+        spdlog::warn("Recording not catalogued: {}", fileName.toStdString());
+#endif
+    }
 }
 
-void RecordingManager::enableTimeShift(bool enable) {
-    std::lock_guard<std::mutex> lock(timeShiftMutex_);
+void RecordingManager::addAnnotation(quint64 sampleStart, quint64 sampleCount,
+                                     double lowerEdge, double upperEdge, const QString& label) {
+    if (!isRecording_ || currentRecording_.type != RecordingType::IQ) {
+        return;
+    }
+    annotations_.push_back({sampleStart, sampleCount, lowerEdge, upperEdge, label});
+}
+
+static ChannelExtractor::Demod demodForMode(const QString& mode) {
+    if (mode == "AM") {
+        return ChannelExtractor::Demod::AM;
+    } else if (mode == "USB") {
+        return ChannelExtractor::Demod::USB;
+    } else if (mode == "LSB") {
+        return ChannelExtractor::Demod::LSB;
+    } else if (mode == "CW") {
+        return ChannelExtractor::Demod::CW;
+    }
+    return ChannelExtractor::Demod::FM;
+}
+
+bool RecordingManager::addChannel(const QString& fileName, quint64 sampleStart, quint64 sampleCount,
+                                  double frequency, double bandwidth, const QString& mode) {
+    if (!isRecording_ || currentRecording_.type != RecordingType::IQ || captures_.empty()) {
+        return false;
+    }
     
-    if (enable && !timeShiftEnabled_) {
-        timeShiftBuffer_.resize(TIME_SHIFT_BUFFER_SIZE);
-        timeShiftWritePos_ = 0;
-    } else if (!enable && timeShiftEnabled_) {
-        timeShiftBuffer_.clear();
-        timeShiftBuffer_.shrink_to_fit();
+    QString fullPath = recordingDirectory_ + "/" + fileName;
+    if (!fullPath.endsWith(".wav")) {
+        fullPath += ".wav";
     }
     
-    timeShiftEnabled_ = enable;
+    ChannelLog channel;
+    channel.sampleStart = sampleStart;
+    channel.sampleEnd = sampleCount > 0 ? sampleStart + sampleCount : UINT64_MAX;
+    channel.frequency = frequency;
+    channel.mode = mode;
+    channel.start = currentRecording_.startTime.addMSecs(
+        static_cast<qint64>(sampleStart * 1000 / std::max(1, iqSampleRate_)));
+    channel.extractor = std::make_unique<ChannelExtractor>(iqSampleRate_,
+                                                           frequency - captures_.back().frequency,
+                                                           bandwidth, demodForMode(mode));
+    channel.samples = 0;
+    channel.failed = false;
+    
+    // Sizes are patched in by stopChannels()
+    QByteArray header = buildWavHeader(0, channel.extractor->getAudioRate(), 1, 16, false);
+    channel.file = std::make_unique<QFile>(fullPath);
+    if (!channel.file->open(QIODevice::WriteOnly) || channel.file->write(header) != header.size()) {
+        emit recordingError(QString("Cannot create channel log %1").arg(fullPath));
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(channelMutex_);
+        channels_.push_back(std::move(channel));
+    }
+    
+    // The worker starts with the first channel, counting from the samples
+    // the writer has taken so far
+    if (!channelThread_.joinable()) {
+        DiskWriter::Stats stats = writer_->getStats();
+        channelPosition_ = stats.bytesAccepted > headerBytes_ ? (stats.bytesAccepted - headerBytes_) / 2 : 0;
+        channelDropped_ = 0;
+        channelTap_ = true;
+        channelThread_ = std::thread(&RecordingManager::channelLoop, this);
+    }
+    return true;
 }
 
-void RecordingManager::updateTimeShiftBuffer(const float* data, size_t samples) {
-    std::lock_guard<std::mutex> lock(timeShiftMutex_);
+void RecordingManager::channelLoop() {
+    std::vector<uint8_t> raw(2 * CHANNEL_BLOCK_SAMPLES);
+    std::vector<std::complex<float>> iq(CHANNEL_BLOCK_SAMPLES);
+    std::vector<float> audio(CHANNEL_BLOCK_SAMPLES);
+    std::vector<int16_t> pcm(CHANNEL_BLOCK_SAMPLES);
     
-    if (!timeShiftEnabled_ || timeShiftBuffer_.empty()) {
-        return;
+    while (true) {
+        // Once the tap is closed and the USB thread is out, the queue only drains
+        bool last = !channelTap_ && activeProducers_ == 0;
+        
+        size_t bytes = std::min(channelIQ_.getReadAvailable(), raw.size()) & ~static_cast<size_t>(1);
+        if (bytes == 0) {
+            if (last) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        channelIQ_.read(raw.data(), bytes);
+        
+        const size_t count = bytes / 2;
+        for (size_t i = 0; i < count; i++) {
+            iq[i] = std::complex<float>((raw[i * 2] - 127.5f) / 127.5f,
+                                        (raw[i * 2 + 1] - 127.5f) / 127.5f);
+        }
+        channelPosition_ += channelDropped_.exchange(0) / 2;
+        
+        std::lock_guard<std::mutex> lock(channelMutex_);
+        for (ChannelLog& channel : channels_) {
+            uint64_t from = std::max<uint64_t>(channelPosition_, channel.sampleStart);
+            uint64_t to = std::min<uint64_t>(channelPosition_ + count, channel.sampleEnd);
+            if (channel.failed || from >= to) {
+                continue;
+            }
+            
+            size_t samples = channel.extractor->process(iq.data() + (from - channelPosition_),
+                                                        static_cast<size_t>(to - from), audio.data());
+            for (size_t i = 0; i < samples; i++) {
+                float sample = std::max(-1.0f, std::min(1.0f, audio[i]));
+                pcm[i] = static_cast<int16_t>(sample * 32767.0f);
+            }
+            
+            const qint64 pcmBytes = static_cast<qint64>(samples * sizeof(int16_t));
+            if (channel.file->write(reinterpret_cast<const char*>(pcm.data()), pcmBytes) != pcmBytes) {
+                channel.failed = true;
+                QString error = "Channel log failed: " + channel.file->errorString();
+                QMetaObject::invokeMethod(this, [this, error]() {
+                    emit recordingError(error);
+                }, Qt::QueuedConnection);
+                continue;
+            }
+            channel.samples += samples;
+        }
+        channelPosition_ += count;
+    }
+}
+
+void RecordingManager::stopChannels() {
+    channelTap_ = false;
+    if (channelThread_.joinable()) {
+        channelThread_.join();
     }
     
-    // Copy data to circular buffer
-    for (size_t i = 0; i < samples; i++) {
-        timeShiftBuffer_[timeShiftWritePos_] = data[i];
-        timeShiftWritePos_ = (timeShiftWritePos_ + 1) % TIME_SHIFT_BUFFER_SIZE;
+    for (ChannelLog& channel : channels_) {
+        // A window the recording stopped short of leaves nothing to keep
+        if (channel.samples == 0) {
+            channel.file->remove();
+            continue;
+        }
+        
+        const uint32_t rate = channel.extractor->getAudioRate();
+        channel.file->seek(0);
+        channel.file->write(buildWavHeader(channel.samples * sizeof(int16_t), rate, 1, 16, false));
+        qint64 bytes = channel.file->size();
+        channel.file->close();
+        
+        double seconds = static_cast<double>(channel.samples) / rate;
+        catalogRecording(channel.file->fileName(), channel.start, seconds,
+                         channel.frequency, channel.mode, 0.0f, bytes);
+        emit transmissionRecorded(QFileInfo(channel.file->fileName()).fileName(), bytes, seconds);
     }
+    channels_.clear();
 }
 
-bool RecordingManager::saveTimeShiftBuffer(const QString& fileName, int seconds) {
-    std::lock_guard<std::mutex> lock(timeShiftMutex_);
+bool RecordingManager::writeSigMFMeta() const {
+    QFileInfo dataFile(currentRecording_.fileName);
+    QString metaPath = dataFile.path() + "/" + dataFile.completeBaseName() + ".sigmf-meta";
     
-    if (!timeShiftEnabled_ || timeShiftBuffer_.empty()) {
-        emit recordingError("Time-shift buffer not enabled");
-        return false;
+    QJsonObject global;
+    global["core:datatype"] = "cu8";
+    global["core:sample_rate"] = currentRecording_.sampleRate;
+    global["core:version"] = "1.0.0";
+    global["core:recorder"] = "Vintage Tactical Radio";
+    global["core:hw"] = QString("RTL-SDR, gain %1 dB").arg(iqGain_, 0, 'f', 1);
+    
+    // The samples live in a WAV or FLAC container rather than a bare
+    // .sigmf-data file, so name it explicitly
+    global["core:dataset"] = dataFile.fileName();
+    if (currentRecording_.format == Format::IQ_FLAC) {
+        global["core:description"] = QString("%1 IQ, FLAC compressed; decode to cu8 with "
+                                             "flac -d --force-raw-format --endian=little --sign=unsigned")
+                                     .arg(currentRecording_.mode);
+    } else {
+        global["core:description"] = QString("%1 IQ").arg(currentRecording_.mode);
     }
     
-    // Calculate samples to save
-    size_t samplesToSave = seconds * wavSampleRate_ * wavChannels_;
-    if (samplesToSave > TIME_SHIFT_BUFFER_SIZE) {
-        samplesToSave = TIME_SHIFT_BUFFER_SIZE;
+    QJsonArray captures;
+    for (const Capture& capture : captures_) {
+        QJsonObject entry;
+        entry["core:sample_start"] = static_cast<qint64>(capture.sampleStart);
+        entry["core:frequency"] = capture.frequency;
+        entry["core:datetime"] = capture.time.toUTC().toString(Qt::ISODateWithMs);
+        if (headerBytes_ > 0 && captures.isEmpty()) {
+            entry["core:header_bytes"] = static_cast<qint64>(headerBytes_);
+        }
+        captures.append(entry);
     }
     
-    // Create temporary recording
-    QString tempFileName = fileName;
-    if (!tempFileName.endsWith(".wav")) {
-        tempFileName += ".wav";
+    QJsonArray annotations;
+    for (const Annotation& annotation : annotations_) {
+        QJsonObject entry;
+        entry["core:sample_start"] = static_cast<qint64>(annotation.sampleStart);
+        if (annotation.sampleCount > 0) {
+            entry["core:sample_count"] = static_cast<qint64>(annotation.sampleCount);
+        }
+        entry["core:freq_lower_edge"] = annotation.lowerEdge;
+        entry["core:freq_upper_edge"] = annotation.upperEdge;
+        entry["core:label"] = annotation.label;
+        annotations.append(entry);
     }
     
-    // Start from the oldest data
-    size_t readPos = (timeShiftWritePos_ + TIME_SHIFT_BUFFER_SIZE - samplesToSave) % TIME_SHIFT_BUFFER_SIZE;
+    QJsonObject root;
+    root["global"] = global;
+    root["captures"] = captures;
+    root["annotations"] = annotations;
     
-    // Create WAV file
-    QFile file(recordingDirectory_ + "/" + tempFileName);
+    QFile file(metaPath);
     if (!file.open(QIODevice::WriteOnly)) {
-        emit recordingError("Failed to create time-shift file");
         return false;
     }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+void RecordingManager::enableTimeShift(bool enable) {
+    if (enable == timeShiftEnabled_) {
+        return;
+    }
     
-    // Write header
-    recordingFile_ = std::make_unique<QFile>(recordingDirectory_ + "/" + tempFileName);
-    recordingFile_->open(QIODevice::WriteOnly);
-    writeWavHeader();
+    if (enable) {
+        timeShift_ = std::make_unique<TimeShiftBuffer>(TIME_SHIFT_SAMPLE_RATE, TIME_SHIFT_SECONDS);
+        timeShiftEnabled_ = true;
+        return;
+    }
     
-    // Write samples
-    std::vector<int16_t> buffer(samplesToSave);
-    for (size_t i = 0; i < samplesToSave; i++) {
-        float sample = timeShiftBuffer_[readPos];
-        buffer[i] = static_cast<int16_t>(sample * 32767.0f);
-        readPos = (readPos + 1) % TIME_SHIFT_BUFFER_SIZE;
+    // Let the audio thread and any save finish with the buffer before freeing it
+    stopTriggeredRecording();
+    timeShiftEnabled_ = false;
+    playbackActive_ = false;
+    while (activeProducers_ > 0) {
+        std::this_thread::yield();
+    }
+    if (timeShiftSaveThread_.joinable()) {
+        timeShiftSaveThread_.join();
+    }
+    timeShift_.reset();
+}
+
+bool RecordingManager::saveTimeShiftBuffer(const QString& fileName, int seconds) {
+    if (!timeShiftEnabled_) {
+        emit recordingError("Time-shift buffer not enabled");
+        return false;
+    }
+    if (timeShiftSaving_) {
+        emit recordingError("Time-shift buffer is already being saved");
+        return false;
+    }
+    if (timeShiftSaveThread_.joinable()) {
+        timeShiftSaveThread_.join();
     }
     
-    recordingFile_->write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(int16_t));
+    // Fix the range now; audio keeps flowing into the buffer meanwhile
+    // Leave the oldest second, which is about to be overwritten
+    TimeShiftBuffer::Range range = timeShift_->available();
+    uint64_t held = range.end - range.start;
+    uint64_t samplesToSave = std::min<uint64_t>(static_cast<uint64_t>(seconds) * TIME_SHIFT_SAMPLE_RATE,
+                                                held > TIME_SHIFT_SAMPLE_RATE ? held - TIME_SHIFT_SAMPLE_RATE : 0);
+    if (samplesToSave == 0) {
+        emit recordingError("Time-shift buffer is empty");
+        return false;
+    }
+    uint64_t from = range.end - samplesToSave;
+    QDateTime start = QDateTime::currentDateTime()
+                      .addMSecs(-static_cast<qint64>(samplesToSave * 1000 / TIME_SHIFT_SAMPLE_RATE));
+    double frequency = triggerFrequency_;
     
-    // Finalize
-    finalizeWavFile();
-    recordingFile_->close();
-    recordingFile_.reset();
+    QString tempFileName = fileName;
+    if (!tempFileName.endsWith(".wav")) {
+        tempFileName += ".wav";
+    }
+    QString path = recordingDirectory_ + "/" + tempFileName;
     
-    emit recordingStopped(tempFileName, samplesToSave * sizeof(int16_t));
+    // Write on a background thread, oldest audio first since it is the first
+    // to be overwritten
+    timeShiftSaving_ = true;
+    timeShiftSaveThread_ = std::thread([this, path, tempFileName, from, samplesToSave, start, frequency]() {
+        QFile file(path);
+        bool ok = file.open(QIODevice::WriteOnly);
+        if (ok) {
+            file.write(buildWavHeader(samplesToSave * sizeof(int16_t), TIME_SHIFT_SAMPLE_RATE, 1, 16, false));
+        }
+        
+        std::vector<int16_t> chunk(TIME_SHIFT_SAMPLE_RATE);
+        uint64_t written = 0;
+        while (ok && written < samplesToSave) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(chunk.size(), samplesToSave - written));
+            ok = timeShift_->read(from + written, chunk.data(), count) &&
+                 file.write(reinterpret_cast<const char*>(chunk.data()), count * sizeof(int16_t)) > 0;
+            if (ok) {
+                written += count;
+            }
+        }
+        
+        // Lapped by the live audio: keep what was saved and fix the sizes
+        if (written < samplesToSave && file.isOpen()) {
+            file.seek(0);
+            file.write(buildWavHeader(written * sizeof(int16_t), TIME_SHIFT_SAMPLE_RATE, 1, 16, false));
+            file.resize(file.pos() + written * sizeof(int16_t));
+        }
+        qint64 fileBytes = file.size();
+        file.close();
+        
+        qint64 bytes = static_cast<qint64>(written * sizeof(int16_t));
+        if (written > 0) {
+            catalogRecording(path, start, static_cast<double>(written) / TIME_SHIFT_SAMPLE_RATE,
+                             frequency, QString(), 0.0f, fileBytes);
+        }
+        bool complete = (written == samplesToSave);
+        QMetaObject::invokeMethod(this, [this, tempFileName, bytes, complete]() {
+            timeShiftSaving_ = false;
+            if (complete) {
+                emit timeShiftSaved(tempFileName, bytes);
+            } else {
+                emit recordingError("Time-shift save incomplete: " + tempFileName);
+            }
+        }, Qt::QueuedConnection);
+    });
     
     return true;
 }
 
 int RecordingManager::getTimeShiftBufferSeconds() const {
-    if (!timeShiftEnabled_ || wavSampleRate_ == 0 || wavChannels_ == 0) {
+    if (!timeShiftEnabled_) {
         return 0;
     }
     
-    return TIME_SHIFT_BUFFER_SIZE / (wavSampleRate_ * wavChannels_);
+    TimeShiftBuffer::Range range = timeShift_->available();
+    return static_cast<int>((range.end - range.start) / TIME_SHIFT_SAMPLE_RATE);
+}
+
+bool RecordingManager::startTimeShiftPlayback(int secondsBack) {
+    if (!timeShiftEnabled_) {
+        return false;
+    }
+    
+    // Keep clear of the oldest second, which is next in line to be overwritten
+    TimeShiftBuffer::Range range = timeShift_->available();
+    uint64_t back = static_cast<uint64_t>(secondsBack) * TIME_SHIFT_SAMPLE_RATE;
+    uint64_t held = range.end - range.start;
+    back = std::min(back, held > TIME_SHIFT_SAMPLE_RATE ? held - TIME_SHIFT_SAMPLE_RATE : 0);
+    if (back == 0) {
+        return false;
+    }
+    
+    playbackPos_ = range.end - back;
+    playbackActive_ = true;
+    return true;
+}
+
+void RecordingManager::stopTimeShiftPlayback() {
+    playbackActive_ = false;
+}
+
+int RecordingManager::getTimeShiftDelaySeconds() const {
+    if (!playbackActive_ || !timeShiftEnabled_) {
+        return 0;
+    }
+    TimeShiftBuffer::Range range = timeShift_->available();
+    return static_cast<int>((range.end - playbackPos_) / TIME_SHIFT_SAMPLE_RATE);
+}
+
+void RecordingManager::applyTimeShiftPlayback(float* audio, size_t samples) {
+    activeProducers_++;
+    if (playbackActive_ && timeShiftEnabled_) {
+        // The cursor advances with the live audio, so the delay stays fixed
+        uint64_t position = playbackPos_;
+        if (timeShift_->read(position, audio, samples)) {
+            playbackPos_ = position + samples;
+        } else {
+            playbackActive_ = false;
+        }
+    }
+    activeProducers_--;
 }
 
-void RecordingManager::scheduleRecording(const QDateTime& startTime, int durationSeconds,
-                                       const QString& fileName, Format format,
-                                       double frequency, const QString& mode) {
-    // Cancel any existing scheduled recording
-    cancelScheduledRecording();
+bool RecordingManager::startTriggeredRecording(const TriggerSettings& settings, double frequency) {
+    if (triggerActive_) {
+        emit recordingError("Triggered recording already running");
+        return false;
+    }
+    if (triggerThread_.joinable()) {
+        triggerThread_.join();
+    }
+    if (settings.format == Format::OPUS && !OggOpusEncoder::isAvailable()) {
+        emit recordingError("Opus recording is not available in this build");
+        return false;
+    }
     
-    scheduledStartTime_ = startTime;
-    scheduledDuration_ = durationSeconds;
-    scheduledFileName_ = fileName;
-    scheduledFormat_ = format;
-    scheduledFrequency_ = frequency;
-    scheduledMode_ = mode;
+    // The files are cut from the time-shift buffer
+    enableTimeShift(true);
     
-    // Calculate milliseconds until start time
-    qint64 msUntilStart = QDateTime::currentDateTime().msecsTo(startTime);
+    triggerSettings_ = settings;
+    triggerDirectory_ = recordingDirectory_;
+    triggerFrequency_ = frequency;
+    TriggerEdge stale;
+    while (triggerEdges_.read(&stale, 1)) {
+    }
+    triggerOpen_ = false;
+    triggerActive_ = true;
+    triggerThread_ = std::thread(&RecordingManager::triggerLoop, this);
     
-    if (msUntilStart > 0) {
-        scheduledTimer_->start(msUntilStart);
-    } else {
-        emit recordingError("Scheduled time is in the past");
+#ifdef HAS_SPDLOG
+    spdlog::info("Triggered recording started: {:.1f} s pre-roll", settings.prerollSeconds);
+#endif
+    
+    return true;
+}
+
+void RecordingManager::stopTriggeredRecording() {
+    // The worker finishes the transmission in progress up to now and exits
+    triggerActive_ = false;
+    if (triggerThread_.joinable()) {
+        triggerThread_.join();
     }
 }
 
-void RecordingManager::cancelScheduledRecording() {
-    scheduledTimer_->stop();
+void RecordingManager::updateTrigger(bool squelchOpen, float tone) {
+    activeProducers_++;
+    if (tone > 0.0f) {
+        lastTone_ = tone;
+    }
+    if (triggerActive_ && timeShiftEnabled_) {
+        bool open = squelchOpen && (triggerSettings_.source == TriggerSource::SQUELCH || tone > 0.0f);
+        if (open != triggerOpen_) {
+            // The edge goes at the end of the block just written. With the
+            // queue full it is retried on the next block.
+            TriggerEdge edge{timeShift_->available().end, open, tone};
+            if (triggerEdges_.write(&edge, 1)) {
+                triggerOpen_ = open;
+            }
+        }
+    }
+    activeProducers_--;
+}
+
+void RecordingManager::triggerLoop() {
+    const uint64_t rate = TIME_SHIFT_SAMPLE_RATE;
+    const uint64_t preroll = static_cast<uint64_t>(triggerSettings_.prerollSeconds * rate);
+    const bool opus = triggerSettings_.format == Format::OPUS;
+    const int bitrate = std::max(1, opusBitrate_);
+    const QByteArray emptyHeader = opus ? QByteArray() : buildWavHeader(0, rate, 1, 16, false);
+    
+    // Rotation limit in samples; Opus sizes are estimated from the bitrate
+    uint64_t limit = UINT64_MAX;
+    if (triggerSettings_.maxSeconds > 0) {
+        limit = triggerSettings_.maxSeconds * rate;
+    }
+    if (triggerSettings_.maxBytes > 0) {
+        uint64_t samples = opus
+            ? static_cast<uint64_t>(triggerSettings_.maxBytes) * 8 * rate / bitrate
+            : (triggerSettings_.maxBytes - std::min<qint64>(triggerSettings_.maxBytes, emptyHeader.size()))
+              / sizeof(int16_t);
+        limit = std::min(limit, std::max(samples, rate));
+    }
+    
+    std::unique_ptr<OggOpusEncoder> encoder;
+    std::vector<uint8_t> encoded;
+    
+    std::vector<TriggerEdge> pending;
+    std::vector<int16_t> chunk(rate / 10);
+    QFile file;
+    QString fileName;
+    QDateTime startTime;
+    double frequency = 0.0;
+    float tone = 0.0f;
+    int part = 0;
+    uint64_t readPos = 0;
+    uint64_t closePos = 0;
+    uint64_t fileSamples = 0;
+    bool ok = true;
+    
+    auto openFile = [&]() {
+        fileName = QString("VTR_%1MHz_%2")
+                   .arg(frequency / 1e6, 0, 'f', 3)
+                   .arg(startTime.toString("yyyyMMdd_HHmmss_zzz"));
+        if (tone > 0.0f) {
+            fileName += QString("_%1Hz").arg(tone, 0, 'f', 1);
+        }
+        if (part > 0) {
+            fileName += QString("_part%1").arg(part + 1);
+        }
+        fileName += opus ? ".opus" : ".wav";
+        
+        fileSamples = 0;
+        file.setFileName(triggerDirectory_ + "/" + fileName);
+        if (opus) {
+            encoder = std::make_unique<OggOpusEncoder>(rate, 1, bitrate);
+            return encoder->isValid() && file.open(QIODevice::WriteOnly);
+        }
+        return file.open(QIODevice::WriteOnly) && file.write(emptyHeader) == emptyHeader.size();
+    };
+    
+    auto writeSamples = [&](const int16_t* samples, size_t count) {
+        const size_t bytes = count * sizeof(int16_t);
+        if (!encoder) {
+            return file.write(reinterpret_cast<const char*>(samples), bytes) == static_cast<qint64>(bytes);
+        }
+        encoded.clear();
+        encoder->encode(reinterpret_cast<const uint8_t*>(samples), bytes, encoded);
+        return encoded.empty() ||
+               file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size()) ==
+                   static_cast<qint64>(encoded.size());
+    };
+    
+    auto closeFile = [&]() {
+        if (fileSamples == 0) {
+            file.remove();
+            encoder.reset();
+            return;
+        }
+        
+        if (encoder) {
+            encoded.clear();
+            encoder->finish(encoded);
+            file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            encoder.reset();
+        } else {
+            quint64 dataBytes = fileSamples * sizeof(int16_t);
+            file.seek(0);
+            file.write(buildWavHeader(dataBytes, rate, 1, 16, false));
+        }
+        qint64 bytes = file.size();
+        file.close();
+        
+        QString name = fileName;
+        double seconds = static_cast<double>(fileSamples) / rate;
+        
+        // Later parts start where the one before hit the limit
+        QDateTime partStart = part > 0 ? startTime.addMSecs(static_cast<qint64>(part * limit * 1000 / rate))
+                                       : startTime;
+        catalogRecording(file.fileName(), partStart, seconds, frequency, QString(), tone, bytes);
+        QMetaObject::invokeMethod(this, [this, name, bytes, seconds]() {
+            emit transmissionRecorded(name, bytes, seconds);
+        }, Qt::QueuedConnection);
+    };
+    
+    while (ok) {
+        // Once stopped and the audio thread is out, no more edges can arrive
+        bool last = !triggerActive_ && activeProducers_ == 0;
+        
+        TriggerEdge edge;
+        while (triggerEdges_.read(&edge, 1)) {
+            pending.push_back(edge);
+        }
+        TimeShiftBuffer::Range range = timeShift_->available();
+        
+        size_t next = 0;
+        while (ok) {
+            if (!file.isOpen()) {
+                // Edges alternate, so the next one opens a transmission
+                if (next == pending.size()) {
+                    break;
+                }
+                edge = pending[next++];
+                
+                // Keep clear of the oldest second, which is about to go
+                readPos = edge.position - std::min(edge.position, preroll);
+                readPos = std::max(readPos, std::min(edge.position, range.start + rate));
+                closePos = UINT64_MAX;
+                startTime = QDateTime::currentDateTime()
+                            .addMSecs(-static_cast<qint64>((range.end - readPos) * 1000 / rate));
+                frequency = triggerFrequency_;
+                tone = edge.tone;
+                part = 0;
+                ok = openFile();
+                continue;
+            }
+            
+            if (closePos == UINT64_MAX) {
+                if (next < pending.size()) {
+                    closePos = pending[next++].position;
+                } else if (last) {
+                    closePos = range.end;
+                }
+            }
+            
+            uint64_t target = std::min(range.end, closePos);
+            while (ok && readPos < target) {
+                if (fileSamples >= limit) {
+                    closeFile();
+                    part++;
+                    ok = openFile();
+                    continue;
+                }
+                
+                size_t count = static_cast<size_t>(std::min<uint64_t>({chunk.size(), target - readPos,
+                                                                       limit - fileSamples}));
+                if (!timeShift_->read(readPos, chunk.data(), count)) {
+                    // A whole buffer behind; skip to what is still held
+                    readPos = std::max(readPos, timeShift_->available().start + rate);
+                    continue;
+                }
+                ok = writeSamples(chunk.data(), count);
+                readPos += count;
+                fileSamples += count;
+            }
+            
+            if (!ok || readPos < closePos) {
+                break;
+            }
+            closeFile();
+        }
+        pending.erase(pending.begin(), pending.begin() + next);
+        
+        if (last) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    
+    if (!ok) {
+        triggerActive_ = false;
+        QString error = "Triggered recording failed: " + file.errorString();
+        if (file.isOpen()) {
+            closeFile();
+        }
+        QMetaObject::invokeMethod(this, [this, error]() {
+            emit recordingError(error);
+        }, Qt::QueuedConnection);
+    }
 }
 
 QString RecordingManager::getRecordingDirectory() const {
@@ -400,12 +1120,24 @@ QString RecordingManager::getRecordingDirectory() const {
 void RecordingManager::setRecordingDirectory(const QString& dir) {
     recordingDirectory_ = dir;
     QDir().mkpath(recordingDirectory_);
+    
+    // With a shared catalog this directory's own would never be used
+    if (sharedCatalog_) {
+        catalog_.close();
+    } else {
+        catalog_.open(recordingDirectory_);
+    }
 }
 
 QStringList RecordingManager::getRecordings() const {
-    QDir dir(recordingDirectory_);
-    return dir.entryList(QStringList() << "*.wav" << "*.flac" << "*.mp3", 
-                        QDir::Files, QDir::Time);
+    // From the catalog: no directory listing, but files deleted by hand stay
+    // listed
+    std::vector<RecordingCatalog::Entry> entries = catalog_.query(RecordingCatalog::Query());
+    QStringList names;
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        names << it->fileName;
+    }
+    return names;
 }
 
 QString RecordingManager::getRecordingTime() const {
@@ -425,26 +1157,25 @@ QString RecordingManager::getRecordingTime() const {
 }
 
 void RecordingManager::onUpdateTimer() {
-    if (isRecording_) {
-        emit recordingProgress(currentRecording_.bytesWritten, getRecordingTime());
+    if (!isRecording_) {
+        return;
     }
-}
-
-void RecordingManager::onScheduledTimer() {
-    // Start the scheduled recording
-    QString fileName = scheduledFileName_;
-    if (fileName.isEmpty()) {
-        fileName = QString("scheduled_%1").arg(
-            QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    
+    DiskWriter::Stats stats = writer_->getStats();
+    if (writer_->hasFailed()) {
+        QString error = QString::fromStdString(writer_->getError());
+        stopRecording();
+        emit recordingError(error);
+        return;
     }
     
-    if (startRecording(fileName, scheduledFormat_, RecordingType::AUDIO,
-                      scheduledFrequency_, scheduledMode_)) {
-        emit scheduledRecordingStarted();
-        
-        // Schedule stop if duration specified
-        if (scheduledDuration_ > 0) {
-            QTimer::singleShot(scheduledDuration_ * 1000, this, &RecordingManager::stopRecording);
-        }
+    currentRecording_.bytesWritten = stats.bytesAccepted > headerBytes_ ?
+                                     stats.bytesAccepted - headerBytes_ : 0;
+    emit recordingProgress(currentRecording_.bytesWritten, getRecordingTime());
+    
+    // Report new drops once per tick rather than from the producer threads
+    if (stats.bytesDropped > reportedDropped_) {
+        reportedDropped_ = stats.bytesDropped;
+        emit recordingOverrun(stats.bytesDropped);
     }
 }
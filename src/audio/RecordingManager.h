@@ -9,6 +9,14 @@
 #include <atomic>
 #include <vector>
 #include <mutex>
+#include "DiskWriter.h"
+#include "FlacEncoder.h"
+#include "OggOpusEncoder.h"
+#include "RecordingCatalog.h"
+#include "TimeShiftBuffer.h"
+#include "../core/RingBuffer.h"
+#include "../dsp/ChannelExtractor.h"
+#include <thread>
 
 class QTimer;
 
@@ -20,7 +28,9 @@ public:
         WAV,
         FLAC,
         MP3,
-        IQ_WAV
+        IQ_WAV,
+        IQ_FLAC,
+        OPUS            // mono voice log, see OggOpusEncoder
     };
     
     enum class RecordingType {
@@ -28,6 +38,19 @@ public:
         IQ
     };
     
+    enum class TriggerSource {
+        SQUELCH,        // squelch open
+        CTCSS           // squelch open with a CTCSS tone detected
+    };
+    
+    struct TriggerSettings {
+        TriggerSource source;
+        double prerollSeconds;      // audio kept from before the trigger
+        int maxSeconds;             // start a new file after this long, 0 for no limit
+        qint64 maxBytes;            // or after this size, 0 for no limit
+        Format format = Format::WAV;    // WAV or OPUS
+    };
+    
     struct RecordingInfo {
         QString fileName;
         Format format;
@@ -49,25 +72,77 @@ public:
     void stopRecording();
     bool isRecording() const { return isRecording_; }
     
-    // Write data
+    // Write data. Safe from the audio and USB threads: both only queue the
+    // data for the disk writer thread and never block on the file.
     void writeAudioData(const float* data, size_t samples);
     void writeIQData(const uint8_t* data, size_t bytes);
     
-    // Time-shift buffer
+    // IQ source parameters for IQ recordings and their SigMF metadata
+    void setIQSource(int sampleRate, double gainDb);
+    int getIQSampleRate() const { return iqSampleRate_; }
+    void noteFrequencyChange(double frequency);
+    
+    // Receiver state kept in the catalog with each recording
+    void noteModeChange(const QString& mode);
+    void noteProgramService(const QString& ps);
+    
+    // Marks a channel within the current IQ recording in its SigMF sidecar;
+    // sampleCount 0 runs to the end
+    void addAnnotation(quint64 sampleStart, quint64 sampleCount,
+                       double lowerEdge, double upperEdge, const QString& label);
+    
+    // Demodulates a channel of the current IQ recording into a WAV of its own
+    // while the IQ is written, over the same sample window as an annotation.
+    // A worker does the work, fed from writeIQData(); the files are closed
+    // and catalogued under frequency and mode when the recording stops.
+    bool addChannel(const QString& fileName, quint64 sampleStart, quint64 sampleCount,
+                    double frequency, double bandwidth, const QString& mode);
+    
+    // Disk writer
+    void setDirectIO(bool enable) { directIO_ = enable; }
+    void setOpusBitrate(int bitrate) { opusBitrate_ = bitrate; }
+    DiskWriter::Stats getWriterStats() const { return writer_->getStats(); }
+    
+    // Time-shift buffer. Saving runs in the background and reports through
+    // timeShiftSaved(); capture continues throughout.
     void enableTimeShift(bool enable);
     bool saveTimeShiftBuffer(const QString& fileName, int seconds);
     int getTimeShiftBufferSeconds() const;
     
-    // Scheduled recording
-    void scheduleRecording(const QDateTime& startTime, int durationSeconds,
-                          const QString& fileName, Format format,
-                          double frequency, const QString& mode);
-    void cancelScheduledRecording();
+    // Time-shift playback: replay from secondsBack behind live until stopped.
+    // applyTimeShiftPlayback() runs on the audio thread after writeAudioData()
+    // and swaps the live block for the delayed one while replaying.
+    bool startTimeShiftPlayback(int secondsBack);
+    void stopTimeShiftPlayback();
+    bool isTimeShiftPlaying() const { return playbackActive_; }
+    int getTimeShiftDelaySeconds() const;
+    void applyTimeShiftPlayback(float* audio, size_t samples);
+    
+    // Squelch-triggered recording: one WAV (or Opus) file per transmission.
+    // Each RecordingManager runs its own, so one per receiver gives several
+    // simultaneous logs. The files are cut
+    // from the time-shift buffer by a worker thread, which is where the pre-roll
+    // comes from; the audio thread only reports open/close edges through
+    // updateTrigger(), called after writeAudioData() with the detected CTCSS
+    // tone or 0.
+    bool startTriggeredRecording(const TriggerSettings& settings, double frequency);
+    void stopTriggeredRecording();
+    bool isTriggeredRecording() const { return triggerActive_; }
+    void updateTrigger(bool squelchOpen, float tone);
     
     // File management
     QString getRecordingDirectory() const;
     void setRecordingDirectory(const QString& dir);
-    QStringList getRecordings() const;
+    QStringList getRecordings() const;      // newest first, as catalogued
+    
+    // Catalog of the recording directory, filled in as recordings close
+    RecordingCatalog& getCatalog() { return catalog_; }
+    
+    // Catalogue into another manager's catalog instead, e.g. a pipeline's
+    // recorder writing under the main directory, so that one search covers
+    // every receiver. Set before recording and before
+    // setRecordingDirectory(), which then opens no catalog of its own.
+    void shareCatalog(RecordingCatalog* catalog) { sharedCatalog_ = catalog; }
     
     // Status
     RecordingInfo getCurrentRecording() const { return currentRecording_; }
@@ -78,57 +153,144 @@ signals:
     void recordingStopped(const QString& fileName, qint64 bytes);
     void recordingError(const QString& error);
     void recordingProgress(qint64 bytes, const QString& time);
-    void scheduledRecordingStarted();
+    void recordingOverrun(quint64 droppedBytes);
+    void timeShiftSaved(const QString& fileName, qint64 bytes);
+    void transmissionRecorded(const QString& fileName, qint64 bytes, double seconds);
     
 private slots:
     void onUpdateTimer();
-    void onScheduledTimer();
     
 private:
     // WAV file handling
-    bool createWavFile(const QString& fileName, int sampleRate, int channels, int bitDepth);
-    void writeWavHeader();
+    bool createWavFile(int sampleRate, int channels, int bitDepth);
+    QByteArray buildWavHeader(quint64 dataBytes, int sampleRate, int channels, int bitDepth,
+                              bool iq, const QDateTime& stopTime = QDateTime()) const;
     void finalizeWavFile();
     
+    // SigMF sidecar (.sigmf-meta) next to IQ recordings
+    bool writeSigMFMeta() const;
+    
+    // Triggered recording worker
+    void triggerLoop();
+    
+    // Channel log worker, and closing its files once the IQ has stopped
+    void channelLoop();
+    void stopChannels();
+    
+    // Any thread, once the file is closed; an empty mode is the current one
+    void catalogRecording(const QString& fileName, const QDateTime& start, double seconds,
+                          double frequency, const QString& mode, float tone, qint64 bytes);
+    
     // Format conversion (placeholder for future implementation)
     bool convertToFlac(const QString& wavFile, const QString& flacFile);
     bool convertToMp3(const QString& wavFile, const QString& mp3File);
     
-    // Time-shift buffer management
-    void updateTimeShiftBuffer(const float* data, size_t samples);
-    
     // Member variables
     std::atomic<bool> isRecording_;
     RecordingInfo currentRecording_;
-    std::unique_ptr<QFile> recordingFile_;
     QString recordingDirectory_;
     
-    // Time-shift buffer (30 minutes at 48kHz stereo)
-    static constexpr size_t TIME_SHIFT_BUFFER_SIZE = 30 * 60 * 48000 * 2;
-    std::vector<float> timeShiftBuffer_;
-    size_t timeShiftWritePos_;
-    bool timeShiftEnabled_;
-    std::mutex timeShiftMutex_;
-    
-    // Scheduled recording
-    QTimer* scheduledTimer_;
-    QDateTime scheduledStartTime_;
-    int scheduledDuration_;
-    QString scheduledFileName_;
-    Format scheduledFormat_;
-    double scheduledFrequency_;
-    QString scheduledMode_;
+    // Disk writer; producers are counted so stopRecording() can wait them out
+    std::unique_ptr<DiskWriter> writer_;
+    std::atomic<int> activeProducers_;
+    std::vector<uint8_t> conversionBuffer_;
+    bool directIO_;
+    quint64 reportedDropped_;
+    quint64 headerBytes_;             // container header ahead of the samples
+    std::unique_ptr<FlacEncoder> flacEncoder_;
+    std::unique_ptr<OggOpusEncoder> opusEncoder_;
+    int opusBitrate_;
+    
+    // IQ source and SigMF captures (GUI thread)
+    struct Capture {
+        quint64 sampleStart;
+        double frequency;
+        QDateTime time;
+    };
+    int iqSampleRate_;
+    double iqGain_;
+    std::vector<Capture> captures_;
+    
+    struct Annotation {
+        quint64 sampleStart;
+        quint64 sampleCount;
+        double lowerEdge;
+        double upperEdge;
+        QString label;
+    };
+    std::vector<Annotation> annotations_;
+    
+    // Channel logs. The USB thread queues the raw IQ for the worker, which
+    // counts samples from channelPosition_ on; blocks dropped on a full queue
+    // are skipped over so the windows stay in place.
+    struct ChannelLog {
+        quint64 sampleStart;
+        quint64 sampleEnd;              // UINT64_MAX for to the end
+        double frequency;
+        QString mode;
+        QDateTime start;
+        std::unique_ptr<ChannelExtractor> extractor;
+        std::unique_ptr<QFile> file;
+        quint64 samples;
+        bool failed;
+    };
+    std::vector<ChannelLog> channels_;
+    std::mutex channelMutex_;
+    RingBuffer<uint8_t> channelIQ_;
+    std::atomic<bool> channelTap_;
+    std::atomic<uint64_t> channelDropped_;  // bytes that found the queue full
+    uint64_t channelPosition_;              // worker only once it runs
+    std::thread channelThread_;
+    
+    // Time-shift buffer (30 minutes of the 48 kHz mono demodulated audio)
+    static constexpr uint32_t TIME_SHIFT_SAMPLE_RATE = 48000;
+    static constexpr uint32_t TIME_SHIFT_SECONDS = 30 * 60;
+    std::unique_ptr<TimeShiftBuffer> timeShift_;
+    std::atomic<bool> timeShiftEnabled_;
+    std::atomic<bool> timeShiftSaving_;
+    std::thread timeShiftSaveThread_;
+    std::atomic<bool> playbackActive_;
+    std::atomic<uint64_t> playbackPos_;
+    
+    // Triggered recording. Edges carry time-shift positions from the audio
+    // thread to the worker.
+    struct TriggerEdge {
+        uint64_t position;
+        bool open;
+        float tone;
+    };
+    TriggerSettings triggerSettings_;
+    QString triggerDirectory_;
+    std::atomic<double> triggerFrequency_;
+    std::atomic<bool> triggerActive_;
+    bool triggerOpen_;                      // audio thread only
+    RingBuffer<TriggerEdge> triggerEdges_;
+    std::thread triggerThread_;
+    
+    // Catalog and the receiver state recorded in it. The mode and PS are
+    // set on the GUI thread and read by the workers; the tone comes from the
+    // audio thread.
+    RecordingCatalog catalog_;
+    RecordingCatalog* sharedCatalog_;
+    mutable std::mutex stationMutex_;
+    QString stationMode_;
+    QString programService_;
+    std::atomic<float> lastTone_;
     
     // Progress tracking
     QTimer* updateTimer_;
     QDateTime recordingStartTime_;
     
     // WAV file specifics
-    qint64 dataChunkSizePos_;
-    qint64 fileSizePos_;
     int wavSampleRate_;
     int wavChannels_;
     int wavBitDepth_;
+    
+    static constexpr size_t CHANNEL_QUEUE_BYTES = 8 * 1024 * 1024;    // over a second at 2.4 MS/s
+    static constexpr size_t CHANNEL_BLOCK_SAMPLES = 16384;
+    
+    static constexpr quint32 DS64_SIZE = 28;     // reserved as JUNK until needed
+    static constexpr quint32 AUXI_SIZE = 68;
 };
 
 #endif // RECORDING_MANAGER_H
@@ -0,0 +1,422 @@
+#include "RecordingScheduler.h"
+
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+
+#ifdef HAS_SPDLOG
+#include <spdlog/spdlog.h>
+#endif
+
+static const char* repeatName(RecordingScheduler::Repeat repeat) {
+    switch (repeat) {
+        case RecordingScheduler::Repeat::DAILY: return "daily";
+        case RecordingScheduler::Repeat::WEEKDAYS: return "weekdays";
+        case RecordingScheduler::Repeat::WEEKLY: return "weekly";
+        default: return "once";
+    }
+}
+
+QJsonObject RecordingScheduler::Job::toJson() const {
+    QJsonObject json;
+    json["id"] = id;
+    json["name"] = name;
+    json["frequency"] = frequency;
+    json["bandwidth"] = bandwidth;
+    json["mode"] = mode;
+    json["format"] = static_cast<int>(format);
+    json["start"] = start.toString(Qt::ISODate);
+    json["duration"] = durationSeconds;
+    json["repeat"] = repeatName(repeat);
+    json["enabled"] = enabled;
+    return json;
+}
+
+RecordingScheduler::Job RecordingScheduler::Job::fromJson(const QJsonObject& json) {
+    Job job;
+    job.id = json["id"].toInt();
+    job.name = json["name"].toString();
+    job.frequency = json["frequency"].toDouble();
+    job.bandwidth = json["bandwidth"].toDouble(DEFAULT_BANDWIDTH);
+    job.mode = json["mode"].toString("FM-Narrow");
+    job.format = static_cast<RecordingManager::Format>(json["format"].toInt());
+    job.start = QDateTime::fromString(json["start"].toString(), Qt::ISODate);
+    job.durationSeconds = json["duration"].toInt();
+    
+    QString repeat = json["repeat"].toString();
+    job.repeat = Repeat::ONCE;
+    for (Repeat r : {Repeat::DAILY, Repeat::WEEKDAYS, Repeat::WEEKLY}) {
+        if (repeat == repeatName(r)) {
+            job.repeat = r;
+        }
+    }
+    
+    job.enabled = json["enabled"].toBool(true);
+    return job;
+}
+
+RecordingScheduler::RecordingScheduler(RecordingManager* recorder, QObject* parent)
+    : QObject(parent)
+    , recorder_(recorder)
+    , nextId_(1)
+    , capturing_(false) {
+    
+    timer_ = new QTimer(this);
+    timer_->setSingleShot(true);
+    connect(timer_, &QTimer::timeout, this, &RecordingScheduler::onTimer);
+}
+
+bool RecordingScheduler::load(const QString& path) {
+    path_ = path;
+    jobs_.clear();
+    nextId_ = 1;
+    
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly)) {
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        QJsonArray jobsArray = doc.object()["jobs"].toArray();
+        for (const auto& value : jobsArray) {
+            Job job = Job::fromJson(value.toObject());
+            if (!job.start.isValid() || job.durationSeconds <= 0) {
+                continue;
+            }
+            nextId_ = std::max(nextId_, job.id + 1);
+            jobs_.push_back(job);
+        }
+    }
+    
+    reschedule();
+    emit jobsChanged();
+    return file.isOpen();
+}
+
+bool RecordingScheduler::save() const {
+    if (path_.isEmpty()) {
+        return false;
+    }
+    
+    QJsonArray jobsArray;
+    for (const Job& job : jobs_) {
+        jobsArray.append(job.toJson());
+    }
+    QJsonObject root;
+    root["version"] = 1;
+    root["jobs"] = jobsArray;
+    
+    QDir().mkpath(QFileInfo(path_).path());
+    QFile file(path_);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+int RecordingScheduler::addJob(Job job) {
+    job.id = nextId_++;
+    if (job.bandwidth <= 0.0) {
+        job.bandwidth = DEFAULT_BANDWIDTH;
+    }
+    jobs_.push_back(job);
+    
+    save();
+    reschedule();
+    emit jobsChanged();
+    return job.id;
+}
+
+bool RecordingScheduler::updateJob(const Job& job) {
+    auto it = std::find_if(jobs_.begin(), jobs_.end(), [&](const Job& j) { return j.id == job.id; });
+    if (it == jobs_.end()) {
+        return false;
+    }
+    *it = job;
+    
+    save();
+    reschedule();
+    emit jobsChanged();
+    return true;
+}
+
+bool RecordingScheduler::removeJob(int id) {
+    auto it = std::find_if(jobs_.begin(), jobs_.end(), [&](const Job& j) { return j.id == id; });
+    if (it == jobs_.end()) {
+        return false;
+    }
+    jobs_.erase(it);
+    
+    save();
+    reschedule();
+    emit jobsChanged();
+    return true;
+}
+
+const RecordingScheduler::Job* RecordingScheduler::findJob(int id) const {
+    for (const Job& job : jobs_) {
+        if (job.id == id) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+
+double RecordingScheduler::usableBandwidth() const {
+    return recorder_->getIQSampleRate() * USABLE_FRACTION;
+}
+
+QDateTime RecordingScheduler::nextOccurrence(const Job& job, const QDateTime& after) {
+    QDateTime start = job.start;
+    if (job.repeat == Repeat::ONCE) {
+        return start.addSecs(job.durationSeconds) > after ? start : QDateTime();
+    }
+    
+    // Skip ahead in whole days, which keeps the local time of day across DST
+    qint64 days = job.start.date().daysTo(after.date()) - 1;
+    if (days > 0) {
+        start = start.addDays(days);
+    }
+    
+    for (int i = 0; i < 16; i++) {
+        int day = start.date().dayOfWeek();
+        bool runs = job.repeat == Repeat::DAILY ||
+                    (job.repeat == Repeat::WEEKDAYS && day <= 5) ||
+                    (job.repeat == Repeat::WEEKLY && day == job.start.date().dayOfWeek());
+        if (runs && start.addSecs(job.durationSeconds) > after) {
+            return start;
+        }
+        start = start.addDays(1);
+    }
+    return QDateTime();
+}
+
+std::vector<RecordingScheduler::Capture> RecordingScheduler::plan(const QDateTime& from, const QDateTime& to,
+                                                                  std::vector<Conflict>* conflicts) const {
+    struct Occurrence {
+        QDateTime start;
+        QDateTime end;
+        const Job* job;
+    };
+    
+    std::vector<Occurrence> occurrences;
+    for (const Job& job : jobs_) {
+        if (!job.enabled) {
+            continue;
+        }
+        QDateTime start = nextOccurrence(job, from);
+        while (start.isValid() && start < to) {
+            QDateTime end = start.addSecs(job.durationSeconds);
+            occurrences.push_back({start, end, &job});
+            if (job.repeat == Repeat::ONCE) {
+                break;
+            }
+            start = nextOccurrence(job, end);
+        }
+    }
+    std::sort(occurrences.begin(), occurrences.end(), [](const Occurrence& a, const Occurrence& b) {
+        return a.start < b.start || (a.start == b.start && a.job->id < b.job->id);
+    });
+    
+    // Greedy in start order: an occurrence joins the capture it overlaps if
+    // the combined span still fits, and is a conflict otherwise
+    const double usable = usableBandwidth();
+    std::vector<Capture> captures;
+    for (const Occurrence& occurrence : occurrences) {
+        double lower = occurrence.job->frequency - occurrence.job->bandwidth / 2.0;
+        double upper = occurrence.job->frequency + occurrence.job->bandwidth / 2.0;
+        
+        if (!captures.empty() && occurrence.start < captures.back().end) {
+            Capture& capture = captures.back();
+            double newLower = std::min(capture.lowerEdge, lower);
+            double newUpper = std::max(capture.upperEdge, upper);
+            if (newUpper - newLower <= usable) {
+                capture.lowerEdge = newLower;
+                capture.upperEdge = newUpper;
+                capture.end = std::max(capture.end, occurrence.end);
+                capture.jobs.push_back({occurrence.job->id, occurrence.start});
+            } else if (conflicts) {
+                conflicts->push_back({occurrence.job->id, capture.jobs.front().first, occurrence.start});
+            }
+            continue;
+        }
+        
+        captures.push_back({occurrence.start, occurrence.end, lower, upper,
+                            {{occurrence.job->id, occurrence.start}}});
+    }
+    return captures;
+}
+
+void RecordingScheduler::reschedule() {
+    QDateTime now = QDateTime::currentDateTime();
+    
+    // While capturing, the tuner is spoken for until the capture ends
+    QDateTime from = capturing_ ? std::max(now, captureEnd_) : now;
+    std::vector<Conflict> conflicts;
+    std::vector<Capture> captures = plan(from, now.addSecs(PLAN_HORIZON_HOURS * 3600), &conflicts);
+    
+    // Report each clash once
+    qint64 cutoff = now.toSecsSinceEpoch() - 24 * 3600;
+    for (auto it = reportedConflicts_.begin(); it != reportedConflicts_.end();) {
+        it = (it->second < cutoff) ? reportedConflicts_.erase(it) : std::next(it);
+    }
+    for (auto it = failedCaptures_.begin(); it != failedCaptures_.end();) {
+        it = (it->second < cutoff) ? failedCaptures_.erase(it) : std::next(it);
+    }
+    for (const Conflict& conflict : conflicts) {
+        if (!reportedConflicts_.insert({conflict.jobId, conflict.start.toSecsSinceEpoch()}).second) {
+            continue;
+        }
+        const Job* job = findJob(conflict.jobId);
+        const Job* holder = findJob(conflict.blockedBy);
+        emit conflictDetected(tr("Scheduled recording \"%1\" at %2 clashes with \"%3\" and will be skipped")
+                              .arg(job ? job->name : QString())
+                              .arg(conflict.start.toString("yyyy-MM-dd HH:mm"))
+                              .arg(holder ? holder->name : QString()));
+    }
+    
+    // Next event: the end of the running capture or the start of the next
+    // one that has not already failed
+    QDateTime next;
+    if (capturing_) {
+        next = captureEnd_;
+    } else {
+        for (const Capture& capture : captures) {
+            if (!hasFailed(capture)) {
+                next = capture.start;
+                break;
+            }
+        }
+    }
+    
+    if (!next.isValid()) {
+        timer_->start(MAX_TIMER_MS);
+        return;
+    }
+    qint64 ms = std::clamp<qint64>(now.msecsTo(next), 0, MAX_TIMER_MS);
+    timer_->start(static_cast<int>(ms));
+}
+
+void RecordingScheduler::onTimer() {
+    QDateTime now = QDateTime::currentDateTime();
+    
+    if (capturing_ && now >= captureEnd_) {
+        stopCapture();
+    }
+    
+    // A capture already under way when it comes up (a late timer, a busy
+    // recorder, or the app started mid-job) records what is left of it. It
+    // comes from the full plan so that it holds every job grouped into it,
+    // including those that only start later on.
+    if (!capturing_) {
+        for (const Capture& capture : plan(now, now.addSecs(PLAN_HORIZON_HOURS * 3600))) {
+            if (capture.start > now) {
+                break;
+            }
+            if (hasFailed(capture)) {
+                continue;
+            }
+            if (recorder_->isRecording()) {
+                emit conflictDetected(tr("Recorder busy; scheduled recording waits for it"));
+                timer_->start(10000);
+                return;
+            }
+            // A capture that cannot start (no encoder, unwritable directory)
+            // is given up on rather than retried for its whole length
+            if (!startCapture(capture)) {
+                failedCaptures_.insert({capture.jobs.front().first, capture.start.toSecsSinceEpoch()});
+            }
+            break;
+        }
+    }
+    
+    reschedule();
+}
+
+bool RecordingScheduler::hasFailed(const Capture& capture) const {
+    return failedCaptures_.count({capture.jobs.front().first, capture.start.toSecsSinceEpoch()}) > 0;
+}
+
+bool RecordingScheduler::startCapture(const Capture& capture) {
+    const Job* first = findJob(capture.jobs.front().first);
+    if (!first) {
+        return false;
+    }
+    
+    const bool shared = capture.jobs.size() > 1;
+    QDateTime now = QDateTime::currentDateTime();
+    QString fileName = QString("SCHED_%1_%2MHz_%3")
+                       .arg(shared ? QString("group") : QString(first->name).replace(' ', '_'))
+                       .arg(capture.centre() / 1e6, 0, 'f', 3)
+                       .arg(now.toString("yyyyMMdd_HHmmss"));
+    
+    bool started = false;
+    if (shared) {
+        // One IQ capture for all of them, centred on the combined span
+        emit retuneRequested(capture.centre(), first->mode);
+        started = recorder_->startRecording(fileName, RecordingManager::Format::IQ_FLAC,
+                                            RecordingManager::RecordingType::IQ,
+                                            capture.centre(), first->mode);
+        if (started) {
+            const quint64 rate = static_cast<quint64>(recorder_->getIQSampleRate());
+            for (const auto& entry : capture.jobs) {
+                const Job* job = findJob(entry.first);
+                if (!job) {
+                    continue;
+                }
+                qint64 offset = std::max<qint64>(0, now.secsTo(entry.second));
+                qint64 length = std::max<qint64>(0, now.secsTo(entry.second.addSecs(job->durationSeconds)) - offset);
+                recorder_->addAnnotation(offset * rate, length * rate,
+                                         job->frequency - job->bandwidth / 2.0,
+                                         job->frequency + job->bandwidth / 2.0,
+                                         QString("%1 (%2)").arg(job->name).arg(job->mode));
+                
+                // The job's own audio log, demodulated from the capture
+                QString channelFile = QString("SCHED_%1_%2MHz_%3")
+                                      .arg(QString(job->name).replace(' ', '_'))
+                                      .arg(job->frequency / 1e6, 0, 'f', 3)
+                                      .arg(now.addSecs(offset).toString("yyyyMMdd_HHmmss"));
+                recorder_->addChannel(channelFile, offset * rate, length * rate,
+                                      job->frequency, job->bandwidth, job->mode);
+            }
+        }
+    } else {
+        emit retuneRequested(first->frequency, first->mode);
+        bool iq = first->format == RecordingManager::Format::IQ_WAV ||
+                  first->format == RecordingManager::Format::IQ_FLAC;
+        started = recorder_->startRecording(fileName, first->format,
+                                            iq ? RecordingManager::RecordingType::IQ
+                                               : RecordingManager::RecordingType::AUDIO,
+                                            first->frequency, first->mode);
+    }
+    
+    if (!started) {
+        emit conflictDetected(tr("Scheduled recording \"%1\" could not start and is skipped")
+                              .arg(first->name));
+        return false;
+    }
+    
+    capturing_ = true;
+    captureFile_ = recorder_->getCurrentRecording().fileName;
+    captureEnd_ = capture.end;
+    emit captureStarted(captureFile_, static_cast<int>(capture.jobs.size()));
+
+#ifdef HAS_SPDLOG
+    spdlog::info("Scheduled capture started: {} ({} jobs) until {}", captureFile_.toStdString(),
+                 capture.jobs.size(), captureEnd_.toString(Qt::ISODate).toStdString());
+#endif
+    
+    return true;
+}
+
+void RecordingScheduler::stopCapture() {
+    // Leave alone a recording the user has since replaced with their own
+    if (recorder_->isRecording() && recorder_->getCurrentRecording().fileName == captureFile_) {
+        recorder_->stopRecording();
+    }
+    capturing_ = false;
+    captureFile_.clear();
+    emit captureFinished();
+}
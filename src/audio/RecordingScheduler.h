@@ -0,0 +1,127 @@
+#ifndef RECORDING_SCHEDULER_H
+#define RECORDING_SCHEDULER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QString>
+#include <set>
+#include <utility>
+#include <vector>
+#include "RecordingManager.h"
+
+class QTimer;
+
+// Persistent queue of timed recordings, one-shot or repeating, kept as JSON
+// under the config path.
+//
+// There is one tuner, so the scheduler plans captures rather than jobs. Jobs
+// that overlap in time and whose channels fit together inside the usable IQ
+// bandwidth share one IQ capture at their common centre, with a SigMF
+// annotation per job; each job's channel is also demodulated from the IQ as
+// it records, into a WAV of its own. A job on its own is tuned to directly
+// and recorded as audio in its own format.
+// An overlapping job that does not fit is a conflict: the earlier capture
+// keeps the tuner and the job is skipped.
+class RecordingScheduler : public QObject {
+    Q_OBJECT
+    
+public:
+    enum class Repeat {
+        ONCE,
+        DAILY,
+        WEEKDAYS,       // Monday to Friday
+        WEEKLY
+    };
+    
+    struct Job {
+        int id;
+        QString name;
+        double frequency;
+        double bandwidth;           // channel width in Hz
+        QString mode;
+        RecordingManager::Format format;
+        QDateTime start;            // first occurrence
+        int durationSeconds;
+        Repeat repeat;
+        bool enabled;
+        
+        QJsonObject toJson() const;
+        static Job fromJson(const QJsonObject& json);
+    };
+    
+    // One tuner capture covering one or more job occurrences
+    struct Capture {
+        QDateTime start;
+        QDateTime end;
+        double lowerEdge;
+        double upperEdge;
+        std::vector<std::pair<int, QDateTime>> jobs;    // job id, occurrence start
+        
+        double centre() const { return (lowerEdge + upperEdge) / 2.0; }
+    };
+    
+    struct Conflict {
+        int jobId;
+        int blockedBy;              // a job in the capture holding the tuner
+        QDateTime start;
+    };
+    
+    explicit RecordingScheduler(RecordingManager* recorder, QObject* parent = nullptr);
+    
+    // Persistence; every change is saved straight back to the loaded path
+    bool load(const QString& path);
+    bool save() const;
+    
+    // Job queue
+    int addJob(Job job);
+    bool updateJob(const Job& job);
+    bool removeJob(int id);
+    const std::vector<Job>& getJobs() const { return jobs_; }
+    
+    // Captures for the occurrences still running at or starting after from,
+    // and starting before to, plus the occurrences that cannot be recorded
+    std::vector<Capture> plan(const QDateTime& from, const QDateTime& to,
+                              std::vector<Conflict>* conflicts = nullptr) const;
+    
+    // First occurrence of the job still running at or starting after the
+    // given time; invalid when there are no more
+    static QDateTime nextOccurrence(const Job& job, const QDateTime& after);
+    
+signals:
+    void retuneRequested(double frequency, const QString& mode);
+    void captureStarted(const QString& fileName, int jobCount);
+    void captureFinished();
+    void conflictDetected(const QString& message);
+    void jobsChanged();
+    
+private slots:
+    void onTimer();
+    
+private:
+    void reschedule();
+    bool startCapture(const Capture& capture);
+    bool hasFailed(const Capture& capture) const;
+    void stopCapture();
+    const Job* findJob(int id) const;
+    double usableBandwidth() const;
+    
+    RecordingManager* recorder_;
+    std::vector<Job> jobs_;
+    int nextId_;
+    QString path_;
+    
+    QTimer* timer_;
+    bool capturing_;
+    QString captureFile_;
+    QDateTime captureEnd_;
+    std::set<std::pair<int, qint64>> reportedConflicts_;
+    std::set<std::pair<int, qint64>> failedCaptures_;   // first job, start; not retried
+    
+    static constexpr double USABLE_FRACTION = 0.8;      // of the IQ rate, clear of the roll-off
+    static constexpr double DEFAULT_BANDWIDTH = 12.5e3;
+    static constexpr int PLAN_HORIZON_HOURS = 48;
+    static constexpr int MAX_TIMER_MS = 60 * 60 * 1000; // re-plan at least hourly
+};
+
+#endif // RECORDING_SCHEDULER_H
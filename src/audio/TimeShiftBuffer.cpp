@@ -0,0 +1,80 @@
+#include "TimeShiftBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+TimeShiftBuffer::TimeShiftBuffer(uint32_t sampleRate, uint32_t seconds)
+    : sampleRate_(sampleRate)
+    , capacity_(static_cast<size_t>(sampleRate) * seconds)
+    , samples_(new int16_t[capacity_])
+    , writePos_(0) {
+}
+
+void TimeShiftBuffer::write(const float* data, size_t samples) {
+    uint64_t position = writePos_.load(std::memory_order_relaxed);
+    size_t index = static_cast<size_t>(position % capacity_);
+    
+    // Convert in at most two contiguous runs, no per-sample wrap
+    size_t remaining = samples;
+    while (remaining > 0) {
+        size_t run = std::min(remaining, capacity_ - index);
+        int16_t* out = samples_.get() + index;
+        for (size_t i = 0; i < run; i++) {
+            float sample = std::max(-1.0f, std::min(1.0f, data[i]));
+            out[i] = static_cast<int16_t>(sample * 32767.0f);
+        }
+        data += run;
+        remaining -= run;
+        index = 0;
+    }
+    
+    writePos_.store(position + samples, std::memory_order_release);
+}
+
+TimeShiftBuffer::Range TimeShiftBuffer::available() const {
+    uint64_t end = writePos_.load(std::memory_order_acquire);
+    uint64_t start = (end > capacity_) ? end - capacity_ : 0;
+    return {start, end};
+}
+
+bool TimeShiftBuffer::isIntact(uint64_t from) const {
+    // The producer may be filling the slots just past the published end, which
+    // wraps onto the oldest audio; keep 100 ms of margin
+    uint64_t end = writePos_.load(std::memory_order_acquire);
+    return from + capacity_ >= end + sampleRate_ / 10;
+}
+
+bool TimeShiftBuffer::read(uint64_t from, int16_t* out, size_t count) const {
+    Range range = available();
+    if (from + count > range.end || !isIntact(from)) {
+        return false;
+    }
+    
+    size_t index = static_cast<size_t>(from % capacity_);
+    size_t first = std::min(count, capacity_ - index);
+    std::memcpy(out, samples_.get() + index, first * sizeof(int16_t));
+    std::memcpy(out + first, samples_.get(), (count - first) * sizeof(int16_t));
+    
+    // Lapped while copying?
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return isIntact(from);
+}
+
+bool TimeShiftBuffer::read(uint64_t from, float* out, size_t count) const {
+    Range range = available();
+    if (from + count > range.end || !isIntact(from)) {
+        return false;
+    }
+    
+    size_t index = static_cast<size_t>(from % capacity_);
+    const float scale = 1.0f / 32768.0f;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = samples_[index] * scale;
+        if (++index == capacity_) {
+            index = 0;
+        }
+    }
+    
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return isIntact(from);
+}
@@ -0,0 +1,50 @@
+#ifndef TIME_SHIFT_BUFFER_H
+#define TIME_SHIFT_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Rolling history of the demodulated audio as 16-bit PCM. One producer (the
+// DSP thread) appends; any number of readers copy out ranges by absolute
+// sample position without locking. The producer never waits: a reader that
+// is lapped while copying finds out afterwards and gets a failure instead of
+// torn data.
+class TimeShiftBuffer {
+public:
+    // Half-open range of absolute sample positions
+    struct Range {
+        uint64_t start;
+        uint64_t end;
+    };
+    
+    TimeShiftBuffer(uint32_t sampleRate, uint32_t seconds);
+    
+    // Producer side
+    void write(const float* data, size_t samples);
+    
+    // Positions still held; the start moves up as old audio is overwritten
+    Range available() const;
+    
+    // Copies [from, from + count) out. Returns false if any of it is not yet
+    // written or was overwritten before the copy finished.
+    bool read(uint64_t from, int16_t* out, size_t count) const;
+    bool read(uint64_t from, float* out, size_t count) const;
+    
+    uint32_t getSampleRate() const { return sampleRate_; }
+    size_t getCapacity() const { return capacity_; }
+    
+private:
+    bool isIntact(uint64_t from) const;
+    
+    uint32_t sampleRate_;
+    size_t capacity_;
+    
+    // Left uninitialised: the kernel only commits pages as they are written,
+    // so a half-hour history costs memory in proportion to what it holds
+    std::unique_ptr<int16_t[]> samples_;
+    std::atomic<uint64_t> writePos_;    // absolute count of samples written
+};
+
+#endif // TIME_SHIFT_BUFFER_H
@@ -27,15 +27,20 @@ std::map<std::string, VintageEqualizer::Preset> VintageEqualizer::presets_ = {
     {"DX", {"DX", {0.0f, 3.0f, 6.0f, 3.0f, 0.0f, -3.0f, -6.0f}}}
 };
 
-VintageEqualizer::VintageEqualizer(uint32_t sampleRate, Mode mode)
+VintageEqualizer::VintageEqualizer(uint32_t sampleRate, Mode mode, size_t channels)
     : sampleRate_(sampleRate)
     , mode_(mode)
     , preampGain_(0.0f)
-    , maxGain_(12.0f) {
+    , maxGain_(12.0f)
+    , cascade_(7, channels)
+    , preampLinear_(1.0f)
+    , pendingCoeffs_(7, BiquadCascade::identity())
+    , coeffsChanged_(false)
+    , resetPending_(false)
+    , preampTarget_(1.0f) {
     
     // Initialize bands
     bands_.resize(7);
-    filters_.resize(7);
     
     // Set frequencies based on mode
     const auto& frequencies = (mode == MODERN) ? modernFrequencies_ : nostalgicFrequencies_;
@@ -45,32 +50,65 @@ VintageEqualizer::VintageEqualizer(uint32_t sampleRate, Mode mode)
         bands_[i].q = 0.7f;
         updateFilter(i);
     }
+    
+    // Start on the initial response instead of gliding into it
+    for (size_t i = 0; i < 7; i++) {
+        cascade_.setImmediate(i, pendingCoeffs_[i]);
+    }
+    coeffsChanged_ = false;
 }
 
 void VintageEqualizer::process(const float* input, float* output, size_t length) {
-    // Apply preamp gain
-    float preampLinear = powf(10.0f, preampGain_ / 20.0f);
+    const size_t channels = cascade_.channels();
+    const size_t frames = length / channels;
+    if (frames == 0) {
+        return;
+    }
     
-    for (size_t i = 0; i < length; i++) {
-        float sample = input[i] * preampLinear;
-        
-        // Process through each band filter
+    if (resetPending_.exchange(false)) {
+        cascade_.reset();
+    }
+    
+    // Never wait on the UI; a busy lock just defers the change one block
+    if (coeffsChanged_ && coeffMutex_.try_lock()) {
         for (size_t band = 0; band < 7; band++) {
-            if (bands_[band].gain != 0.0f) {
-                sample = filters_[band].process(sample);
-            }
+            cascade_.setTarget(band, pendingCoeffs_[band]);
+        }
+        coeffsChanged_ = false;
+        coeffMutex_.unlock();
+    }
+    
+    // Preamp ramps across the block like the filter coefficients
+    const size_t samples = frames * channels;
+    const float preampEnd = preampTarget_.load();
+    const float preampStep = (preampEnd - preampLinear_) / frames;
+    float gain = preampLinear_;
+    for (size_t n = 0; n < frames; n++) {
+        gain += preampStep;
+        for (size_t ch = 0; ch < channels; ch++) {
+            output[n * channels + ch] = input[n * channels + ch] * gain;
         }
-        
-        // Soft clipping to prevent harsh distortion
+    }
+    preampLinear_ = preampEnd;
+    
+    cascade_.process(output, frames);
+    
+    // Soft clipping to prevent harsh distortion
+    for (size_t i = 0; i < samples; i++) {
+        float sample = output[i];
         if (fabsf(sample) > 0.95f) {
-            sample = (sample > 0.0f ? 1.0f : -1.0f) * 
-                    (1.0f - expf(-3.0f * fabsf(sample)));
+            output[i] = (sample > 0.0f ? 1.0f : -1.0f) * 
+                        (1.0f - expf(-3.0f * fabsf(sample)));
         }
-        
-        output[i] = sample;
     }
 }
 
+void VintageEqualizer::setPreampGain(float gain) {
+    // dB to linear once per change rather than once per block
+    preampGain_ = gain;
+    preampTarget_ = powf(10.0f, gain / 20.0f);
+}
+
 void VintageEqualizer::setMode(Mode mode) {
     if (mode_ == mode) return;
     
@@ -135,30 +173,31 @@ std::vector<VintageEqualizer::Preset> VintageEqualizer::getDefaultPresets() {
 }
 
 void VintageEqualizer::reset() {
-    preampGain_ = 0.0f;
+    setPreampGain(0.0f);
     
     for (size_t i = 0; i < 7; i++) {
         bands_[i].gain = 0.0f;
         bands_[i].q = 0.7f;
         updateFilter(i);
-        filters_[i].reset();
     }
+    resetPending_ = true;
 }
 
 void VintageEqualizer::updateFilter(int band) {
     if (band < 0 || band >= 7) return;
     
-    float b0, b1, b2, a1, a2;
-    calculatePeakingCoefficients(bands_[band].frequency, 
-                                bands_[band].gain,
-                                bands_[band].q,
-                                b0, b1, b2, a1, a2);
-    
-    filters_[band].b0 = b0;
-    filters_[band].b1 = b1;
-    filters_[band].b2 = b2;
-    filters_[band].a1 = a1;
-    filters_[band].a2 = a2;
+    // A flat band is an exact pass-through, which lets the cascade skip it
+    BiquadCascade::Coefficients coeffs = BiquadCascade::identity();
+    if (bands_[band].gain != 0.0f) {
+        calculatePeakingCoefficients(bands_[band].frequency, 
+                                    bands_[band].gain,
+                                    bands_[band].q,
+                                    coeffs.b0, coeffs.b1, coeffs.b2, coeffs.a1, coeffs.a2);
+    }
+    
+    std::lock_guard<std::mutex> lock(coeffMutex_);
+    pendingCoeffs_[band] = coeffs;
+    coeffsChanged_ = true;
 }
 
 void VintageEqualizer::calculatePeakingCoefficients(float frequency, float gain, float q,
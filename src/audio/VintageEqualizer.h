@@ -4,8 +4,11 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <atomic>
+#include <mutex>
 #include <cstddef>  // for size_t
 #include <cstdint>  // for uint32_t
+#include "../dsp/BiquadCascade.h"
 
 class VintageEqualizer {
 public:
@@ -25,11 +28,13 @@ public:
         std::vector<float> gains; // 7 values in dB
     };
     
-    VintageEqualizer(uint32_t sampleRate, Mode mode = MODERN);
+    VintageEqualizer(uint32_t sampleRate, Mode mode = MODERN, size_t channels = 1);
     ~VintageEqualizer() = default;
     
-    // Process audio
+    // Process audio; length counts samples, interleaved when channels > 1.
+    // Input and output may be the same buffer.
     void process(const float* input, float* output, size_t length);
+    size_t getChannels() const { return cascade_.channels(); }
     
     // Mode control
     void setMode(Mode mode);
@@ -42,7 +47,7 @@ public:
     float getBandQ(int band) const;
     
     // Preamp
-    void setPreampGain(float gain) { preampGain_ = gain; }
+    void setPreampGain(float gain);
     float getPreampGain() const { return preampGain_; }
     
     // Gain range
@@ -68,28 +73,17 @@ private:
     static const std::vector<float> modernFrequencies_;
     static const std::vector<float> nostalgicFrequencies_;
     
-    // Filter coefficients and state
-    struct BiquadFilter {
-        float b0, b1, b2;  // Feedforward coefficients
-        float a1, a2;      // Feedback coefficients
-        float x1, x2;      // Input history
-        float y1, y2;      // Output history
-        
-        void reset() {
-            x1 = x2 = y1 = y2 = 0.0f;
-        }
-        
-        float process(float input) {
-            float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
-            x2 = x1;
-            x1 = input;
-            y2 = y1;
-            y1 = output;
-            return output;
-        }
-    };
-    
-    std::vector<BiquadFilter> filters_;
+    // Filters, owned by the audio thread
+    BiquadCascade cascade_;
+    float preampLinear_;            // gain applied to the last sample
+    
+    // Control side hand-off: the UI writes coefficients here and the audio
+    // thread picks them up with try_lock at the start of a block
+    std::mutex coeffMutex_;
+    std::vector<BiquadCascade::Coefficients> pendingCoeffs_;
+    std::atomic<bool> coeffsChanged_;
+    std::atomic<bool> resetPending_;
+    std::atomic<float> preampTarget_;
     
     // Preset storage
     static std::map<std::string, Preset> presets_;
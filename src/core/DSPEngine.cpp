@@ -2,6 +2,8 @@
 #include "../decoders/CTCSSDecoder.h"
 #include "../decoders/RDSDecoder.h"
 #include "../decoders/ADSBDecoder.h"
+#include "../dsp/ZoomFFT.h"
+#include "ThreadAffinity.h"
 #include <cmath>
 #include <algorithm>
 #include <numeric>
@@ -21,8 +23,20 @@ DSPEngine::DSPEngine(uint32_t sampleRate)
     , mode_(FM_WIDE)  // Default to FM_WIDE
     , bandwidth_(200000) // 200 kHz for FM
     , running_(false)
+    , cpuAffinity_(-1)
     , iqBuffer_(sampleRate * 2) // 2 seconds of buffer
-    , fftSize_(2048)
+    , droppedSamples_(0)
+    , spectrumPlanReady_(false)
+    , spectrumFFTSize_(2048)
+    , spectrumWindowType_(HANN)
+    , spectrumOverlap_(0.5f)
+    , zoomReady_(false)
+    , zoomDecimation_(1)
+    , zoomOffset_(0.0)
+    , spectrumFill_(0)
+    , spectrumAverages_(0)
+    , spectrumSamples_(0)
+    , spectrumFrameRate_(30)
     , agcEnabled_(false)  // Disable AGC by default for FM
     , squelchLevel_(-20.0f)
     , noiseReductionEnabled_(false)
@@ -30,11 +44,12 @@ DSPEngine::DSPEngine(uint32_t sampleRate)
     , notchFreq_(0.0f)
     , notchQ_(10.0f)
     , signalStrength_(-100.0f)
+    , channelSnr_(0.0f)
     , squelched_(false)  // Start with squelch open
     , dynamicBandwidth_(false)  // Disable by default for testing
+    , scanSpectrumEnabled_(false)
     , audioDecimation_(sampleRate / 48000) // Decimate to 48kHz audio
     , audioSampleRate_(48000)
-    , decimationCounter_(0)
     , ctcssEnabled_(false)
     , rdsEnabled_(false)
     , adsbEnabled_(false)
@@ -48,20 +63,22 @@ DSPEngine::DSPEngine(uint32_t sampleRate)
     // Allocate buffers
     iqWorkBuffer_.resize(16384);
     audioBuffer_.resize(16384);
-    spectrumBuffer_.resize(fftSize_);
+    mpxBuffer_.resize(16384);
+    decimatedAudio_.resize(16384);
+    spectrumFrames_.reset(std::vector<float>(spectrumFFTSize_, -120.0f));
     
     // Initialize FFT
-    fftIn_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * fftSize_);
-    fftOut_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * fftSize_);
-    fftPlan_ = fftwf_plan_dft_1d(fftSize_, fftIn_, fftOut_, FFTW_FORWARD, FFTW_MEASURE);
+    spectrumPlan_ = std::make_unique<SpectrumPlan>(spectrumFFTSize_, spectrumWindowType_,
+                                                   spectrumOverlap_);
     
     // Initialize DSP components
     amDemod_ = std::make_unique<AMDemodulator>(sampleRate);
     fmDemod_ = std::make_unique<FMDemodulator>(sampleRate, bandwidth_);
     ssbDemod_ = std::make_unique<SSBDemodulator>(sampleRate, SSBDemodulator::USB);
     agc_ = std::make_unique<AGC>(0.01f, 0.1f);
-    squelch_ = std::make_unique<Squelch>(squelchLevel_);
-    noiseReduction_ = std::make_unique<NoiseReduction>(sampleRate);
+    squelch_ = std::make_unique<Squelch>(squelchLevel_, audioSampleRate_);
+    noiseReduction_ = std::make_unique<NoiseReduction>(audioSampleRate_);
+    audioDecimator_ = std::make_unique<Decimator>(sampleRate, audioDecimation_, AUDIO_PASSBAND);
     
     // Initialize digital decoders
     ctcssDecoder_ = std::make_unique<CTCSSDecoder>();
@@ -108,10 +125,141 @@ void DSPEngine::enableADSB(bool enable) {
 
 DSPEngine::~DSPEngine() {
     stop();
+}
+
+DSPEngine::SpectrumPlan::SpectrumPlan(size_t size, SpectrumWindow type, float overlap)
+    : fftSize(size)
+    , hop(std::max<size_t>(1, static_cast<size_t>(size * (1.0f - overlap))))
+    , powerScale(1.0f) {
+    
+    // Cosine-sum windows: w[i] = sum_k (-1)^k a_k cos(2 pi k i / (N - 1))
+    static const float hann[] = {0.5f, 0.5f};
+    static const float blackmanHarris[] = {0.35875f, 0.48829f, 0.14128f, 0.01168f};
+    static const float flatTop[] = {0.21557895f, 0.41663158f, 0.277263158f,
+                                    0.083578947f, 0.006947368f};
+    const float* coeffs = hann;
+    int terms = 2;
+    if (type == BLACKMAN_HARRIS) {
+        coeffs = blackmanHarris;
+        terms = 4;
+    } else if (type == FLAT_TOP) {
+        coeffs = flatTop;
+        terms = 5;
+    }
+    
+    window.resize(size);
+    double coherentGain = 0.0;
+    for (size_t i = 0; i < size; i++) {
+        double phase = 2.0 * M_PI * i / (size - 1);
+        double w = 0.0;
+        for (int k = 0; k < terms; k++) {
+            w += ((k & 1) ? -coeffs[k] : coeffs[k]) * cos(k * phase);
+        }
+        window[i] = static_cast<float>(w);
+        coherentGain += w;
+    }
+    // A full-scale tone reads 0 dB whatever the window and size
+    powerScale = static_cast<float>(1.0 / (coherentGain * coherentGain));
+    
+    history.resize(size);
+    accum.assign(size, 0.0f);
+    
+    in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * size);
+    out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * size);
+    // Instant when the size is already in the imported wisdom
+    plan = fftwf_plan_dft_1d(size, in, out, FFTW_FORWARD, FFTW_MEASURE);
+}
+
+DSPEngine::SpectrumPlan::~SpectrumPlan() {
+    fftwf_destroy_plan(plan);
+    fftwf_free(in);
+    fftwf_free(out);
+}
+
+void DSPEngine::setSpectrumConfig(size_t fftSize, SpectrumWindow window, float overlap) {
+    size_t size = 512;
+    while (size < fftSize && size < 65536) {
+        size <<= 1;
+    }
+    overlap = std::max(0.0f, std::min(0.9f, overlap));
     
-    fftwf_destroy_plan(fftPlan_);
-    fftwf_free(fftIn_);
-    fftwf_free(fftOut_);
+    if (size == spectrumFFTSize_ && window == spectrumWindowType_ && overlap == spectrumOverlap_) {
+        return;
+    }
+    spectrumFFTSize_ = size;
+    spectrumWindowType_ = window;
+    spectrumOverlap_ = overlap;
+    
+    // Planning happens here, never on the processing thread. Whatever comes back
+    // out of the slot (an unadopted plan or the one just retired) is freed here too,
+    // which keeps every FFTW planner call on this thread.
+    auto plan = std::make_unique<SpectrumPlan>(size, window, overlap);
+    {
+        std::lock_guard<std::mutex> lock(spectrumPlanMutex_);
+        pendingSpectrumPlan_.swap(plan);
+        spectrumPlanReady_ = true;
+    }
+    
+#ifdef HAS_SPDLOG
+    spdlog::info("Spectrum: {} point FFT, window {}, {}% overlap",
+                 size, static_cast<int>(window), static_cast<int>(overlap * 100));
+#endif
+}
+
+void DSPEngine::setSpectrumZoom(uint32_t decimation, double offset) {
+    uint32_t rounded = 1;
+    while (rounded * 2 <= decimation && rounded < 4096) {
+        rounded *= 2;
+    }
+    if (rounded == zoomDecimation_ && offset == zoomOffset_) {
+        return;
+    }
+    zoomDecimation_ = rounded;
+    zoomOffset_ = offset;
+    rebuildZoom();
+    
+#ifdef HAS_SPDLOG
+    if (zoomDecimation_ > 1) {
+        spdlog::info("Spectrum zoom: decimation {}, {:.1f} Hz span",
+                     zoomDecimation_, sampleRate_ * ZoomFFT::USABLE_FRACTION / zoomDecimation_);
+    } else {
+        spdlog::info("Spectrum zoom off");
+    }
+#endif
+}
+
+void DSPEngine::rebuildZoom() {
+    // Built here and handed over like the spectrum plan; whatever the slot held
+    // before is freed on this thread
+    std::unique_ptr<ZoomFFT> zoom;
+    if (zoomDecimation_ > 1) {
+        zoom = std::make_unique<ZoomFFT>(sampleRate_, zoomDecimation_, zoomOffset_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(spectrumPlanMutex_);
+        pendingZoom_.swap(zoom);
+        zoomReady_ = true;
+    }
+}
+
+bool DSPEngine::importFFTWisdom(const std::string& path) {
+    if (!fftwf_import_wisdom_from_filename(path.c_str())) {
+        return false;
+    }
+#ifdef HAS_SPDLOG
+    spdlog::info("Loaded FFTW wisdom from {}", path);
+#endif
+    return true;
+}
+
+bool DSPEngine::exportFFTWisdom(const std::string& path) {
+    if (!fftwf_export_wisdom_to_filename(path.c_str())) {
+#ifdef HAS_SPDLOG
+        spdlog::warn("Failed to save FFTW wisdom to {}", path);
+#endif
+        return false;
+    }
+    return true;
 }
 
 void DSPEngine::setSampleRate(uint32_t rate) {
@@ -124,7 +272,17 @@ void DSPEngine::setSampleRate(uint32_t rate) {
     amDemod_ = std::make_unique<AMDemodulator>(rate);
     fmDemod_ = std::make_unique<FMDemodulator>(rate, bandwidth_);
     ssbDemod_ = std::make_unique<SSBDemodulator>(rate, SSBDemodulator::USB);
-    noiseReduction_ = std::make_unique<NoiseReduction>(rate);
+    audioDecimator_ = std::make_unique<Decimator>(rate, audioDecimation_, AUDIO_PASSBAND);
+    
+    // RDS works on the full-rate composite signal
+    if (rdsDecoder_) {
+        rdsDecoder_->setSampleRate(rate);
+    }
+    
+    // The zoom filters depend on the rate
+    if (zoomDecimation_ > 1) {
+        rebuildZoom();
+    }
     
 #ifdef HAS_SPDLOG
     spdlog::info("DSP engine sample rate set to {} Hz", rate);
@@ -192,6 +350,14 @@ void DSPEngine::setSquelch(float level) {
     }
 }
 
+void DSPEngine::setSquelchMode(Squelch::Mode mode, float hysteresis, float hangTime) {
+    if (squelch_) {
+        squelch_->setMode(mode);
+        squelch_->setHysteresis(hysteresis);
+        squelch_->setHangTime(hangTime);
+    }
+}
+
 void DSPEngine::setNoiseReduction(bool enable, float level) {
     noiseReductionEnabled_ = enable;
     if (noiseReduction_) {
@@ -213,6 +379,7 @@ void DSPEngine::processIQ(const uint8_t* data, size_t length) {
     
     // Write to ring buffer
     if (!iqBuffer_.write(iqData.data(), iqData.size())) {
+        droppedSamples_ += iqData.size();
 #ifdef HAS_SPDLOG
         spdlog::warn("IQ buffer overflow");
 #endif
@@ -226,6 +393,11 @@ void DSPEngine::start() {
     
     running_ = true;
     processingThread_ = std::thread(&DSPEngine::processingWorker, this);
+    if (!pinThreadToCpu(processingThread_, cpuAffinity_)) {
+#ifdef HAS_SPDLOG
+        spdlog::warn("Could not pin the DSP thread to CPU {}", cpuAffinity_);
+#endif
+    }
     
 #ifdef HAS_SPDLOG
     spdlog::info("DSP engine started");
@@ -290,6 +462,7 @@ void DSPEngine::processingWorker() {
         
         // Process spectrum
         processSpectrum(iqWorkBuffer_.data(), blockSize);
+        processZoom(iqWorkBuffer_.data(), blockSize);
     
     // Send raw IQ to ADS-B decoder if enabled and frequency is correct
     if (adsbEnabled_ && adsbDecoder_ && currentFrequency_ >= 1089e6 && currentFrequency_ <= 1091e6) {
@@ -305,69 +478,53 @@ void DSPEngine::processingWorker() {
         // Demodulate
         demodulate(iqWorkBuffer_.data(), blockSize, audioBuffer_.data());
         
-        // Apply AGC
-        if (agcEnabled_ && agc_) {
-            agc_->process(audioBuffer_.data(), audioBuffer_.data(), blockSize);
+        // Everything after the demodulator runs at the audio rate
+        size_t audioSamples = 0;
+        if (audioDecimator_) {
+            audioSamples = audioDecimator_->process(audioBuffer_.data(), blockSize,
+                                                    decimatedAudio_.data());
         }
         
-        // Apply squelch
+        // Squelch decides before the AGC, whose gain would otherwise scale
+        // the noise the NOISE mode measures
         if (squelch_) {
-            squelched_ = squelch_->process(audioBuffer_.data(), blockSize, signalStrength_);
+            squelch_->measure(decimatedAudio_.data(), audioSamples, signalStrength_, channelSnr_);
+        }
+        
+        // Apply AGC
+        if (agcEnabled_ && agc_) {
+            agc_->process(decimatedAudio_.data(), decimatedAudio_.data(), audioSamples);
         }
         
-        // Apply noise reduction
-        if (noiseReductionEnabled_ && noiseReduction_) {
-            noiseReduction_->process(audioBuffer_.data(), audioBuffer_.data(), blockSize);
+        // Apply squelch (mutes the block when closed)
+        if (squelch_) {
+            squelched_ = squelch_->apply(decimatedAudio_.data(), audioSamples);
         }
         
-        // Decimate audio and send to callback
+        // Send audio to callback
         if (audioCallback_) {
             if (!squelched_) {
-                // Use a better decimation filter
-                size_t decimatedSamples = 0;
-                std::vector<float> decimatedAudio(blockSize / audioDecimation_ + 1);
-                
-                // Simple low-pass filter coefficients for anti-aliasing
-                // This is a 5-tap FIR filter designed for cutoff at Nyquist/2 of output rate
-                static const float lpf[] = {0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f};
-                static std::vector<float> filterState(5, 0.0f);
-                
-                for (size_t i = 0; i < blockSize; i++) {
-                    // Shift filter state and add new sample
-                    for (int j = 4; j > 0; j--) {
-                        filterState[j] = filterState[j-1];
-                    }
-                    filterState[0] = audioBuffer_[i];
-                    
-                    // Apply filter
-                    float filtered = 0.0f;
-                    for (int j = 0; j < 5; j++) {
-                        filtered += lpf[j] * filterState[j];
-                    }
-                    
-                    // Decimate
-                    if (decimationCounter_ == 0) {
-                        decimatedAudio[decimatedSamples++] = filtered;
-                    }
-                    decimationCounter_ = (decimationCounter_ + 1) % audioDecimation_;
+                if (noiseReductionEnabled_ && noiseReduction_) {
+                    noiseReduction_->process(decimatedAudio_.data(), decimatedAudio_.data(),
+                                             audioSamples);
                 }
                 
-                audioCallback_(decimatedAudio.data(), decimatedSamples);
+                audioCallback_(decimatedAudio_.data(), audioSamples);
                 
                 // Send audio to CTCSS decoder if enabled
                 if (ctcssEnabled_ && ctcssDecoder_) {
-                    ctcssDecoder_->processAudio(decimatedAudio.data(), decimatedSamples);
+                    ctcssDecoder_->processAudio(decimatedAudio_.data(), audioSamples);
                 }
                 
                 // Send audio to RDS decoder if enabled (FM mode only)
                 if (rdsEnabled_ && rdsDecoder_ && (mode_ == FM_WIDE || mode_ == FM_NARROW)) {
-                    // RDS needs the full rate audio before decimation
-                    rdsDecoder_->processAudio(audioBuffer_.data(), blockSize);
+                    // RDS needs the full rate composite before de-emphasis;
+                    // the decoder decimates to ~19 kHz internally
+                    rdsDecoder_->processAudio(mpxBuffer_.data(), blockSize);
                 }
             } else {
-                // Send silence when squelched
-                std::vector<float> silence(blockSize / audioDecimation_, 0.0f);
-                audioCallback_(silence.data(), silence.size());
+                // Squelch has already zeroed the block
+                audioCallback_(decimatedAudio_.data(), audioSamples);
             }
         }
         
@@ -398,51 +555,158 @@ void DSPEngine::convertIQData(const uint8_t* data, size_t length, std::complex<f
 }
 
 void DSPEngine::processSpectrum(const std::complex<float>* data, size_t length) {
-    if (!spectrumCallback_) {
+    const bool scanning = scanSpectrumEnabled_ && scanSpectrumCallback_;
+    if (!spectrumCallback_ && !scanning) {
         return;
     }
     
-    // Copy data to FFT input (with window function)
-    size_t fftInput = std::min(length, fftSize_);
-    for (size_t i = 0; i < fftInput; i++) {
-        // Hann window
-        float window = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (fftInput - 1)));
-        fftIn_[i][0] = data[i].real() * window;
-        fftIn_[i][1] = data[i].imag() * window;
+    adoptSpectrumPlan();
+    
+    // With zoom on, the full-capture FFT only serves the scanner
+    if (zoom_ && !scanning) {
+        return;
     }
+    SpectrumPlan& plan = *spectrumPlan_;
+    const size_t n = plan.fftSize;
     
-    // Zero pad if necessary
-    for (size_t i = fftInput; i < fftSize_; i++) {
-        fftIn_[i][0] = 0.0f;
-        fftIn_[i][1] = 0.0f;
+    // Welch: overlapped segments taken from a sliding history, so FFTs longer
+    // than a processing block work too. Power is summed until the next frame.
+    size_t pos = 0;
+    while (pos < length) {
+        size_t count = std::min(n - spectrumFill_, length - pos);
+        std::copy(data + pos, data + pos + count, plan.history.begin() + spectrumFill_);
+        spectrumFill_ += count;
+        pos += count;
+        if (spectrumFill_ < n) {
+            break;
+        }
+        
+        for (size_t i = 0; i < n; i++) {
+            plan.in[i][0] = plan.history[i].real() * plan.window[i];
+            plan.in[i][1] = plan.history[i].imag() * plan.window[i];
+        }
+        
+        fftwf_execute(plan.plan);
+        
+        for (size_t i = 0; i < n; i++) {
+            plan.accum[i] += plan.out[i][0] * plan.out[i][0] + plan.out[i][1] * plan.out[i][1];
+        }
+        spectrumAverages_++;
+        
+        // Keep the overlapping tail for the next segment
+        std::copy(plan.history.begin() + plan.hop, plan.history.end(), plan.history.begin());
+        spectrumFill_ = n - plan.hop;
     }
     
-    // Execute FFT
-    fftwf_execute(fftPlan_);
+    spectrumSamples_ += length;
+    if (spectrumAverages_ == 0 ||
+        spectrumSamples_ < sampleRate_ / static_cast<uint32_t>(spectrumFrameRate_.load())) {
+        return;
+    }
     
-    // Calculate magnitude spectrum in dB with proper normalization
-    const float normFactor = 1.0f / (fftSize_ * fftSize_);  // FFT normalization
-    const float refLevel = 1.0f;  // Reference level for dB calculation
+    // Log compress once per frame, writing negative frequencies first
+    std::vector<float>& frame = spectrumFrames_.writeBuffer();
+    frame.resize(n);
+    const float normFactor = plan.powerScale / spectrumAverages_;
+    const size_t half = n / 2;
+    for (size_t i = 0; i < n; i++) {
+        float dB = 10.0f * log10f(plan.accum[(i + half) % n] * normFactor + 1e-20f);
+        frame[i] = std::max(-120.0f, std::min(0.0f, dB));
+    }
+    std::fill(plan.accum.begin(), plan.accum.end(), 0.0f);
+    spectrumAverages_ = 0;
+    spectrumSamples_ = 0;
     
-    for (size_t i = 0; i < fftSize_; i++) {
-        float real = fftOut_[i][0];
-        float imag = fftOut_[i][1];
-        float magnitude = sqrtf((real * real + imag * imag) * normFactor);
-        
-        // Convert to dB with proper scaling
-        // Add offset to keep values in reasonable range (-120 to 0 dB)
-        float dB = 20.0f * log10f(magnitude / refLevel + 1e-10f);
-        
-        // Clamp to reasonable range
-        spectrumBuffer_[i] = std::max(-120.0f, std::min(0.0f, dB));
+    updateChannelSnr(frame.data(), n, static_cast<double>(sampleRate_) / n);
+    
+    // The scanner consumes synchronously, before the frame is handed over
+    if (scanning) {
+        scanSpectrumCallback_(frame.data(), n);
+    }
+    if (zoom_) {
+        return;
+    }
+    
+    spectrumFrames_.publish();
+    if (spectrumCallback_) {
+        spectrumCallback_(nullptr, n);
+    }
+}
+
+void DSPEngine::updateChannelSnr(const float* frame, size_t bins, double binWidth) {
+    // Frames are in dB with the tuned channel at the centre bin
+    const size_t centre = bins / 2;
+    const size_t halfWidth = static_cast<size_t>(bandwidth_ / 2.0 / binWidth);
+    if (halfWidth == 0 || 2 * halfWidth + 1 > bins * 3 / 4) {
+        // Channel fills the span (narrow zoom); keep the last estimate
+        return;
     }
     
-    // Rearrange spectrum (negative frequencies first)
-    std::rotate(spectrumBuffer_.begin(), 
-                spectrumBuffer_.begin() + fftSize_ / 2, 
-                spectrumBuffer_.end());
+    // Noise floor: 20th percentile of the bins outside the channel, robust
+    // against neighbouring stations
+    snrScratch_.clear();
+    snrScratch_.insert(snrScratch_.end(), frame, frame + centre - halfWidth);
+    snrScratch_.insert(snrScratch_.end(), frame + centre + halfWidth + 1, frame + bins);
+    auto percentile = snrScratch_.begin() + snrScratch_.size() / 5;
+    std::nth_element(snrScratch_.begin(), percentile, snrScratch_.end());
+    const float floorPower = powf(10.0f, *percentile / 10.0f);
+    
+    float channelPower = 0.0f;
+    for (size_t i = centre - halfWidth; i <= centre + halfWidth; i++) {
+        channelPower += powf(10.0f, frame[i] / 10.0f);
+    }
+    channelPower /= (2 * halfWidth + 1);
+    
+    // Signal over noise, with the noise's own share of the channel removed
+    float ratio = std::max(channelPower / floorPower - 1.0f, 1e-3f);
+    channelSnr_ = 10.0f * log10f(ratio);
+}
+
+void DSPEngine::adoptSpectrumPlan() {
+    // Never wait for the configuring thread; a busy slot is retried next block
+    std::unique_lock<std::mutex> lock(spectrumPlanMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
     
-    spectrumCallback_(spectrumBuffer_.data(), fftSize_);
+    // Old objects go back into the slots to be freed by the configuring thread
+    if (spectrumPlanReady_) {
+        spectrumPlan_.swap(pendingSpectrumPlan_);
+        spectrumPlanReady_ = false;
+        spectrumFill_ = 0;
+        spectrumAverages_ = 0;
+        spectrumSamples_ = 0;
+    }
+    if (zoomReady_) {
+        zoom_.swap(pendingZoom_);
+        zoomReady_ = false;
+    }
+}
+
+void DSPEngine::processZoom(const std::complex<float>* data, size_t length) {
+    if (!zoom_ || !spectrumCallback_) {
+        return;
+    }
+    
+    // Same frame rate as the full span; segments in between are averaged
+    std::vector<float>& frame = spectrumFrames_.writeBuffer();
+    size_t frameSamples = sampleRate_ / static_cast<uint32_t>(spectrumFrameRate_.load());
+    if (!zoom_->process(data, length, frame, frameSamples)) {
+        return;
+    }
+    updateChannelSnr(frame.data(), frame.size(), zoom_->getBinWidth());
+    
+    spectrumFrames_.publish();
+    spectrumCallback_(nullptr, frame.size());
+}
+
+const float* DSPEngine::acquireSpectrum(size_t& length) {
+    if (!spectrumFrames_.update()) {
+        return nullptr;
+    }
+    const std::vector<float>& frame = spectrumFrames_.readBuffer();
+    length = frame.size();
+    return frame.data();
 }
 
 void DSPEngine::calculateSignalStrength(const std::complex<float>* data, size_t length) {
@@ -477,7 +741,8 @@ void DSPEngine::demodulate(const std::complex<float>* input, size_t length, floa
         case FM_NARROW:
         case FM_WIDE:
             if (fmDemod_) {
-                fmDemod_->demodulate(input, output, length);
+                fmDemod_->demodulate(input, output, length,
+                                     rdsEnabled_ ? mpxBuffer_.data() : nullptr);
             }
             break;
             
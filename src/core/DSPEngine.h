@@ -4,25 +4,31 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <string>
 #include <functional>
 #include <complex>
 #include <cstddef>  // for size_t
 #include <cstdint>  // for uint32_t
 #include <vector>
+#include <algorithm>
 #include <fftw3.h>
 
 #include "RingBuffer.h"
+#include "TripleBuffer.h"
 #include "../dsp/AMDemodulator.h"
 #include "../dsp/FMDemodulator.h"
 #include "../dsp/SSBDemodulator.h"
 #include "../dsp/AGC.h"
 #include "../dsp/Squelch.h"
 #include "../dsp/NoiseReduction.h"
+#include "../dsp/Decimator.h"
 
 // Forward declarations
 class CTCSSDecoder;
 class RDSDecoder;
 class ADSBDecoder;
+class ZoomFFT;
 
 class DSPEngine {
 public:
@@ -35,6 +41,12 @@ public:
         CW
     };
     
+    enum SpectrumWindow {
+        HANN,
+        BLACKMAN_HARRIS,    // low leakage, for weak signals next to strong ones
+        FLAT_TOP            // accurate peak amplitude
+    };
+    
     DSPEngine(uint32_t sampleRate = 2400000);
     ~DSPEngine();
     
@@ -55,6 +67,7 @@ public:
     // DSP Controls
     void setAGC(bool enable, float attack = 0.01f, float decay = 0.1f);
     void setSquelch(float level); // -100 to 0 dB
+    void setSquelchMode(Squelch::Mode mode, float hysteresis, float hangTime);
     void setNoiseReduction(bool enable, float level = 0.5f);
     void setNotchFilter(bool enable, float frequency, float q = 10.0f);
     
@@ -82,6 +95,37 @@ public:
     using SpectrumCallback = std::function<void(const float*, size_t)>;
     void setSpectrumCallback(SpectrumCallback callback) { spectrumCallback_ = callback; }
     
+    // Second spectrum consumer for the wideband scanner, same dB frames as the
+    // display. Installed once before start(); the scanner switches it on and
+    // off while running.
+    void setScanSpectrumCallback(SpectrumCallback callback) { scanSpectrumCallback_ = callback; }
+    void setScanSpectrumEnabled(bool enabled) { scanSpectrumEnabled_ = enabled; }
+    
+    // Spectrum frames are power averaged (Welch) and delivered at this rate. The
+    // spectrum callback only signals a new frame; the reader takes the newest one
+    // with acquireSpectrum(), which stays valid until the next call.
+    void setSpectrumFrameRate(int fps) { spectrumFrameRate_ = std::max(1, fps); }
+    int getSpectrumFrameRate() const { return spectrumFrameRate_; }
+    const float* acquireSpectrum(size_t& length);
+    
+    // Spectrum analyzer setup. The FFT size is rounded to a power of two within
+    // [512, 65536] and overlap is clamped to [0, 0.9]. The new plan is built on the
+    // calling thread and picked up by the processing thread between blocks.
+    void setSpectrumConfig(size_t fftSize, SpectrumWindow window, float overlap);
+    size_t getSpectrumFFTSize() const { return spectrumFFTSize_; }
+    SpectrumWindow getSpectrumWindow() const { return spectrumWindowType_; }
+    float getSpectrumOverlap() const { return spectrumOverlap_; }
+    
+    // Zoom: while enabled the display frames come from a high resolution FFT of
+    // the capture shifted by offset Hz and decimated (power of two, 1 turns zoom
+    // off); the scanner keeps getting full-capture frames
+    void setSpectrumZoom(uint32_t decimation, double offset = 0.0);
+    uint32_t getSpectrumZoom() const { return zoomDecimation_; }
+    
+    // FFTW wisdom, shared by every plan in the process
+    static bool importFFTWisdom(const std::string& path);
+    static bool exportFFTWisdom(const std::string& path);
+    
     // Input IQ data
     void processIQ(const uint8_t* data, size_t length);
     
@@ -90,10 +134,18 @@ public:
     void stop();
     bool isRunning() const { return running_; }
     
+    // CPU for the processing thread, -1 for any; applied on start()
+    void setCpuAffinity(int cpu) { cpuAffinity_ = cpu; }
+    int getCpuAffinity() const { return cpuAffinity_; }
+    
+    // IQ samples lost because the processing thread fell behind
+    uint64_t getDroppedSamples() const { return droppedSamples_; }
+    
     // Signal measurements
     float getSignalStrength() const { return signalStrength_; }
     float getSquelchLevel() const { return squelchLevel_; }
     bool isSquelched() const { return squelched_; }
+    float getChannelSnr() const { return channelSnr_; }
     
 private:
     // Sample rate and mode
@@ -104,18 +156,53 @@ private:
     // Processing thread
     std::thread processingThread_;
     std::atomic<bool> running_;
+    int cpuAffinity_;
     
     // Buffers
     IQBuffer iqBuffer_;
+    std::atomic<uint64_t> droppedSamples_;
     std::vector<std::complex<float>> iqWorkBuffer_;
     std::vector<float> audioBuffer_;
-    std::vector<float> spectrumBuffer_;
+    std::vector<float> mpxBuffer_;      // FM composite for the RDS decoder
+    std::vector<float> decimatedAudio_; // demodulator output at the audio rate
+    
+    // FFT for spectrum; everything that depends on the FFT size lives in one
+    // plan object so a reconfiguration is a single pointer swap
+    struct SpectrumPlan {
+        size_t fftSize;
+        size_t hop;
+        fftwf_plan plan;
+        fftwf_complex* in;
+        fftwf_complex* out;
+        std::vector<float> window;
+        float powerScale;                       // 1 / coherent gain^2
+        std::vector<std::complex<float>> history;
+        std::vector<float> accum;               // summed |X|^2 since the last frame
+        
+        SpectrumPlan(size_t size, SpectrumWindow type, float overlap);
+        ~SpectrumPlan();
+    };
+    std::unique_ptr<SpectrumPlan> spectrumPlan_;        // processing thread only
+    std::unique_ptr<SpectrumPlan> pendingSpectrumPlan_; // guarded by spectrumPlanMutex_
+    bool spectrumPlanReady_;
+    std::mutex spectrumPlanMutex_;
+    size_t spectrumFFTSize_;
+    SpectrumWindow spectrumWindowType_;
+    float spectrumOverlap_;
+    
+    // Zoom spectrum, handed over through the same slot as the plan
+    std::unique_ptr<ZoomFFT> zoom_;                     // processing thread only
+    std::unique_ptr<ZoomFFT> pendingZoom_;              // guarded by spectrumPlanMutex_
+    bool zoomReady_;
+    uint32_t zoomDecimation_;
+    double zoomOffset_;
     
-    // FFT for spectrum
-    fftwf_plan fftPlan_;
-    fftwf_complex* fftIn_;
-    fftwf_complex* fftOut_;
-    size_t fftSize_;
+    // Spectrum frame assembly
+    size_t spectrumFill_;                       // samples in the plan's history
+    size_t spectrumAverages_;
+    size_t spectrumSamples_;
+    std::atomic<int> spectrumFrameRate_;
+    TripleBuffer<std::vector<float>> spectrumFrames_;
     
     // DSP components
     std::unique_ptr<AMDemodulator> amDemod_;
@@ -144,6 +231,8 @@ private:
     
     // Signal measurements
     std::atomic<float> signalStrength_;
+    std::atomic<float> channelSnr_;     // dB, from the spectrum frames
+    std::vector<float> snrScratch_;
     std::atomic<bool> squelched_;
     bool dynamicBandwidth_;
     
@@ -151,18 +240,25 @@ private:
     AudioCallback audioCallback_;
     SignalCallback signalCallback_;
     SpectrumCallback spectrumCallback_;
+    SpectrumCallback scanSpectrumCallback_;
+    std::atomic<bool> scanSpectrumEnabled_;
     
     // Processing methods
     void processingWorker();
     void convertIQData(const uint8_t* data, size_t length, std::complex<float>* output);
     void processSpectrum(const std::complex<float>* data, size_t length);
+    void adoptSpectrumPlan();
+    void processZoom(const std::complex<float>* data, size_t length);
+    void rebuildZoom();
+    void updateChannelSnr(const float* frame, size_t bins, double binWidth);
     void calculateSignalStrength(const std::complex<float>* data, size_t length);
     void demodulate(const std::complex<float>* input, size_t length, float* output);
     
-    // Audio decimation
+    // Audio decimation; AGC, squelch, noise reduction and CTCSS all run after it
+    std::unique_ptr<Decimator> audioDecimator_;
     uint32_t audioDecimation_;
     uint32_t audioSampleRate_;
-    size_t decimationCounter_;
+    static constexpr float AUDIO_PASSBAND = 16000.0f;  // 15 kHz broadcast FM audio plus margin
     
     // DC removal filter
     float dcI_;
@@ -0,0 +1,198 @@
+#include "DeviceManager.h"
+#include "../decoders/ADSBDecoder.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef HAS_SPDLOG
+#include <spdlog/spdlog.h>
+#endif
+
+DeviceManager::DeviceManager()
+    : nextId_(1) {
+}
+
+DeviceManager::~DeviceManager() {
+    stopAll();
+}
+
+std::vector<DeviceManager::DeviceInfo> DeviceManager::enumerate() {
+    std::vector<DeviceInfo> devices;
+    RTLSDRDevice probe;
+    int count = probe.getDeviceCount();
+    for (int i = 0; i < count; i++) {
+        devices.push_back({i, probe.getDeviceSerial(i), probe.getDeviceName(i)});
+    }
+    return devices;
+}
+
+int DeviceManager::addPipeline(const PipelineConfig& config) {
+    for (const auto& pipeline : pipelines_) {
+        if (pipeline->config.serial == config.serial) {
+            lastError_ = config.name + ": device " + config.serial + " already in use";
+            return -1;
+        }
+    }
+    // CPUs come straight from devices.json; a pin that cannot work is a typo
+    const int cpus = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu : {config.streamCpu, config.dspCpu}) {
+        if (cpu < -1 || (cpus > 0 && cpu >= cpus)) {
+            lastError_ = config.name + ": CPU " + std::to_string(cpu) +
+                         " is not one of this machine's (-1 for any)";
+            return -1;
+        }
+    }
+    if (config.adsb && config.sampleRate != ADSBDecoder::ADSB_SAMPLE_RATE) {
+        lastError_ = config.name + ": ADS-B needs a sample rate of " +
+                     std::to_string(ADSBDecoder::ADSB_SAMPLE_RATE) + " Hz";
+        return -1;
+    }
+    
+    auto pipeline = std::make_unique<Pipeline>();
+    pipeline->id = nextId_++;
+    pipeline->config = config;
+    
+    pipeline->device = std::make_unique<RTLSDRDevice>();
+    RTLSDRDevice* device = pipeline->device.get();
+    if (!device->openBySerial(config.serial)) {
+        lastError_ = config.name + ": " + device->getLastError();
+        return -1;
+    }
+    device->setSampleRate(config.sampleRate);
+    device->setCenterFrequency(config.frequency);
+    device->setGainMode(true);
+    device->setGain(config.gain);
+    device->setFrequencyCorrection(config.ppm);
+    if (config.biasT) {
+        device->setBiasT(true);
+    }
+    RTLSDRDevice::StreamConfig stream = RTLSDRDevice::getStreamPreset(config.preset);
+    stream.cpu = config.streamCpu;
+    device->setStreamConfig(stream);
+    
+    pipeline->engine = std::make_unique<DSPEngine>(config.sampleRate);
+    DSPEngine* engine = pipeline->engine.get();
+    engine->setMode(config.mode);
+    engine->setSquelch(config.squelch);
+    engine->setCurrentFrequency(config.frequency);
+    if (config.adsb) {
+        engine->enableADSB(true);
+    }
+    engine->setCpuAffinity(config.dspCpu);
+    
+    // Straight from the USB thread into this pipeline's ring
+    device->setDataCallback([engine](const uint8_t* data, size_t length) {
+        engine->processIQ(data, length);
+    });
+    
+#ifdef HAS_SPDLOG
+    spdlog::info("Pipeline {} on {} at {} Hz", config.name, config.serial, config.frequency);
+#endif
+    
+    pipelines_.push_back(std::move(pipeline));
+    return pipelines_.back()->id;
+}
+
+void DeviceManager::removePipeline(int id) {
+    stop(id);
+    pipelines_.erase(std::remove_if(pipelines_.begin(), pipelines_.end(),
+                                    [id](const std::unique_ptr<Pipeline>& p) { return p->id == id; }),
+                     pipelines_.end());
+}
+
+DeviceManager::Pipeline* DeviceManager::find(int id) const {
+    for (const auto& pipeline : pipelines_) {
+        if (pipeline->id == id) {
+            return pipeline.get();
+        }
+    }
+    return nullptr;
+}
+
+RTLSDRDevice* DeviceManager::getDevice(int id) const {
+    Pipeline* pipeline = find(id);
+    return pipeline ? pipeline->device.get() : nullptr;
+}
+
+DSPEngine* DeviceManager::getEngine(int id) const {
+    Pipeline* pipeline = find(id);
+    return pipeline ? pipeline->engine.get() : nullptr;
+}
+
+const DeviceManager::PipelineConfig* DeviceManager::getConfig(int id) const {
+    Pipeline* pipeline = find(id);
+    return pipeline ? &pipeline->config : nullptr;
+}
+
+std::vector<int> DeviceManager::getPipelineIds() const {
+    std::vector<int> ids;
+    for (const auto& pipeline : pipelines_) {
+        ids.push_back(pipeline->id);
+    }
+    return ids;
+}
+
+bool DeviceManager::start(int id) {
+    Pipeline* pipeline = find(id);
+    if (!pipeline) {
+        return false;
+    }
+    
+    // Consumer first, so the first USB block has somewhere to go
+    pipeline->engine->start();
+    if (!pipeline->device->startStreaming()) {
+        pipeline->engine->stop();
+        lastError_ = pipeline->config.name + ": " + pipeline->device->getLastError();
+        return false;
+    }
+    return true;
+}
+
+void DeviceManager::stop(int id) {
+    Pipeline* pipeline = find(id);
+    if (!pipeline) {
+        return;
+    }
+    pipeline->device->stopStreaming();
+    pipeline->engine->stop();
+}
+
+bool DeviceManager::startAll() {
+    // One failing dongle does not hold up the rest
+    bool ok = true;
+    for (const auto& pipeline : pipelines_) {
+        ok = start(pipeline->id) && ok;
+    }
+    return ok;
+}
+
+void DeviceManager::stopAll() {
+    for (const auto& pipeline : pipelines_) {
+        stop(pipeline->id);
+    }
+}
+
+DeviceManager::Stats DeviceManager::getStats() const {
+    Stats stats;
+    stats.streaming = 0;
+    stats.bytesReceived = 0;
+    stats.droppedSamples = 0;
+    
+    for (const auto& pipeline : pipelines_) {
+        PipelineStats p;
+        p.id = pipeline->id;
+        p.name = pipeline->config.name;
+        p.serial = pipeline->config.serial;
+        p.streaming = pipeline->device->isStreaming();
+        p.bytesReceived = pipeline->device->getBytesReceived();
+        p.droppedSamples = pipeline->engine->getDroppedSamples();
+        p.signalStrength = pipeline->engine->getSignalStrength();
+        p.squelched = pipeline->engine->isSquelched();
+        p.stream = pipeline->device->getStreamStats();
+        
+        stats.streaming += p.streaming ? 1 : 0;
+        stats.bytesReceived += p.bytesReceived;
+        stats.droppedSamples += p.droppedSamples;
+        stats.pipelines.push_back(p);
+    }
+    return stats;
+}
@@ -0,0 +1,100 @@
+#ifndef DEVICE_MANAGER_H
+#define DEVICE_MANAGER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "RTLSDRDevice.h"
+#include "DSPEngine.h"
+
+// Runs several dongles side by side, e.g. FM broadcast, airband, ADS-B and
+// NOAA in one process. Each pipeline is a device opened by serial number
+// (indexes change as dongles are replugged) feeding its own DSPEngine, so it
+// has its own USB streaming thread, IQ ring and DSP graph and shares nothing
+// with the others. Both threads can be pinned to a CPU per pipeline.
+//
+// Managed from one thread; getStats() only reads counters and is cheap.
+class DeviceManager {
+public:
+    struct DeviceInfo {
+        int index;
+        std::string serial;
+        std::string name;
+    };
+    
+    struct PipelineConfig {
+        std::string name;           // "Airband", for logs and stats
+        std::string serial;
+        uint32_t frequency;
+        uint32_t sampleRate;
+        int gain;                   // tenths of dB
+        int ppm;
+        bool biasT;
+        DSPEngine::Mode mode;
+        float squelch;              // dB
+        bool adsb;                  // run the ADS-B decoder; needs ADSB_SAMPLE_RATE
+        RTLSDRDevice::StreamPreset preset;  // USB buffering and thread priority
+        int streamCpu;              // CPU for the USB thread, -1 for any
+        int dspCpu;                 // CPU for the DSP thread, -1 for any
+    };
+    
+    struct PipelineStats {
+        int id;
+        std::string name;
+        std::string serial;
+        bool streaming;
+        uint64_t bytesReceived;
+        uint64_t droppedSamples;    // IQ lost to a DSP thread that fell behind
+        float signalStrength;
+        bool squelched;
+        RTLSDRDevice::StreamStats stream;   // USB callback timing
+    };
+    
+    struct Stats {
+        std::vector<PipelineStats> pipelines;
+        int streaming;
+        uint64_t bytesReceived;
+        uint64_t droppedSamples;
+    };
+    
+    DeviceManager();
+    ~DeviceManager();
+    
+    static std::vector<DeviceInfo> enumerate();
+    
+    // Opens and configures the device and builds its pipeline, stopped.
+    // Returns the pipeline id, or -1 (see getLastError()).
+    int addPipeline(const PipelineConfig& config);
+    void removePipeline(int id);
+    
+    // For hooking up outputs (audio, decoders) before start()
+    RTLSDRDevice* getDevice(int id) const;
+    DSPEngine* getEngine(int id) const;
+    std::vector<int> getPipelineIds() const;
+    const PipelineConfig* getConfig(int id) const;
+    
+    bool start(int id);
+    void stop(int id);
+    bool startAll();
+    void stopAll();
+    
+    Stats getStats() const;
+    std::string getLastError() const { return lastError_; }
+    
+private:
+    struct Pipeline {
+        int id;
+        PipelineConfig config;
+        std::unique_ptr<RTLSDRDevice> device;
+        std::unique_ptr<DSPEngine> engine;
+    };
+    
+    Pipeline* find(int id) const;
+    
+    std::vector<std::unique_ptr<Pipeline>> pipelines_;
+    int nextId_;
+    std::string lastError_;
+};
+
+#endif // DEVICE_MANAGER_H
@@ -1,6 +1,9 @@
 #include "RTLSDRDevice.h"
+#include "ThreadAffinity.h"
 #include <sstream>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 
 #ifdef HAS_SPDLOG
 #include <spdlog/spdlog.h>
@@ -9,6 +12,10 @@
 RTLSDRDevice::RTLSDRDevice() 
     : device_(nullptr)
     , streaming_(false)
+    , bytesReceived_(0)
+    , streamConfig_(getStreamPreset(StreamPreset::BALANCED))
+    , expectedIntervalMs_(0.0)
+    , priorityApplied_(false)
     , centerFreq_(96900000) // Default to 96.9 MHz FM
     , sampleRate_(2400000)  // Default 2.4 MHz
     , currentGain_(250)     // 25.0 dB
@@ -54,6 +61,24 @@ std::vector<std::string> RTLSDRDevice::getDeviceList() const {
     return devices;
 }
 
+std::string RTLSDRDevice::getDeviceSerial(int index) const {
+    char manufacturer[256], product[256], serial[256];
+    if (rtlsdr_get_device_usb_strings(index, manufacturer, product, serial) != 0) {
+        return "";
+    }
+    return serial;
+}
+
+bool RTLSDRDevice::openBySerial(const std::string& serial) {
+    // The index moves around as dongles are plugged in; the serial does not
+    int index = rtlsdr_get_index_by_serial(serial.c_str());
+    if (index < 0) {
+        setError("No device with serial " + serial);
+        return false;
+    }
+    return open(index);
+}
+
 bool RTLSDRDevice::open(int deviceIndex) {
     if (device_) {
         close();
@@ -267,11 +292,24 @@ bool RTLSDRDevice::startStreaming() {
         return true;
     }
     
+    // Fresh timing statistics for this run
+    streamConfig_.bufferLength = std::max<uint32_t>(512, (streamConfig_.bufferLength + 511) / 512 * 512);
+    expectedIntervalMs_ = sampleRate_ > 0 ? streamConfig_.bufferLength * 1000.0 / (2.0 * sampleRate_) : 0.0;
+    timing_ = CallbackTiming{std::chrono::steady_clock::time_point(), 0, 0.0, 0.0, 0.0, 0};
+    priorityApplied_ = false;
+    streamStats_.reset(StreamStats{0, expectedIntervalMs_, 0.0, 0.0, 0.0, 0, false});
+    
     streaming_ = true;
     streamingThread_ = std::thread(&RTLSDRDevice::streamingWorker, this);
+    if (!pinThreadToCpu(streamingThread_, streamConfig_.cpu)) {
+#ifdef HAS_SPDLOG
+        spdlog::warn("Could not pin the streaming thread to CPU {}", streamConfig_.cpu);
+#endif
+    }
     
 #ifdef HAS_SPDLOG
-    spdlog::info("Started streaming");
+    spdlog::info("Started streaming: {} x {} byte transfers, a callback every {:.2f} ms",
+                 streamConfig_.bufferCount, streamConfig_.bufferLength, expectedIntervalMs_);
 #endif
     
     return true;
@@ -298,14 +336,86 @@ void RTLSDRDevice::stopStreaming() {
 }
 
 void RTLSDRDevice::streamingWorker() {
-    const int bufferSize = 16384 * 2; // 16K IQ samples
-    rtlsdr_read_async(device_, rtlsdrCallback, this, 0, bufferSize);
+    priorityApplied_ = applyStreamPriority();
+    rtlsdr_read_async(device_, rtlsdrCallback, this, streamConfig_.bufferCount, streamConfig_.bufferLength);
+}
+
+bool RTLSDRDevice::applyStreamPriority() {
+    // Runs on the streaming thread, which is also where the callbacks come
+    switch (streamConfig_.priority) {
+        case StreamPriority::REALTIME:
+            if (setCurrentThreadRealtime(REALTIME_PRIORITY)) {
+                return true;
+            }
+#ifdef HAS_SPDLOG
+            spdlog::warn("SCHED_FIFO not permitted (needs CAP_SYS_NICE or an rtprio limit); trying nice");
+#endif
+            // fall through
+        case StreamPriority::HIGH:
+            if (setCurrentThreadNice(HIGH_PRIORITY_NICE)) {
+                return true;
+            }
+#ifdef HAS_SPDLOG
+            spdlog::warn("Could not raise the streaming thread priority");
+#endif
+            return false;
+        default:
+            return true;
+    }
+}
+
+RTLSDRDevice::StreamConfig RTLSDRDevice::getStreamPreset(StreamPreset preset) {
+    switch (preset) {
+        case StreamPreset::LOW_LATENCY:
+            // 1.7 ms per transfer at 2.4 MS/s, about 55 ms in flight
+            return {32, 4096 * 2, StreamPriority::REALTIME, -1};
+        case StreamPreset::ROBUST:
+            // 27 ms per transfer, close to a second in flight
+            return {32, 65536 * 2, StreamPriority::HIGH, -1};
+        default:
+            // 6.8 ms per transfer, 15 of them
+            return {0, 16384 * 2, StreamPriority::NORMAL, -1};
+    }
+}
+
+RTLSDRDevice::StreamStats RTLSDRDevice::getStreamStats() const {
+    streamStats_.update();
+    return streamStats_.readBuffer();
+}
+
+void RTLSDRDevice::updateTiming() {
+    auto now = std::chrono::steady_clock::now();
+    if (timing_.last != std::chrono::steady_clock::time_point()) {
+        // Welford's running mean and variance
+        double interval = std::chrono::duration<double, std::milli>(now - timing_.last).count();
+        timing_.intervals++;
+        double delta = interval - timing_.mean;
+        timing_.mean += delta / timing_.intervals;
+        timing_.m2 += delta * (interval - timing_.mean);
+        timing_.max = std::max(timing_.max, interval);
+        if (interval > 2.0 * expectedIntervalMs_) {
+            timing_.late++;
+        }
+    }
+    timing_.last = now;
+    
+    StreamStats& stats = streamStats_.writeBuffer();
+    stats.callbacks = timing_.intervals + 1;
+    stats.expectedIntervalMs = expectedIntervalMs_;
+    stats.meanIntervalMs = timing_.mean;
+    stats.jitterMs = timing_.intervals > 1 ? std::sqrt(timing_.m2 / (timing_.intervals - 1)) : 0.0;
+    stats.maxIntervalMs = timing_.max;
+    stats.lateCallbacks = timing_.late;
+    stats.priorityApplied = priorityApplied_;
+    streamStats_.publish();
 }
 
 void RTLSDRDevice::rtlsdrCallback(unsigned char* buf, uint32_t len, void* ctx) {
     RTLSDRDevice* device = static_cast<RTLSDRDevice*>(ctx);
     
+    device->updateTiming();
     if (device->streaming_ && device->dataCallback_) {
+        device->bytesReceived_ += len;
         device->dataCallback_(buf, len);
     }
 }
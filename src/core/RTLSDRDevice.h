@@ -7,9 +7,11 @@
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <chrono>
 #include <cstddef>  // for size_t
 #include <cstdint>  // for uint32_t, uint8_t
 #include <rtl-sdr.h>
+#include "TripleBuffer.h"
 
 class RTLSDRDevice {
 public:
@@ -20,9 +22,11 @@ public:
     int getDeviceCount() const;
     std::string getDeviceName(int index) const;
     std::vector<std::string> getDeviceList() const;
+    std::string getDeviceSerial(int index) const;
     
     // Device control
     bool open(int deviceIndex = 0);
+    bool openBySerial(const std::string& serial);
     void close();
     bool isOpen() const { return device_ != nullptr; }
     
@@ -53,6 +57,49 @@ public:
     bool startStreaming();
     void stopStreaming();
     bool isStreaming() const { return streaming_; }
+    uint64_t getBytesReceived() const { return bytesReceived_; }
+    
+    // USB transfers and streaming thread scheduling, applied when streaming
+    // starts. Shorter transfers mean less latency but a callback more often;
+    // more transfers in flight ride out longer stalls before samples are lost.
+    enum class StreamPriority {
+        NORMAL,
+        HIGH,           // nice -10
+        REALTIME        // SCHED_FIFO, falling back to HIGH without the privilege
+    };
+    
+    enum class StreamPreset {
+        LOW_LATENCY,
+        BALANCED,       // as before presets: 15 transfers of 32 KiB (16K samples)
+        ROBUST
+    };
+    
+    struct StreamConfig {
+        uint32_t bufferCount;       // transfers in flight, 0 for the library default
+        uint32_t bufferLength;      // bytes per transfer, rounded up to 512
+        StreamPriority priority;
+        int cpu;                    // -1 for any
+    };
+    
+    static StreamConfig getStreamPreset(StreamPreset preset);
+    void setStreamConfig(const StreamConfig& config) { streamConfig_ = config; }
+    StreamConfig getStreamConfig() const { return streamConfig_; }
+    void setCpuAffinity(int cpu) { streamConfig_.cpu = cpu; }
+    int getCpuAffinity() const { return streamConfig_.cpu; }
+    
+    // Callback timing since streaming started; a late callback came after
+    // more than twice the expected interval. From one reader thread only.
+    struct StreamStats {
+        uint64_t callbacks;
+        double expectedIntervalMs;
+        double meanIntervalMs;
+        double jitterMs;            // standard deviation of the interval
+        double maxIntervalMs;
+        uint64_t lateCallbacks;
+        bool priorityApplied;
+    };
+    
+    StreamStats getStreamStats() const;
     
     // Error handling
     std::string getLastError() const { return lastError_; }
@@ -81,6 +128,26 @@ private:
     std::thread streamingThread_;
     std::atomic<bool> streaming_;
     DataCallback dataCallback_;
+    std::atomic<uint64_t> bytesReceived_;
+    StreamConfig streamConfig_;
+    
+    // Callback interval statistics, kept on the streaming thread and
+    // published for the reader
+    struct CallbackTiming {
+        std::chrono::steady_clock::time_point last;
+        uint64_t intervals;
+        double mean;
+        double m2;                  // running sum of squared deviations
+        double max;
+        uint64_t late;
+    };
+    CallbackTiming timing_;
+    double expectedIntervalMs_;
+    std::atomic<bool> priorityApplied_;
+    mutable TripleBuffer<StreamStats> streamStats_;
+    
+    static constexpr int REALTIME_PRIORITY = 50;
+    static constexpr int HIGH_PRIORITY_NICE = -10;
     
     // Current settings
     uint32_t centerFreq_;
@@ -95,6 +162,8 @@ private:
     
     // Streaming worker
     void streamingWorker();
+    bool applyStreamPriority();
+    void updateTiming();
     static void rtlsdrCallback(unsigned char* buf, uint32_t len, void* ctx);
     
     // Error handling
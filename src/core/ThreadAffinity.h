@@ -0,0 +1,65 @@
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Pins a running thread to one CPU, so that the stages of a pipeline keep
+// their core (and its cache) when several pipelines share the machine.
+// cpu < 0 leaves the thread to the scheduler. Linux only; elsewhere, or for
+// a CPU that does not exist, the call fails and the thread runs unpinned.
+inline bool pinThreadToCpu(std::thread& thread, int cpu) {
+    if (cpu < 0) {
+        return true;
+    }
+    if (!thread.joinable()) {
+        return false;
+    }
+    
+#ifdef __linux__
+    // CPU_SET past the end of the set is undefined
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+// Scheduling for the calling thread, e.g. a USB streaming thread that must
+// not be starved. SCHED_FIFO needs CAP_SYS_NICE or an rtprio limit and a
+// negative nice value needs the same; without them both calls fail and the
+// thread keeps its normal priority.
+inline bool setCurrentThreadRealtime(int priority) {
+#ifdef __linux__
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    (void)priority;
+    return false;
+#endif
+}
+
+inline bool setCurrentThreadNice(int nice) {
+#ifdef __linux__
+    // On Linux nice is per thread, addressed by its kernel thread id
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) == 0;
+#else
+    (void)nice;
+    return false;
+#endif
+}
+
+#endif // THREAD_AFFINITY_H
@@ -0,0 +1,58 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Single producer / single consumer "latest wins" exchange. The writer fills the
+// back buffer and publishes it; the reader picks up only the newest published
+// buffer. Neither side ever blocks and stale frames are silently dropped.
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer()
+        : backIndex_(0)
+        , frontIndex_(1)
+        , middle_(2) {
+    }
+    
+    // Writer side
+    T& writeBuffer() { return buffers_[backIndex_]; }
+    
+    void publish() {
+        uint8_t previous = middle_.exchange(backIndex_ | DIRTY, std::memory_order_acq_rel);
+        backIndex_ = previous & INDEX_MASK;
+    }
+    
+    // Reader side: returns true if a newer buffer was swapped in
+    bool update() {
+        if (!(middle_.load(std::memory_order_acquire) & DIRTY)) {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(frontIndex_, std::memory_order_acq_rel);
+        frontIndex_ = previous & INDEX_MASK;
+        return true;
+    }
+    
+    const T& readBuffer() const { return buffers_[frontIndex_]; }
+    
+    // Only while neither side is active
+    void reset(const T& value) {
+        buffers_.fill(value);
+        backIndex_ = 0;
+        frontIndex_ = 1;
+        middle_.store(2, std::memory_order_release);
+    }
+    
+private:
+    static constexpr uint8_t DIRTY = 0x4;
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    
+    std::array<T, 3> buffers_;
+    uint8_t backIndex_;               // owned by the writer
+    uint8_t frontIndex_;              // owned by the reader
+    std::atomic<uint8_t> middle_;     // shared slot index plus dirty flag
+};
+
+#endif // TRIPLEBUFFER_H
@@ -44,6 +44,10 @@ public:
     void setGainReduction(int db) { gainReduction_ = db; }
     int getGainReduction() const { return gainReduction_; }
     
+    // The demodulator counts two samples per microsecond; IQ at any other
+    // rate does not decode
+    static constexpr int ADSB_SAMPLE_RATE = 2000000;   // 2 MHz
+    
 signals:
     void aircraftDetected(uint32_t icao);
     void aircraftUpdated(uint32_t icao, const Aircraft& aircraft);
@@ -82,7 +86,6 @@ private:
     static constexpr int ADSB_PREAMBLE_LENGTH = 16;    // bits
     static constexpr int ADSB_SHORT_MSG_LENGTH = 56;   // bits
     static constexpr int ADSB_LONG_MSG_LENGTH = 112;   // bits
-    static constexpr int ADSB_SAMPLE_RATE = 2000000;   // 2 MHz
     static constexpr float ADSB_FREQ = 1090e6;         // 1090 MHz
     
     // Signal processing
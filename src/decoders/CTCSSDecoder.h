@@ -30,6 +30,7 @@ public:
     // Get detected tone info
     float getCurrentTone() const { return currentTone_; }
     float getCurrentLevel() const { return currentLevel_; }
+    bool isToneDetected() const { return toneDetected_; }
     
     // Standard CTCSS tones
     static constexpr std::array<float, 50> CTCSS_TONES = {
@@ -1,6 +1,7 @@
 #include "RDSDecoder.h"
 #include <QVariantMap>
 #include <cmath>
+#include <algorithm>
 #include <QDateTime>
 
 #ifdef HAS_SPDLOG
@@ -20,19 +21,52 @@ const uint16_t RDSDecoder::OFFSET_WORDS[5] = {
     0x350   // C'
 };
 
+// Correctable burst errors (up to 5 bits) for every syndrome, 0 where none fits
+const std::array<uint32_t, 1024> RDSDecoder::SYNDROME_TABLE = RDSDecoder::buildSyndromeTable();
+
+// Group handlers indexed by (group type << 1) | version B
+const std::array<RDSDecoder::GroupHandler, 32> RDSDecoder::GROUP_HANDLERS =
+    RDSDecoder::buildGroupHandlers();
+
 RDSDecoder::RDSDecoder(QObject* parent)
     : DigitalDecoder(DecoderType::RDS, parent)
+    , mixerPhasor_(1.0f, 0.0f)
+    , mixerStep_(1.0f, 0.0f)
+    , decimation_(1)
+    , decimationCount_(0)
+    , decimatedRate_(RDS_DECIMATED_RATE)
+    , matchedIndex_(0)
     , carrierPhase_(0.0f)
-    , carrierFreq_(RDS_CARRIER_FREQ)
-    , pilotPhase_(0.0f)
+    , carrierFreq_(0.0f)
+    , costasAlpha_(0.0f)
+    , costasBeta_(0.0f)
+    , carrierLockLevel_(0.0f)
     , carrierLocked_(false)
     , symbolPhase_(0.0f)
-    , symbolRate_(RDS_SYMBOL_RATE)
+    , samplesPerSymbol_(RDS_DECIMATED_RATE / RDS_BIPHASE_RATE)
+    , timingGain_(0.0f)
+    , symbolAmplitude_(1.0f)
+    , lastSample_(0.0f)
+    , lastStrobe_(0.0f)
+    , midStrobe_(0.0f)
+    , midStrobeNext_(false)
     , bufferIndex_(0)
+    , previousHalfSymbol_(0.0f)
+    , halfSymbolCount_(0)
+    , biphaseParity_(0)
+    , lastCodedBit_(0)
     , bitBuffer_(0)
     , bitCount_(0)
+    , bitsReceived_(0)
+    , syncCandidateBit_(0)
+    , syncCandidatePosition_(0)
     , blockCount_(0)
     , groupSync_(false)
+    , statsStartBit_(0)
+    , statsBlocks_(0)
+    , statsBlockErrors_(0)
+    , statsCorrected_(0)
+    , statsGroups_(0)
     , programID_(0)
     , programType_(0)
     , trafficProgram_(false)
@@ -42,14 +76,25 @@ RDSDecoder::RDSDecoder(QObject* parent)
     , modifiedJulianDay_(0)
     , hours_(0)
     , minutes_(0)
-    , localTimeOffset_(0) {
+    , localTimeOffset_(0)
+    , afListLength_(0)
+    , programItemNumber_(0)
+    , extendedCountryCode_(0)
+    , ptynABFlag_(0)
+    , tmcPendingValid_(false)
+    , lastTmcKey_(0)
+    , tmcLocationTable_(0) {
     
     // Initialize buffers
     psBuffer_.fill(' ');
     psValid_.fill(false);
     rtBuffer_.fill(' ');
     rtValid_.fill(false);
+    ptynBuffer_.fill(' ');
+    ptynValid_.fill(false);
     currentGroup_.fill(0);
+    blockValid_.fill(false);
+    biphaseEnergy_.fill(0.0f);
 }
 
 RDSDecoder::~RDSDecoder() {
@@ -61,47 +106,50 @@ void RDSDecoder::start() {
         return;
     }
     
+    // The composite signal must be sampled well above the 57kHz subcarrier
+    if (sampleRate_ < 2 * (RDS_CARRIER_FREQ + RDS_BIPHASE_RATE)) {
+        emitError(QString("RDS needs the FM composite signal, %1 Hz is too low").arg(sampleRate_));
+        return;
+    }
+    
     active_ = true;
     setState(DecoderState::SEARCHING);
     
-    // Calculate samples per symbol
-    samplesPerSymbol_ = sampleRate_ / symbolRate_;
+    // Everything after the mixer runs at ~19 kHz (8 samples per half-symbol)
+    decimation_ = std::max<size_t>(1, static_cast<size_t>(
+        std::lround(sampleRate_ / RDS_DECIMATED_RATE)));
+    decimatedRate_ = static_cast<float>(sampleRate_) / decimation_;
+    samplesPerSymbol_ = decimatedRate_ / RDS_BIPHASE_RATE;
     
-    // Initialize filters
-    // 57kHz bandpass filter (56-58kHz)
-    float fc = RDS_CARRIER_FREQ / sampleRate_;
-    float bw = 2000.0f / sampleRate_;  // 2kHz bandwidth
+    // Mixer step for shifting 57kHz down to DC
+    float omega = 2.0f * M_PI * RDS_CARRIER_FREQ / sampleRate_;
+    mixerStep_ = std::complex<float>(cosf(omega), -sinf(omega));
     
-    float omega = 2.0f * M_PI * fc;
-    float alpha = sinf(omega) * sinhf(logf(2.0f) / 2.0f * bw * omega / sinf(omega));
+    // Rising half of the triangular decimation window, normalized to unity DC gain
+    float norm = 1.0f / (static_cast<float>(decimation_) * decimation_);
+    decimationRamp_.resize(decimation_);
+    for (size_t n = 0; n < decimation_; n++) {
+        decimationRamp_[n] = (n + 1) * norm;
+    }
     
-    rdsFilter_.b0 = alpha;
-    rdsFilter_.b1 = 0.0f;
-    rdsFilter_.b2 = -alpha;
-    rdsFilter_.a1 = -2.0f * cosf(omega);
-    rdsFilter_.a2 = 1.0f - alpha;
+    designMatchedFilter();
     
-    // Normalize
-    float a0 = 1.0f + alpha;
-    rdsFilter_.b0 /= a0;
-    rdsFilter_.b1 /= a0;
-    rdsFilter_.b2 /= a0;
-    rdsFilter_.a1 /= a0;
-    rdsFilter_.a2 /= a0;
+    // Costas loop: ~5 Hz loop bandwidth is plenty for a pilot-locked subcarrier
+    loopCoefficients(5.0f / decimatedRate_, 0.707f, costasAlpha_, costasBeta_);
     
-    // Reset filter states
-    rdsFilter_.x1 = rdsFilter_.x2 = 0.0f;
-    rdsFilter_.y1 = rdsFilter_.y2 = 0.0f;
+    // Gardner loop gain in samples per unit (normalized) error
+    timingGain_ = 0.02f * samplesPerSymbol_;
     
     // Allocate demodulation buffers
-    size_t bufferSize = static_cast<size_t>(samplesPerSymbol_ * 10);
-    i_buffer_.resize(bufferSize);
-    q_buffer_.resize(bufferSize);
+    i_buffer_.resize(RDS_BASEBAND_BLOCK);
+    q_buffer_.resize(RDS_BASEBAND_BLOCK);
+    symbolBuffer_.reserve(RDS_BASEBAND_BLOCK);
     
     reset();
     
 #ifdef HAS_SPDLOG
-    spdlog::info("RDS decoder started - Sample rate: {} Hz", sampleRate_);
+    spdlog::info("RDS decoder started - Sample rate: {} Hz, baseband {} Hz (decimation {})",
+                 sampleRate_, decimatedRate_, decimation_);
 #endif
 }
 
@@ -120,19 +168,48 @@ void RDSDecoder::stop() {
 
 void RDSDecoder::reset() {
     // Reset demodulation state
+    mixerPhasor_ = std::complex<float>(1.0f, 0.0f);
+    decimationCount_ = 0;
+    decimationCurrent_ = decimationNext_ = decimationCarry_ = std::complex<float>(0.0f, 0.0f);
+    std::fill(matchedDelay_.begin(), matchedDelay_.end(), std::complex<float>(0.0f, 0.0f));
+    matchedIndex_ = 0;
+    
     carrierPhase_ = 0.0f;
-    pilotPhase_ = 0.0f;
+    carrierFreq_ = 0.0f;
+    carrierLockLevel_ = 0.0f;
     carrierLocked_ = false;
+    
     symbolPhase_ = 0.0f;
+    symbolAmplitude_ = 1.0f;
+    lastSample_ = 0.0f;
+    lastStrobe_ = 0.0f;
+    midStrobe_ = 0.0f;
+    midStrobeNext_ = false;
     bufferIndex_ = 0;
     
     // Reset decoder state
     symbolBuffer_.clear();
+    previousHalfSymbol_ = 0.0f;
+    biphaseEnergy_.fill(0.0f);
+    halfSymbolCount_ = 0;
+    biphaseParity_ = 0;
+    lastCodedBit_ = 0;
     bitBuffer_ = 0;
     bitCount_ = 0;
+    bitsReceived_ = 0;
+    syncCandidateBit_ = 0;
+    syncCandidatePosition_ = 0;
+    blockErrors_.reset();
     blockCount_ = 0;
     groupSync_ = false;
     currentGroup_.fill(0);
+    blockValid_.fill(false);
+    
+    statsStartBit_ = 0;
+    statsBlocks_ = 0;
+    statsBlockErrors_ = 0;
+    statsCorrected_ = 0;
+    statsGroups_ = 0;
     
     // Clear decoded data
     programID_ = 0;
@@ -150,6 +227,35 @@ void RDSDecoder::reset() {
     rtABFlag_ = 0;
     
     alternativeFreqs_.clear();
+    afCodes_.clear();
+    afListLength_ = 0;
+    
+    programItemNumber_ = 0;
+    extendedCountryCode_ = 0;
+    programTypeName_.clear();
+    ptynBuffer_.fill(' ');
+    ptynValid_.fill(false);
+    ptynABFlag_ = 0;
+    
+    odaApplications_.clear();
+    tmcPending_ = TMCMessage();
+    tmcPendingValid_ = false;
+    lastTmcKey_ = 0;
+    tmcLocationTable_ = 0;
+    otherNetworks_.clear();
+}
+
+void RDSDecoder::setSampleRate(uint32_t sampleRate) {
+    if (sampleRate == sampleRate_) {
+        return;
+    }
+    
+    bool wasActive = active_;
+    stop();
+    DigitalDecoder::setSampleRate(sampleRate);
+    if (wasActive) {
+        start();
+    }
 }
 
 void RDSDecoder::processAudio(const float* samples, size_t length) {
@@ -161,97 +267,312 @@ void RDSDecoder::processAudio(const float* samples, size_t length) {
     extract57kHz(samples, length);
 }
 
+void RDSDecoder::replayBits(const uint8_t* bits, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        processBit(bits[i] & 1);
+    }
+}
+
+void RDSDecoder::replayGroups(const uint16_t* blocks, size_t groupCount) {
+    for (size_t g = 0; g < groupCount; g++) {
+        std::copy(blocks + 4 * g, blocks + 4 * g + 4, currentGroup_.begin());
+        processGroups();
+    }
+}
+
 void RDSDecoder::extract57kHz(const float* samples, size_t length) {
+    // This is the only stage that runs at the full composite rate, so it is kept
+    // to a phasor rotation and two multiply-accumulates per sample.
+    const float invDecimation = 1.0f / decimation_;
+    
     for (size_t i = 0; i < length; i++) {
-        // Apply 57kHz bandpass filter
-        float filtered = rdsFilter_.process(samples[i]);
-        
-        // Demodulate using coherent detection
-        float phase = carrierPhase_;
-        float i_sample = filtered * cosf(phase);
-        float q_sample = filtered * -sinf(phase);
-        
-        // Low-pass filter (simple moving average for now)
-        // In a real implementation, this would be a proper low-pass filter
-        static float i_avg = 0.0f, q_avg = 0.0f;
-        i_avg = 0.95f * i_avg + 0.05f * i_sample;
-        q_avg = 0.95f * q_avg + 0.05f * q_sample;
+        std::complex<float> mixed = mixerPhasor_ * samples[i];
+        mixerPhasor_ *= mixerStep_;
         
-        // Update carrier phase
-        carrierPhase_ += 2.0f * M_PI * carrierFreq_ / sampleRate_;
-        if (carrierPhase_ > 2.0f * M_PI) {
-            carrierPhase_ -= 2.0f * M_PI;
-        }
+        // Each input sample feeds the rising edge of the current output and the
+        // falling edge of the next one (triangle window of length 2*D-1)
+        float w = decimationRamp_[decimationCount_];
+        decimationCurrent_ += mixed * w;
+        decimationNext_ += mixed * (invDecimation - w);
         
-        // Store demodulated samples
-        if (bufferIndex_ < i_buffer_.size()) {
-            i_buffer_[bufferIndex_] = i_avg;
-            q_buffer_[bufferIndex_] = q_avg;
-            bufferIndex_++;
+        if (++decimationCount_ == decimation_) {
+            std::complex<float> baseband = decimationCurrent_ + decimationCarry_;
+            decimationCarry_ = decimationNext_;
+            decimationCurrent_ = decimationNext_ = std::complex<float>(0.0f, 0.0f);
+            decimationCount_ = 0;
             
-            if (bufferIndex_ >= i_buffer_.size()) {
-                // Process buffer
+            i_buffer_[bufferIndex_] = baseband.real();
+            q_buffer_[bufferIndex_] = baseband.imag();
+            if (++bufferIndex_ >= i_buffer_.size()) {
                 demodulateRDS();
                 bufferIndex_ = 0;
             }
         }
     }
+    
+    // Keep the recursive phasor on the unit circle
+    mixerPhasor_ /= std::abs(mixerPhasor_);
 }
 
 void RDSDecoder::demodulateRDS() {
-    // Simple BPSK demodulation
-    // In a real implementation, this would include:
-    // - Carrier recovery with PLL
-    // - Symbol timing recovery
-    // - Differential decoding
-    
-    for (size_t i = 0; i < bufferIndex_; i += static_cast<size_t>(samplesPerSymbol_)) {
-        // Simple slicer for BPSK
-        float symbol = i_buffer_[i];
-        int bit = (symbol > 0) ? 1 : 0;
+    const size_t taps = matchedFilter_.size();
+    const float strobeInterval = samplesPerSymbol_ * 0.5f;
+    
+    for (size_t n = 0; n < bufferIndex_; n++) {
+        // Root-raised-cosine matched filter
+        std::complex<float> sample(i_buffer_[n], q_buffer_[n]);
+        matchedDelay_[matchedIndex_] = sample;
+        matchedDelay_[matchedIndex_ + taps] = sample;
+        if (++matchedIndex_ >= taps) {
+            matchedIndex_ = 0;
+        }
         
-        // Add to bit buffer
-        bitBuffer_ = (bitBuffer_ << 1) | bit;
-        bitCount_++;
+        const std::complex<float>* history = &matchedDelay_[matchedIndex_];
+        float fi = 0.0f;
+        float fq = 0.0f;
+        for (size_t k = 0; k < taps; k++) {
+            fi += matchedFilter_[k] * history[k].real();
+            fq += matchedFilter_[k] * history[k].imag();
+        }
+        
+        // Costas loop removes the residual carrier phase/frequency
+        float c = cosf(carrierPhase_);
+        float s = sinf(carrierPhase_);
+        float yi = fi * c + fq * s;
+        float yq = fq * c - fi * s;
         
-        if (bitCount_ >= 26) {  // One RDS block
-            // Extract block
-            uint32_t block = bitBuffer_ & 0x3FFFFFF;  // 26 bits
+        float power = yi * yi + yq * yq + 1e-20f;
+        float phaseError = (yi > 0.0f ? yq : -yq) / sqrtf(power);
+        carrierFreq_ += costasBeta_ * phaseError;
+        carrierPhase_ += carrierFreq_ + costasAlpha_ * phaseError;
+        if (carrierPhase_ > M_PI) {
+            carrierPhase_ -= 2.0f * M_PI;
+        } else if (carrierPhase_ < -M_PI) {
+            carrierPhase_ += 2.0f * M_PI;
+        }
+        
+        // Lock indicator: energy concentrated on the in-phase arm
+        carrierLockLevel_ += 0.001f * ((yi * yi - yq * yq) / power - carrierLockLevel_);
+        bool locked = carrierLockLevel_ > 0.5f;
+        if (locked != carrierLocked_) {
+            carrierLocked_ = locked;
+            if (!groupSync_) {
+                setState(locked ? DecoderState::SYNCING : DecoderState::SEARCHING);
+            }
+        }
+        
+        // Gardner timing recovery: on-time and mid-point strobes per half-symbol
+        symbolPhase_ += 1.0f;
+        if (symbolPhase_ >= strobeInterval) {
+            symbolPhase_ -= strobeInterval;
+            
+            // Interpolate back to the strobe instant
+            float strobe = yi - symbolPhase_ * (yi - lastSample_);
             
-            // Check and correct errors
-            if (checkAndCorrectBlock(block)) {
-                // Extract information bits (16 bits)
-                uint16_t data = (block >> 10) & 0xFFFF;
+            if (midStrobeNext_) {
+                midStrobe_ = strobe;
+            } else {
+                symbolAmplitude_ += 0.01f * (fabsf(strobe) - symbolAmplitude_);
+                float norm = 1.0f / (symbolAmplitude_ * symbolAmplitude_ + 1e-20f);
+                float timingError = (strobe - lastStrobe_) * midStrobe_ * norm;
+                timingError = std::max(-1.0f, std::min(1.0f, timingError));
                 
-                currentGroup_[blockCount_++] = data;
+                // Positive error means we are late: strobe earlier
+                symbolPhase_ += timingGain_ * timingError;
                 
-                if (blockCount_ >= 4) {
-                    // Process complete group
-                    processGroups();
-                    blockCount_ = 0;
-                    
-                    if (!groupSync_) {
-                        groupSync_ = true;
-                        setState(DecoderState::DECODING);
-                    }
-                }
-            } else {
-                // Sync error - reset block counter
-                blockCount_ = 0;
-                if (groupSync_) {
-                    groupSync_ = false;
-                    setState(DecoderState::SYNCING);
-                }
+                lastStrobe_ = strobe;
+                symbolBuffer_.push_back(strobe);
             }
-            
-            bitCount_ = 0;
+            midStrobeNext_ = !midStrobeNext_;
         }
+        lastSample_ = yi;
     }
+    
+    decodeSymbols();
 }
 
 void RDSDecoder::decodeSymbols() {
-    // This would implement proper symbol decoding
-    // For now, it's handled in demodulateRDS
+    // Each data bit is a pair of opposite-polarity half-symbols. The correct
+    // pairing is the one whose half-symbol differences carry the most energy.
+    for (float halfSymbol : symbolBuffer_) {
+        float difference = previousHalfSymbol_ - halfSymbol;
+        size_t parity = halfSymbolCount_ & 1;
+        biphaseEnergy_[parity] += fabsf(difference);
+        
+        if (parity == biphaseParity_) {
+            // Differential decoding also removes the Costas 180 degree ambiguity
+            int codedBit = difference > 0.0f ? 1 : 0;
+            processBit(codedBit ^ lastCodedBit_);
+            lastCodedBit_ = codedBit;
+        }
+        
+        previousHalfSymbol_ = halfSymbol;
+        
+        if (++halfSymbolCount_ % 128 == 0) {
+            biphaseParity_ = (biphaseEnergy_[1] > biphaseEnergy_[0]) ? 1 : 0;
+            biphaseEnergy_[0] *= 0.5f;
+            biphaseEnergy_[1] *= 0.5f;
+        }
+    }
+    
+    symbolBuffer_.clear();
+}
+
+void RDSDecoder::processBit(int bit) {
+    bitBuffer_ = ((bitBuffer_ << 1) | bit) & 0x3FFFFFF;
+    bitsReceived_++;
+    
+    if (!groupSync_) {
+        acquireBlockSync();
+    } else if (++bitCount_ >= RDS_BITS_PER_BLOCK) {
+        processBlock(bitBuffer_);
+        bitCount_ = 0;
+    }
+    
+    if (bitsReceived_ - statsStartBit_ >= RDS_STATS_BITS) {
+        emitStatistics();
+    }
+}
+
+void RDSDecoder::acquireBlockSync() {
+    // Slide the 26 bit window one bit at a time. Sync is declared once two offset
+    // words turn up a whole number of blocks apart and in the right sequence.
+    uint16_t syndrome = calculateSyndrome(bitBuffer_);
+    
+    for (size_t offset = 0; offset < 5; offset++) {
+        if (syndrome != OFFSET_WORDS[offset]) {
+            continue;
+        }
+        
+        size_t position = (offset == 4) ? 2 : offset;  // C' sits where C does
+        uint64_t distance = bitsReceived_ - syncCandidateBit_;
+        
+        if (syncCandidateBit_ != 0 && distance % RDS_BITS_PER_BLOCK == 0 &&
+            distance <= RDS_SYNC_SPAN * RDS_BITS_PER_BLOCK &&
+            (syncCandidatePosition_ + distance / RDS_BITS_PER_BLOCK) % 4 == position) {
+            groupSync_ = true;
+            bitCount_ = 0;
+            blockErrors_.reset();
+            blockValid_.fill(false);
+            currentGroup_[position] = (bitBuffer_ >> 10) & 0xFFFF;
+            blockValid_[position] = true;
+            blockCount_ = (position + 1) % 4;
+            setState(DecoderState::DECODING);
+            
+#ifdef HAS_SPDLOG
+            spdlog::info("RDS block sync acquired after {} bits", bitsReceived_);
+#endif
+            return;
+        }
+        
+        syncCandidateBit_ = bitsReceived_;
+        syncCandidatePosition_ = position;
+        return;
+    }
+}
+
+void RDSDecoder::processBlock(uint32_t block) {
+    size_t position = blockCount_;
+    blockCount_ = (blockCount_ + 1) % 4;
+    
+    bool corrected = false;
+    bool valid = checkAndCorrectBlock(block, position, corrected);
+    blockValid_[position] = valid;
+    if (valid) {
+        currentGroup_[position] = (block >> 10) & 0xFFFF;
+    }
+    
+    // A corrected block may well be a miscorrected one, so it counts against
+    // the sync as much as an uncorrectable one does
+    blockErrors_ <<= 1;
+    blockErrors_[0] = !valid || corrected;
+    statsBlocks_++;
+    if (!valid) {
+        statsBlockErrors_++;
+    }
+    
+    if (position == 3) {
+        if (blockValid_[0] && blockValid_[1] && blockValid_[2] && blockValid_[3]) {
+            processGroups();
+            statsGroups_++;
+        }
+        blockValid_.fill(false);
+    }
+    
+    // Too many uncorrectable blocks: fall back to the bit slip search
+    if (blockErrors_.count() > RDS_SYNC_LOSS_ERRORS) {
+        groupSync_ = false;
+        syncCandidateBit_ = 0;
+        blockValid_.fill(false);
+        setState(carrierLocked_ ? DecoderState::SYNCING : DecoderState::SEARCHING);
+        
+#ifdef HAS_SPDLOG
+        spdlog::info("RDS block sync lost");
+#endif
+    }
+}
+
+void RDSDecoder::emitStatistics() {
+    float seconds = (bitsReceived_ - statsStartBit_) / RDS_SYMBOL_RATE;
+    
+    QVariantMap data;
+    data["type"] = "RDS_STATS";
+    data["sync"] = groupSync_;
+    data["groupRate"] = statsGroups_ / seconds;
+    data["bler"] = statsBlocks_ > 0 ? 100.0 * statsBlockErrors_ / statsBlocks_ : 100.0;
+    data["blocks"] = statsBlocks_;
+    data["corrected"] = statsCorrected_;
+    emitData(data);
+    
+    statsStartBit_ = bitsReceived_;
+    statsBlocks_ = 0;
+    statsBlockErrors_ = 0;
+    statsCorrected_ = 0;
+    statsGroups_ = 0;
+}
+
+void RDSDecoder::designMatchedFilter() {
+    // Root-raised-cosine with rolloff 1 at the biphase rate. Together with the
+    // transmitter's identical shaping this gives the cos^2 response in EN 50067.
+    const float rolloff = 1.0f;
+    const int span = 3;  // half-symbols either side of the centre tap
+    const int half = static_cast<int>(std::lround(span * samplesPerSymbol_));
+    const size_t taps = 2 * half + 1;
+    
+    matchedFilter_.resize(taps);
+    float sum = 0.0f;
+    for (int n = -half; n <= half; n++) {
+        float t = n / samplesPerSymbol_;
+        float h;
+        if (n == 0) {
+            h = 1.0f - rolloff + 4.0f * rolloff / M_PI;
+        } else if (fabsf(fabsf(4.0f * rolloff * t) - 1.0f) < 1e-4f) {
+            h = rolloff / sqrtf(2.0f) *
+                ((1.0f + 2.0f / M_PI) * sinf(M_PI / (4.0f * rolloff)) +
+                 (1.0f - 2.0f / M_PI) * cosf(M_PI / (4.0f * rolloff)));
+        } else {
+            float x = 4.0f * rolloff * t;
+            h = (sinf(M_PI * t * (1.0f - rolloff)) +
+                 x * cosf(M_PI * t * (1.0f + rolloff))) /
+                (M_PI * t * (1.0f - x * x));
+        }
+        matchedFilter_[n + half] = h;
+        sum += h;
+    }
+    for (float& h : matchedFilter_) {
+        h /= sum;
+    }
+    
+    matchedDelay_.assign(2 * taps, std::complex<float>(0.0f, 0.0f));
+    matchedIndex_ = 0;
+}
+
+void RDSDecoder::loopCoefficients(float bandwidth, float damping, float& alpha, float& beta) {
+    // Second order loop filter from normalized noise bandwidth
+    float theta = bandwidth / (damping + 1.0f / (4.0f * damping));
+    float denom = 1.0f + 2.0f * damping * theta + theta * theta;
+    alpha = 4.0f * damping * theta / denom;
+    beta = 4.0f * theta * theta / denom;
 }
 
 void RDSDecoder::processGroups() {
@@ -288,28 +609,50 @@ void RDSDecoder::processGroups() {
         emit programTypeChanged(programType_);
     }
     
-    // Process based on group type
-    switch (groupType) {
-        case 0:  // Basic tuning and switching information
-            processGroupType0(blockB, blockC, blockD);
-            break;
-            
-        case 2:  // RadioText
-            processGroupType2(blockB, blockC, blockD);
-            break;
-            
-        case 4:  // Clock-time and date
-            if (!versionB) {
-                processGroupType4A(blockB, blockC, blockD);
-            }
-            break;
-            
-        // Add more group types as needed
+    // Groups assigned to RDS-TMC through an ODA registration go to the TMC decoder
+    uint8_t groupCode = (groupType << 1) | (versionB ? 1 : 0);
+    auto oda = odaApplications_.find(groupCode);
+    if (oda != odaApplications_.end() && groupCode != 6 &&
+        (oda->second == AID_TMC || oda->second == AID_TMC_ALT)) {
+        processGroupType8A(blockB, blockC, blockD);
+        return;
+    }
+    
+    GroupHandler handler = GROUP_HANDLERS[groupCode];
+    if (handler) {
+        (this->*handler)(blockB, blockC, blockD);
     }
 }
 
+std::array<RDSDecoder::GroupHandler, 32> RDSDecoder::buildGroupHandlers() {
+    std::array<GroupHandler, 32> handlers;
+    handlers.fill(nullptr);
+    
+    handlers[0] = &RDSDecoder::processGroupType0;     // 0A basic tuning + AF
+    handlers[1] = &RDSDecoder::processGroupType0;     // 0B basic tuning
+    handlers[2] = &RDSDecoder::processGroupType1;     // 1A PIN + slow labelling
+    handlers[3] = &RDSDecoder::processGroupType1;     // 1B PIN
+    handlers[4] = &RDSDecoder::processGroupType2;     // 2A RadioText
+    handlers[5] = &RDSDecoder::processGroupType2;     // 2B RadioText
+    handlers[6] = &RDSDecoder::processGroupType3A;    // 3A ODA registration
+    handlers[8] = &RDSDecoder::processGroupType4A;    // 4A clock time
+    handlers[16] = &RDSDecoder::processGroupType8A;   // 8A TMC
+    handlers[18] = &RDSDecoder::processGroupType9A;   // 9A emergency warning
+    handlers[20] = &RDSDecoder::processGroupType10A;  // 10A PTYN
+    handlers[28] = &RDSDecoder::processGroupType14;   // 14A EON
+    handlers[29] = &RDSDecoder::processGroupType14;   // 14B EON TA switching
+    handlers[31] = &RDSDecoder::processGroupType15B;  // 15B fast basic tuning
+    
+    return handlers;
+}
+
 void RDSDecoder::processGroupType0(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
-    Q_UNUSED(blockC);  // Alternative frequencies would be decoded from blockC
+    // Version A carries alternative frequencies in block C, version B repeats PI
+    bool versionB = (blockB >> 11) & 0x01;
+    if (!versionB) {
+        decodeAlternativeFrequencies((blockC >> 8) & 0xFF, blockC & 0xFF);
+    }
+    
     // Traffic announcement
     bool ta = (blockB >> 4) & 0x01;
     if (ta != trafficAnnouncement_) {
@@ -463,19 +806,446 @@ void RDSDecoder::processGroupType4A(uint16_t blockB, uint16_t blockC, uint16_t b
     emitData(data);
 }
 
-bool RDSDecoder::checkAndCorrectBlock(uint32_t& block) {
-    // Simple CRC check - in a real implementation, this would
-    // include full syndrome calculation and error correction
-    // For now, just return true to allow testing
-    Q_UNUSED(block);
-    return true;
+void RDSDecoder::processGroupType1(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
+    // Program item number: day (5 bits), hour (5 bits), minute (6 bits)
+    if (blockD != programItemNumber_) {
+        programItemNumber_ = blockD;
+        
+        QVariantMap data;
+        data["type"] = "RDS_PIN";
+        data["day"] = (blockD >> 11) & 0x1F;
+        data["hour"] = (blockD >> 6) & 0x1F;
+        data["minute"] = blockD & 0x3F;
+        emitData(data);
+    }
+    
+    // Slow labelling codes only exist in version A; variant 0 carries the ECC
+    bool versionB = (blockB >> 11) & 0x01;
+    if (versionB) {
+        return;
+    }
+    
+    uint8_t variant = (blockC >> 12) & 0x07;
+    if (variant == 0) {
+        uint8_t ecc = blockC & 0xFF;
+        if (ecc != extendedCountryCode_) {
+            extendedCountryCode_ = ecc;
+            
+            QVariantMap data;
+            data["type"] = "RDS_ECC";
+            data["ecc"] = ecc;
+            emitData(data);
+        }
+    } else if (variant == 3) {
+        QVariantMap data;
+        data["type"] = "RDS_LANGUAGE";
+        data["language"] = blockC & 0xFF;
+        emitData(data);
+    }
+}
+
+void RDSDecoder::processGroupType3A(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
+    // Open data application registration: which group type carries which AID
+    uint8_t groupCode = blockB & 0x1F;
+    uint16_t aid = blockD;
+    
+    auto it = odaApplications_.find(groupCode);
+    bool changed = (it == odaApplications_.end() || it->second != aid);
+    odaApplications_[groupCode] = aid;
+    
+    if (aid == AID_TMC || aid == AID_TMC_ALT) {
+        // Variant 0 of the TMC system message names the location table
+        if (((blockC >> 14) & 0x03) == 0) {
+            tmcLocationTable_ = (blockC >> 6) & 0x3F;
+        }
+    }
+    
+    if (changed) {
+        QVariantMap data;
+        data["type"] = "RDS_ODA";
+        data["group"] = QString("%1%2").arg(groupCode >> 1).arg((groupCode & 1) ? "B" : "A");
+        data["aid"] = aid;
+        data["message"] = blockC;
+        emitData(data);
+        
+#ifdef HAS_SPDLOG
+        spdlog::info("RDS ODA {:04X} on group {}{}", aid, groupCode >> 1,
+                     (groupCode & 1) ? 'B' : 'A');
+#endif
+    }
+}
+
+void RDSDecoder::processGroupType8A(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
+    bool tuningInfo = (blockB >> 4) & 0x01;
+    if (tuningInfo) {
+        return;  // Provider name and tuning information are not decoded
+    }
+    
+    bool singleGroup = (blockB >> 3) & 0x01;
+    uint8_t x = blockB & 0x07;
+    
+    if (singleGroup) {
+        TMCMessage message;
+        message.duration = x;
+        message.diversion = (blockC >> 15) & 0x01;
+        message.direction = (blockC >> 14) & 0x01;
+        message.extent = (blockC >> 11) & 0x07;
+        message.event = blockC & 0x7FF;
+        message.location = blockD;
+        emitTMCMessage(message);
+        tmcPendingValid_ = false;
+        return;
+    }
+    
+    // Multi-group message: x is the continuity index shared by all its groups
+    bool firstGroup = (blockC >> 15) & 0x01;
+    if (firstGroup) {
+        tmcPending_ = TMCMessage();
+        tmcPending_.multiGroup = true;
+        tmcPending_.continuityIndex = x;
+        tmcPending_.direction = (blockC >> 14) & 0x01;
+        tmcPending_.extent = (blockC >> 11) & 0x07;
+        tmcPending_.event = blockC & 0x7FF;
+        tmcPending_.location = blockD;
+        tmcPendingValid_ = true;
+        return;
+    }
+    
+    if (!tmcPendingValid_ || tmcPending_.continuityIndex != x) {
+        return;
+    }
+    
+    // Subsequent groups: 28 bits of optional content each, GSI counts down to 0
+    uint8_t groupsRemaining = (blockC >> 12) & 0x03;
+    tmcPending_.optionalContent.push_back((static_cast<uint32_t>(blockC & 0x0FFF) << 16) |
+                                          blockD);
+    if (groupsRemaining == 0 || tmcPending_.optionalContent.size() >= 4) {
+        emitTMCMessage(tmcPending_);
+        tmcPendingValid_ = false;
+    }
+}
+
+void RDSDecoder::processGroupType9A(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
+    // Emergency warning system: the payload format is allocated nationally
+    QVariantMap data;
+    data["type"] = "RDS_EWS";
+    data["b"] = blockB & 0x1F;
+    data["c"] = blockC;
+    data["d"] = blockD;
+    emitData(data);
+}
+
+void RDSDecoder::processGroupType10A(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
+    // Program type name: two segments of 4 characters
+    uint8_t abFlag = (blockB >> 4) & 0x01;
+    uint8_t segment = blockB & 0x01;
+    
+    if (abFlag != ptynABFlag_) {
+        ptynABFlag_ = abFlag;
+        ptynBuffer_.fill(' ');
+        ptynValid_.fill(false);
+    }
+    
+    ptynBuffer_[segment * 4] = (blockC >> 8) & 0xFF;
+    ptynBuffer_[segment * 4 + 1] = blockC & 0xFF;
+    ptynBuffer_[segment * 4 + 2] = (blockD >> 8) & 0xFF;
+    ptynBuffer_[segment * 4 + 3] = blockD & 0xFF;
+    for (int i = 0; i < 4; i++) {
+        ptynValid_[segment * 4 + i] = true;
+    }
+    
+    for (bool valid : ptynValid_) {
+        if (!valid) {
+            return;
+        }
+    }
+    
+    QString ptyn = QString::fromLatin1(ptynBuffer_.data(), 8).trimmed();
+    if (ptyn != programTypeName_) {
+        programTypeName_ = ptyn;
+        emit programTypeNameChanged(programTypeName_);
+        
+        QVariantMap data;
+        data["type"] = "RDS_PTYN";
+        data["ptyn"] = programTypeName_;
+        emitData(data);
+    }
+}
+
+void RDSDecoder::processGroupType14(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
+    // Block D always carries PI of the other network
+    OtherNetwork& on = otherNetworks_[blockD];
+    on.pi = blockD;
+    on.tp = (blockB >> 4) & 0x01;
+    
+    bool versionB = (blockB >> 11) & 0x01;
+    if (versionB) {
+        // 14B only signals a TA switch on the other network
+        on.ta = (blockB >> 3) & 0x01;
+        emitOtherNetwork(on);
+        return;
+    }
+    
+    uint8_t variant = blockB & 0x0F;
+    switch (variant) {
+        case 0: case 1: case 2: case 3: {
+            on.psBuffer[variant * 2] = (blockC >> 8) & 0xFF;
+            on.psBuffer[variant * 2 + 1] = blockC & 0xFF;
+            QString ps = QString::fromLatin1(on.psBuffer.data(), 8).trimmed();
+            if (ps == on.ps) {
+                return;
+            }
+            on.ps = ps;
+            break;
+        }
+        case 4:  // AF(ON), method A: two frequencies
+        case 5: case 6: case 7: case 8: {  // mapped FM pair: tuned, other network
+            bool changed = false;
+            uint8_t codes[2] = {static_cast<uint8_t>(blockC >> 8),
+                                static_cast<uint8_t>(blockC & 0xFF)};
+            for (size_t i = (variant == 4) ? 0 : 1; i < 2; i++) {
+                float freq = afCodeToFrequency(codes[i]);
+                if (freq > 0.0f && !on.frequencies.contains(freq)) {
+                    on.frequencies.append(freq);
+                    changed = true;
+                }
+            }
+            if (!changed) {
+                return;
+            }
+            break;
+        }
+        case 13:
+            if (on.pty == ((blockC >> 11) & 0x1F) && on.ta == (blockC & 0x01)) {
+                return;
+            }
+            on.pty = (blockC >> 11) & 0x1F;
+            on.ta = blockC & 0x01;
+            break;
+        case 14:
+            if (on.pin == blockC) {
+                return;
+            }
+            on.pin = blockC;
+            break;
+        default:
+            return;  // Linkage and LF/MF mappings are not decoded
+    }
+    
+    emitOtherNetwork(on);
+}
+
+void RDSDecoder::processGroupType15B(uint16_t blockB, uint16_t blockC, uint16_t blockD) {
+    Q_UNUSED(blockC);
+    Q_UNUSED(blockD);
+    
+    // Fast basic tuning: the TA and M/S bits sit where they do in group 0
+    bool ta = (blockB >> 4) & 0x01;
+    if (ta != trafficAnnouncement_) {
+        trafficAnnouncement_ = ta;
+        emit trafficAnnouncementChanged(ta);
+    }
+    musicSpeech_ = (blockB >> 3) & 0x01;
+}
+
+void RDSDecoder::decodeAlternativeFrequencies(uint8_t first, uint8_t second) {
+    // Codes 224..249 start a list of (code - 224) frequencies
+    if (first >= 224 && first <= 249) {
+        afListLength_ = first - 224;
+        afCodes_.clear();
+        if (afCodeToFrequency(second) > 0.0f) {
+            afCodes_.push_back(second);
+        }
+    } else if (afListLength_ == 0) {
+        return;
+    } else if (first == 250) {
+        return;  // LF/MF frequency follows, not relevant for FM
+    } else {
+        for (uint8_t code : {first, second}) {
+            if (afCodeToFrequency(code) > 0.0f) {
+                afCodes_.push_back(code);
+            }
+        }
+    }
+    
+    if (afCodes_.size() < afListLength_) {
+        return;
+    }
+    
+    // Method B lists open with the tuned frequency and pair it with each AF.
+    // Method A lists are a plain enumeration without repeats.
+    uint8_t tuned = afCodes_.front();
+    bool methodB = (afListLength_ & 1) &&
+                   std::count(afCodes_.begin() + 1, afCodes_.end(), tuned) > 0;
+    
+    QList<float> frequencies;
+    for (uint8_t code : afCodes_) {
+        if (methodB && code == tuned) {
+            continue;
+        }
+        float freq = afCodeToFrequency(code);
+        if (!frequencies.contains(freq)) {
+            frequencies.append(freq);
+        }
+    }
+    afListLength_ = 0;
+    afCodes_.clear();
+    
+    if (frequencies != alternativeFreqs_) {
+        alternativeFreqs_ = frequencies;
+        emit alternativeFrequenciesReceived(alternativeFreqs_);
+        
+        QVariantList list;
+        for (float freq : alternativeFreqs_) {
+            list.append(freq);
+        }
+        
+        QVariantMap data;
+        data["type"] = "RDS_AF";
+        data["method"] = methodB ? "B" : "A";
+        data["tuned"] = methodB ? afCodeToFrequency(tuned) : 0.0f;
+        data["frequencies"] = list;
+        emitData(data);
+    }
+}
+
+void RDSDecoder::emitTMCMessage(const TMCMessage& message) {
+    // Messages are repeated several times; report each one once. Multi-group
+    // repeats are told apart by an FNV-1a fold of their optional content.
+    uint64_t key = (static_cast<uint64_t>(message.event) << 32) |
+                   (static_cast<uint64_t>(message.location) << 16) |
+                   (message.extent << 8) | (message.direction << 4) | message.duration |
+                   (static_cast<uint64_t>(message.multiGroup) << 48);
+    for (uint32_t field : message.optionalContent) {
+        key = (key ^ field) * 0x100000001B3ULL;
+    }
+    if (key == lastTmcKey_) {
+        return;
+    }
+    lastTmcKey_ = key;
+    
+    emit tmcMessageReceived(message);
+    
+    QVariantList optional;
+    for (uint32_t field : message.optionalContent) {
+        optional.append(field);
+    }
+    
+    QVariantMap data;
+    data["type"] = "RDS_TMC";
+    data["event"] = message.event;
+    data["location"] = message.location;
+    data["locationTable"] = tmcLocationTable_;
+    data["extent"] = message.extent;
+    data["direction"] = message.direction ? "-" : "+";
+    data["duration"] = message.duration;
+    data["diversion"] = message.diversion;
+    data["multiGroup"] = message.multiGroup;
+    data["optional"] = optional;
+    emitData(data);
+}
+
+void RDSDecoder::emitOtherNetwork(const OtherNetwork& network) {
+    emit otherNetworkUpdated(network.pi, network);
+    
+    QVariantList frequencies;
+    for (float freq : network.frequencies) {
+        frequencies.append(freq);
+    }
+    
+    QVariantMap data;
+    data["type"] = "RDS_EON";
+    data["pi"] = network.pi;
+    data["ps"] = network.ps;
+    data["pty"] = network.pty;
+    data["tp"] = network.tp;
+    data["ta"] = network.ta;
+    data["pin"] = network.pin;
+    data["frequencies"] = frequencies;
+    emitData(data);
+}
+
+float RDSDecoder::afCodeToFrequency(uint8_t code) {
+    // Codes 1..204 are 87.6..107.9 MHz in 100 kHz steps
+    if (code >= 1 && code <= 204) {
+        return 87.5f + code * 0.1f;
+    }
+    return 0.0f;
+}
+
+bool RDSDecoder::checkAndCorrectBlock(uint32_t& block, size_t position, bool& corrected) {
+    // Block C of a version B group carries offset C' instead
+    const size_t offsets[2] = {position, position == 2 ? size_t(4) : position};
+    uint16_t syndrome = calculateSyndrome(block);
+    corrected = false;
+    
+    for (size_t offset : offsets) {
+        if (syndrome == OFFSET_WORDS[offset]) {
+            return true;
+        }
+    }
+    
+    // Over a third of all syndromes match some burst of up to 5 bits, so on
+    // a noisy signal most of those "corrections" would be garbage. Longer
+    // bursts are only trusted while nearly every recent block was clean.
+    const size_t maxBurst = blockErrors_.count() <= RDS_LONG_BURST_ERRORS ? 5 : RDS_SHORT_BURST;
+    for (size_t offset : offsets) {
+        uint32_t error = SYNDROME_TABLE[syndrome ^ OFFSET_WORDS[offset]];
+        if (error != 0 && burstLength(error) <= maxBurst) {
+            block ^= error;
+            statsCorrected_++;
+            corrected = true;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+size_t RDSDecoder::burstLength(uint32_t error) {
+    size_t low = 0;
+    while (!(error & (1u << low))) {
+        low++;
+    }
+    size_t high = 31;
+    while (!(error & (1u << high))) {
+        high--;
+    }
+    return high - low + 1;
 }
 
 uint16_t RDSDecoder::calculateSyndrome(uint32_t block) {
-    // Simplified syndrome calculation
-    // Real implementation would use the RDS generator polynomial
-    Q_UNUSED(block);
-    return 0;
+    // Remainder of the 26 bit block divided by g(x) = x^10+x^8+x^7+x^5+x^4+x^3+1.
+    // A clean block leaves exactly its offset word.
+    const uint32_t generator = 0x5B9;
+    for (int bit = 25; bit >= 10; bit--) {
+        if (block & (1u << bit)) {
+            block ^= generator << (bit - 10);
+        }
+    }
+    return block & 0x3FF;
+}
+
+std::array<uint32_t, 1024> RDSDecoder::buildSyndromeTable() {
+    // The shortened cyclic (26,16) code corrects any burst of up to 5 bits. Every
+    // such burst has a distinct syndrome, so a single lookup finds the pattern.
+    std::array<uint32_t, 1024> table;
+    table.fill(0);
+    
+    for (int length = 1; length <= 5; length++) {
+        uint32_t first = 1u << (length - 1);
+        for (uint32_t pattern = first; pattern < 2 * first; pattern++) {
+            if ((pattern & 1) == 0 && length > 1) {
+                continue;  // shorter bursts are covered at another position
+            }
+            for (int shift = 0; shift + length <= RDS_BITS_PER_BLOCK; shift++) {
+                uint32_t error = pattern << shift;
+                table[calculateSyndrome(error)] = error;
+            }
+        }
+    }
+    
+    return table;
 }
 
 QString RDSDecoder::getProgramTypeName(uint8_t pty) {
@@ -2,9 +2,12 @@
 #define RDSDECODER_H
 
 #include "DigitalDecoder.h"
-#include <deque>
 #include <array>
+#include <bitset>
+#include <complex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class RDSDecoder : public DigitalDecoder {
     Q_OBJECT
@@ -18,9 +21,22 @@ public:
     void stop() override;
     void reset() override;
     
-    // Process FM demodulated audio (containing RDS at 57kHz)
+    // Process FM composite (MPX) baseband containing RDS at 57kHz
     void processAudio(const float* samples, size_t length) override;
     
+    // Restarts the demodulator chain if the input rate changes while active
+    void setSampleRate(uint32_t sampleRate) override;
+    
+    // Demodulator status
+    bool isCarrierLocked() const { return carrierLocked_; }
+    
+    // Offline replay, bypassing the demodulator. Bits (one per byte, low bit)
+    // go through block sync and error correction; groups (4 blocks each) go
+    // straight to the group decoder. tests/rds_replay runs both over the
+    // corpus in tests/data.
+    void replayBits(const uint8_t* bits, size_t count);
+    void replayGroups(const uint16_t* blocks, size_t groupCount);
+    
     // RDS data types
     enum class RDSDataType {
         PI,         // Program Identification
@@ -46,6 +62,40 @@ public:
     bool hasTrafficAnnouncement() const { return trafficAnnouncement_; }
     bool isMusic() const { return musicSpeech_; }
     
+    QString getProgramTypeNameLabel() const { return programTypeName_; }  // PTYN
+    uint16_t getProgramItemNumber() const { return programItemNumber_; }
+    uint8_t getExtendedCountryCode() const { return extendedCountryCode_; }
+    
+    // RDS-TMC user message (group 8A or its ODA assigned group)
+    struct TMCMessage {
+        uint16_t event;         // Event code (ISO 14819-2)
+        uint16_t location;      // Location code within the location table
+        uint8_t extent;         // Number of locations affected
+        uint8_t duration;       // Duration and persistence (single group only)
+        bool direction;         // Negative (true) or positive direction
+        bool diversion;         // Diversion advised
+        bool multiGroup;
+        uint8_t continuityIndex;
+        std::vector<uint32_t> optionalContent;  // 28 bit free format fields
+        
+        TMCMessage() : event(0), location(0), extent(0), duration(0), direction(false),
+                       diversion(false), multiGroup(false), continuityIndex(0) {}
+    };
+    
+    // Enhanced Other Networks information (groups 14A/14B)
+    struct OtherNetwork {
+        uint16_t pi;
+        QString ps;
+        uint8_t pty;
+        bool tp;
+        bool ta;
+        uint16_t pin;
+        QList<float> frequencies;  // MHz
+        std::array<char, 8> psBuffer;
+        
+        OtherNetwork() : pi(0), pty(0), tp(false), ta(false), pin(0) { psBuffer.fill(' '); }
+    };
+    
     // Program type names
     static QString getProgramTypeName(uint8_t pty);
     
@@ -57,74 +107,135 @@ signals:
     void trafficAnnouncementChanged(bool ta);
     void clockTimeReceived(const QDateTime& ct);
     void alternativeFrequenciesReceived(const QList<float>& frequencies);
+    void programTypeNameChanged(const QString& ptyn);
+    void tmcMessageReceived(const TMCMessage& message);
+    void otherNetworkUpdated(uint16_t pi, const OtherNetwork& network);
     
 private:
     // RDS constants
     static constexpr float RDS_CARRIER_FREQ = 57000.0f;  // 57 kHz
     static constexpr float RDS_SYMBOL_RATE = 1187.5f;    // symbols/sec
     static constexpr int RDS_BITS_PER_GROUP = 104;       // 4 blocks of 26 bits
+    static constexpr float RDS_BIPHASE_RATE = 2375.0f;   // biphase half-symbols/sec
+    static constexpr float RDS_DECIMATED_RATE = 19000.0f; // target baseband rate
+    static constexpr size_t RDS_BASEBAND_BLOCK = 256;    // decimated samples per pass
+    static constexpr int RDS_BITS_PER_BLOCK = 26;        // 16 information + 10 check bits
+    static constexpr int RDS_SYNC_SPAN = 6;              // max blocks between sync candidates
+    static constexpr size_t RDS_SYNC_LOSS_ERRORS = 25;   // bad blocks in 50 that drop sync
+    static constexpr size_t RDS_SHORT_BURST = 2;         // burst bits always corrected
+    static constexpr size_t RDS_LONG_BURST_ERRORS = 2;   // bad blocks in 50 that stop 3-5 bit fixes
+    static constexpr uint32_t RDS_STATS_BITS = 1188;     // ~1 s of bits per statistics report
     
     // Demodulation stages
-    void extract57kHz(const float* samples, size_t length);
-    void demodulateRDS();
-    void decodeSymbols();
+    void extract57kHz(const float* samples, size_t length);  // mix + decimate
+    void demodulateRDS();   // matched filter, Costas loop, Gardner timing
+    void decodeSymbols();   // biphase + differential decoding
+    void processBit(int bit);
+    void acquireBlockSync();
+    void processBlock(uint32_t block);
     void processGroups();
+    void emitStatistics();
+    
+    // Filter design helpers
+    void designMatchedFilter();
+    static void loopCoefficients(float bandwidth, float damping, float& alpha, float& beta);
+    
+    // Group processing, dispatched on (group type << 1) | version B
+    using GroupHandler = void (RDSDecoder::*)(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    static std::array<GroupHandler, 32> buildGroupHandlers();
     
-    // Group processing
     void processGroupType0(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processGroupType1(uint16_t blockB, uint16_t blockC, uint16_t blockD);
     void processGroupType2(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processGroupType3A(uint16_t blockB, uint16_t blockC, uint16_t blockD);
     void processGroupType4A(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processGroupType8A(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processGroupType9A(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processGroupType10A(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processGroupType14(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processGroupType15B(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    
+    void decodeAlternativeFrequencies(uint8_t first, uint8_t second);
+    void emitTMCMessage(const TMCMessage& message);
+    void emitOtherNetwork(const OtherNetwork& network);
+    static float afCodeToFrequency(uint8_t code);
     
     // Error correction
-    bool checkAndCorrectBlock(uint32_t& block);
-    uint16_t calculateSyndrome(uint32_t block);
-    
-    // Filters and buffers
-    struct BandpassFilter {
-        float b0, b1, b2;
-        float a1, a2;
-        float x1, x2;
-        float y1, y2;
-        
-        float process(float input) {
-            float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
-            x2 = x1;
-            x1 = input;
-            y2 = y1;
-            y1 = output;
-            return output;
-        }
-    };
+    bool checkAndCorrectBlock(uint32_t& block, size_t position, bool& corrected);
+    static size_t burstLength(uint32_t error);     // error must be non-zero
+    static uint16_t calculateSyndrome(uint32_t block);
+    static std::array<uint32_t, 1024> buildSyndromeTable();
     
-    BandpassFilter rdsFilter_;      // 57kHz bandpass
-    BandpassFilter pilotFilter_;    // 19kHz pilot tone filter
+    // Subcarrier mixer (input rate)
+    std::complex<float> mixerPhasor_;
+    std::complex<float> mixerStep_;
     
-    // Carrier recovery
+    // Triangular (2nd order CIC) decimator, input rate -> ~19 kHz
+    size_t decimation_;
+    size_t decimationCount_;
+    float decimatedRate_;
+    std::vector<float> decimationRamp_;
+    std::complex<float> decimationCurrent_;
+    std::complex<float> decimationNext_;
+    std::complex<float> decimationCarry_;
+    
+    // Root-raised-cosine matched filter (decimated rate)
+    std::vector<float> matchedFilter_;
+    std::vector<std::complex<float>> matchedDelay_;  // doubled for contiguous reads
+    size_t matchedIndex_;
+    
+    // Carrier recovery (Costas loop)
     float carrierPhase_;
     float carrierFreq_;
-    float pilotPhase_;
+    float costasAlpha_;
+    float costasBeta_;
+    float carrierLockLevel_;
     bool carrierLocked_;
     
-    // Symbol timing recovery
+    // Symbol timing recovery (Gardner, on biphase half-symbols)
     float symbolPhase_;
-    float symbolRate_;
-    size_t samplesPerSymbol_;
+    float samplesPerSymbol_;
+    float timingGain_;
+    float symbolAmplitude_;
+    float lastSample_;
+    float lastStrobe_;
+    float midStrobe_;
+    bool midStrobeNext_;
     
-    // Demodulation buffers
+    // Decimated baseband buffers
     std::vector<float> i_buffer_;
     std::vector<float> q_buffer_;
     size_t bufferIndex_;
     
     // Symbol decoder
-    std::deque<int> symbolBuffer_;
+    std::vector<float> symbolBuffer_;   // recovered half-symbols
+    float previousHalfSymbol_;
+    std::array<float, 2> biphaseEnergy_;
+    size_t halfSymbolCount_;
+    size_t biphaseParity_;
+    int lastCodedBit_;
     uint32_t bitBuffer_;
     size_t bitCount_;
     
+    // Block synchroniser
+    uint64_t bitsReceived_;
+    uint64_t syncCandidateBit_;      // bit count at the last offset match while searching
+    size_t syncCandidatePosition_;
+    std::bitset<50> blockErrors_;   // corrected or uncorrectable blocks among the last 50
+    
     // Group decoder
     std::array<uint16_t, 4> currentGroup_;
-    size_t blockCount_;
+    std::array<bool, 4> blockValid_;
+    size_t blockCount_;             // position of the next block within the group
     bool groupSync_;
     
+    // Reception statistics for the current reporting interval
+    uint64_t statsStartBit_;
+    uint32_t statsBlocks_;
+    uint32_t statsBlockErrors_;
+    uint32_t statsCorrected_;
+    uint32_t statsGroups_;
+    
     // Decoded data storage
     uint16_t programID_;
     QString programService_;
@@ -147,12 +258,39 @@ private:
     uint8_t minutes_;
     int8_t localTimeOffset_;
     
-    // Alternative frequencies
+    // Alternative frequencies (method A or B lists from group 0A)
     QList<float> alternativeFreqs_;
+    std::vector<uint8_t> afCodes_;
+    size_t afListLength_;
+    
+    // Program item number, slow labelling codes and PTYN (groups 1A, 10A)
+    uint16_t programItemNumber_;
+    uint8_t extendedCountryCode_;
+    QString programTypeName_;
+    std::array<char, 8> ptynBuffer_;
+    std::array<bool, 8> ptynValid_;
+    uint8_t ptynABFlag_;
+    
+    // Open data applications: application group code -> AID (group 3A)
+    std::unordered_map<uint8_t, uint16_t> odaApplications_;
     
-    // Syndrome lookup table for error correction
+    // RDS-TMC
+    TMCMessage tmcPending_;         // multi-group message being assembled
+    bool tmcPendingValid_;
+    uint64_t lastTmcKey_;           // messages are repeated; only report changes
+    uint8_t tmcLocationTable_;
+    
+    // Enhanced Other Networks, keyed by PI(ON)
+    std::unordered_map<uint16_t, OtherNetwork> otherNetworks_;
+    
+    // Offset words (A, B, C, D, C') and burst error patterns indexed by syndrome
     static const uint16_t OFFSET_WORDS[5];
-    static const uint16_t SYNDROME_TABLE[1024];
+    static const std::array<uint32_t, 1024> SYNDROME_TABLE;
+    static const std::array<GroupHandler, 32> GROUP_HANDLERS;
+    
+    // ODA application IDs for RDS-TMC (ALERT-C)
+    static constexpr uint16_t AID_TMC = 0xCD46;
+    static constexpr uint16_t AID_TMC_ALT = 0xCD47;
 };
 
 #endif // RDSDECODER_H
@@ -0,0 +1,119 @@
+#include "BiquadCascade.h"
+#include <algorithm>
+#include <cmath>
+
+BiquadCascade::BiquadCascade(size_t sections, size_t channels)
+    : channels_(std::max<size_t>(1, std::min(channels, MAX_CHANNELS)))
+    , current_(sections, identity())
+    , target_(sections, identity())
+    , s1_(sections * channels_, 0.0f)
+    , s2_(sections * channels_, 0.0f) {
+}
+
+void BiquadCascade::process(float* data, size_t frames) {
+    if (frames == 0) {
+        return;
+    }
+    
+    for (size_t section = 0; section < current_.size(); section++) {
+        if (isBypassed(section)) {
+            continue;
+        }
+        
+        // Fixed channel counts give the compiler a constant trip count to vectorise
+        switch (channels_) {
+            case 1: processSection<1>(section, data, frames); break;
+            case 2: processSection<2>(section, data, frames); break;
+            case 4: processSection<4>(section, data, frames); break;
+            case 8: processSection<8>(section, data, frames); break;
+            default: processSection<0>(section, data, frames); break;
+        }
+    }
+}
+
+template <size_t CH>
+void BiquadCascade::processSection(size_t section, float* data, size_t frames) {
+    const size_t channels = CH ? CH : channels_;
+    
+    // State in locals so the stores to data cannot alias it
+    float z1[MAX_CHANNELS];
+    float z2[MAX_CHANNELS];
+    float* state1 = s1_.data() + section * channels;
+    float* state2 = s2_.data() + section * channels;
+    std::copy(state1, state1 + channels, z1);
+    std::copy(state2, state2 + channels, z2);
+    
+    // Per-sample coefficient step towards the target; zero when settled
+    Coefficients c = current_[section];
+    const Coefficients& t = target_[section];
+    const float step = 1.0f / frames;
+    const float db0 = (t.b0 - c.b0) * step;
+    const float db1 = (t.b1 - c.b1) * step;
+    const float db2 = (t.b2 - c.b2) * step;
+    const float da1 = (t.a1 - c.a1) * step;
+    const float da2 = (t.a2 - c.a2) * step;
+    
+    for (size_t n = 0; n < frames; n++) {
+        c.b0 += db0;
+        c.b1 += db1;
+        c.b2 += db2;
+        c.a1 += da1;
+        c.a2 += da2;
+        
+        float* frame = data + n * channels;
+        for (size_t ch = 0; ch < channels; ch++) {
+            float in = frame[ch];
+            float out = c.b0 * in + z1[ch];
+            z1[ch] = c.b1 * in - c.a1 * out + z2[ch];
+            z2[ch] = c.b2 * in - c.a2 * out;
+            frame[ch] = out;
+        }
+    }
+    
+    // Land exactly on the target rather than on the accumulated ramp
+    current_[section] = t;
+    
+    for (size_t ch = 0; ch < channels; ch++) {
+        state1[ch] = (std::fabs(z1[ch]) < DENORMAL_THRESHOLD) ? 0.0f : z1[ch];
+        state2[ch] = (std::fabs(z2[ch]) < DENORMAL_THRESHOLD) ? 0.0f : z2[ch];
+    }
+}
+
+bool BiquadCascade::isBypassed(size_t section) const {
+    // A flat section is skipped only once its tail has died out, so switching a
+    // band off does not cut a ringing filter short
+    const Coefficients& c = current_[section];
+    const Coefficients& t = target_[section];
+    bool flat = c.b0 == 1.0f && c.b1 == 0.0f && c.b2 == 0.0f && c.a1 == 0.0f && c.a2 == 0.0f;
+    bool settled = c.b0 == t.b0 && c.b1 == t.b1 && c.b2 == t.b2 && c.a1 == t.a1 && c.a2 == t.a2;
+    if (!flat || !settled) {
+        return false;
+    }
+    
+    const float* state1 = s1_.data() + section * channels_;
+    const float* state2 = s2_.data() + section * channels_;
+    for (size_t ch = 0; ch < channels_; ch++) {
+        if (state1[ch] != 0.0f || state2[ch] != 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BiquadCascade::setTarget(size_t section, const Coefficients& coeffs) {
+    if (section < target_.size()) {
+        target_[section] = coeffs;
+    }
+}
+
+void BiquadCascade::setImmediate(size_t section, const Coefficients& coeffs) {
+    if (section < target_.size()) {
+        target_[section] = coeffs;
+        current_[section] = coeffs;
+    }
+}
+
+void BiquadCascade::reset() {
+    std::fill(s1_.begin(), s1_.end(), 0.0f);
+    std::fill(s2_.begin(), s2_.end(), 0.0f);
+}
@@ -0,0 +1,56 @@
+#ifndef BIQUADCASCADE_H
+#define BIQUADCASCADE_H
+
+#include <cstddef>
+#include <vector>
+
+// Cascade of biquad sections in transposed direct form II over interleaved
+// multi-channel audio. A block runs section by section; within a sample every
+// channel uses the same coefficients, so the channel loop is what vectorises.
+// New coefficients glide linearly across the next block to avoid zipper noise.
+class BiquadCascade {
+public:
+    // Normalised so a0 == 1
+    struct Coefficients {
+        float b0, b1, b2;
+        float a1, a2;
+    };
+    
+    // channels is clamped to 1..MAX_CHANNELS
+    BiquadCascade(size_t sections, size_t channels);
+    
+    // In place, frames of channels() interleaved samples
+    void process(float* data, size_t frames);
+    
+    // Reached by the end of the next processed block
+    void setTarget(size_t section, const Coefficients& coeffs);
+    // Jump without a glide, e.g. after reset
+    void setImmediate(size_t section, const Coefficients& coeffs);
+    void reset();
+    
+    size_t sections() const { return current_.size(); }
+    size_t channels() const { return channels_; }
+    
+    static Coefficients identity() { return {1.0f, 0.0f, 0.0f, 0.0f, 0.0f}; }
+    
+    static constexpr size_t MAX_CHANNELS = 8;
+    
+private:
+    template <size_t CH>
+    void processSection(size_t section, float* data, size_t frames);
+    bool isBypassed(size_t section) const;
+    
+    size_t channels_;
+    std::vector<Coefficients> current_;
+    std::vector<Coefficients> target_;
+    
+    // Structure of arrays: section s, channel c at [s * channels_ + c]
+    std::vector<float> s1_;
+    std::vector<float> s2_;
+    
+    // State below this is zeroed after each block, so decaying tails never reach
+    // the denormal range and no FPU mode has to be changed
+    static constexpr float DENORMAL_THRESHOLD = 1e-15f;
+};
+
+#endif // BIQUADCASCADE_H
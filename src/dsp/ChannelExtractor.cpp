@@ -0,0 +1,89 @@
+#include "ChannelExtractor.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+ChannelExtractor::ChannelExtractor(uint32_t sampleRate, double offset, double bandwidth, Demod demod)
+    : demod_(demod)
+    , mixerPhasor_(1.0f, 0.0f)
+    , agc_(0.01f, 0.1f) {
+    
+    // Split the receiver's decimation: the smallest audio stage that still
+    // leaves the channel rate wide enough, the rest ahead of the demodulator
+    const uint32_t total = std::max<uint32_t>(1, sampleRate / AUDIO_RATE);
+    uint32_t audioFactor = total;
+    for (uint32_t f = 1; f < total; f++) {
+        if (total % f == 0 && sampleRate / (total / f) >= bandwidth * CHANNEL_MARGIN) {
+            audioFactor = f;
+            break;
+        }
+    }
+    const uint32_t channelFactor = total / audioFactor;
+    channelRate_ = sampleRate / channelFactor;
+    audioRate_ = sampleRate / total;
+    
+    // Mixer moves the channel down to DC
+    float step = static_cast<float>(-2.0 * M_PI * offset / sampleRate);
+    mixerStep_ = std::complex<float>(cosf(step), sinf(step));
+    
+    const float passband = static_cast<float>(bandwidth / 2.0);
+    iDecimator_ = std::make_unique<Decimator>(sampleRate, channelFactor, passband);
+    qDecimator_ = std::make_unique<Decimator>(sampleRate, channelFactor, passband);
+    audioDecimator_ = std::make_unique<Decimator>(channelRate_, audioFactor, AUDIO_PASSBAND);
+    
+    switch (demod_) {
+        case Demod::AM:
+            amDemod_ = std::make_unique<AMDemodulator>(channelRate_);
+            break;
+        case Demod::FM:
+            fmDemod_ = std::make_unique<FMDemodulator>(channelRate_, static_cast<uint32_t>(bandwidth));
+            break;
+        case Demod::USB:
+        case Demod::LSB:
+        case Demod::CW:
+            ssbDemod_ = std::make_unique<SSBDemodulator>(channelRate_,
+                demod_ == Demod::USB ? SSBDemodulator::USB :
+                demod_ == Demod::LSB ? SSBDemodulator::LSB : SSBDemodulator::CW);
+            break;
+    }
+}
+
+size_t ChannelExtractor::process(const std::complex<float>* input, size_t length, float* output) {
+    if (iBuffer_.size() < length) {
+        iBuffer_.resize(length);
+        qBuffer_.resize(length);
+        channel_.resize(length);
+        audio_.resize(length);
+    }
+    
+    for (size_t i = 0; i < length; i++) {
+        std::complex<float> shifted = input[i] * mixerPhasor_;
+        mixerPhasor_ *= mixerStep_;
+        iBuffer_[i] = shifted.real();
+        qBuffer_[i] = shifted.imag();
+    }
+    // Keep the recursive phasor on the unit circle
+    mixerPhasor_ /= std::abs(mixerPhasor_);
+    
+    // Both filters carry the same state, so they always return the same count
+    size_t count = iDecimator_->process(iBuffer_.data(), length, iBuffer_.data());
+    qDecimator_->process(qBuffer_.data(), length, qBuffer_.data());
+    for (size_t i = 0; i < count; i++) {
+        channel_[i] = std::complex<float>(iBuffer_[i], qBuffer_[i]);
+    }
+    
+    if (amDemod_) {
+        amDemod_->demodulate(channel_.data(), audio_.data(), count);
+    } else if (fmDemod_) {
+        fmDemod_->demodulate(channel_.data(), audio_.data(), count);
+    } else if (ssbDemod_) {
+        ssbDemod_->demodulate(channel_.data(), audio_.data(), count);
+    }
+    
+    size_t samples = audioDecimator_->process(audio_.data(), count, output);
+    agc_.process(output, output, samples);
+    return samples;
+}
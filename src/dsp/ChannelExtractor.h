@@ -0,0 +1,68 @@
+#ifndef CHANNELEXTRACTOR_H
+#define CHANNELEXTRACTOR_H
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "AGC.h"
+#include "AMDemodulator.h"
+#include "Decimator.h"
+#include "FMDemodulator.h"
+#include "SSBDemodulator.h"
+
+// Demodulates one narrow channel out of a wideband capture: mixes it down to
+// DC, decimates I and Q to a channel rate just wide enough for it, demodulates
+// there and takes the audio the rest of the way down to about 48 kHz. The
+// overall decimation is the receiver's (sample rate / 48000), so the audio
+// rate matches the live receiver's.
+class ChannelExtractor {
+public:
+    enum class Demod {
+        AM,
+        FM,
+        USB,
+        LSB,
+        CW
+    };
+    
+    // offset: channel centre relative to the capture centre, in Hz
+    ChannelExtractor(uint32_t sampleRate, double offset, double bandwidth, Demod demod);
+    
+    // Consumes capture-rate IQ; returns the number of audio samples written,
+    // about length / (sampleRate / 48000) of them
+    size_t process(const std::complex<float>* input, size_t length, float* output);
+    
+    uint32_t getChannelRate() const { return channelRate_; }
+    uint32_t getAudioRate() const { return audioRate_; }
+    
+private:
+    static constexpr uint32_t AUDIO_RATE = 48000;
+    static constexpr double CHANNEL_MARGIN = 1.2;     // channel rate over channel width
+    static constexpr float AUDIO_PASSBAND = 16000.0f;
+    
+    Demod demod_;
+    uint32_t channelRate_;
+    uint32_t audioRate_;
+    
+    std::complex<float> mixerPhasor_;
+    std::complex<float> mixerStep_;
+    
+    // I and Q are decimated separately by the same real filter
+    std::unique_ptr<Decimator> iDecimator_;
+    std::unique_ptr<Decimator> qDecimator_;
+    std::unique_ptr<Decimator> audioDecimator_;
+    
+    std::unique_ptr<AMDemodulator> amDemod_;
+    std::unique_ptr<FMDemodulator> fmDemod_;
+    std::unique_ptr<SSBDemodulator> ssbDemod_;
+    AGC agc_;
+    
+    std::vector<float> iBuffer_;
+    std::vector<float> qBuffer_;
+    std::vector<std::complex<float>> channel_;
+    std::vector<float> audio_;
+};
+
+#endif // CHANNELEXTRACTOR_H
@@ -0,0 +1,125 @@
+#include "Decimator.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+Decimator::Decimator(uint32_t inputRate, uint32_t factor, float passband)
+    : factor_(std::max<uint32_t>(1, factor)) {
+    
+    // Largest factors first, so the long filters run at the lowest rates
+    std::vector<uint32_t> factors;
+    uint32_t remaining = factor_;
+    for (uint32_t p = 2; p * p <= remaining; p++) {
+        while (remaining % p == 0) {
+            factors.push_back(p);
+            remaining /= p;
+        }
+    }
+    if (remaining > 1) {
+        factors.push_back(remaining);
+    }
+    std::sort(factors.rbegin(), factors.rend());
+    
+    const double outputRate = static_cast<double>(inputRate) / factor_;
+    const double edge = std::min(static_cast<double>(passband), 0.4 * outputRate);
+    
+    double rate = inputRate;
+    for (uint32_t f : factors) {
+        double stageOutput = rate / f;
+        
+        // Transition from the passband edge to where its alias would land;
+        // Blackman needs about 5.5 / width taps for 74 dB
+        double width = (stageOutput - 2.0 * edge) / rate;
+        size_t taps = static_cast<size_t>(std::ceil(5.5 / width)) | 1;
+        
+        Stage stage;
+        stage.factor = f;
+        stage.taps = designLowpass(taps, 0.5 / f);
+        stage.buffer.assign(taps - 1, 0.0f);
+        stage.next = 0;
+        stages_.push_back(std::move(stage));
+        rate = stageOutput;
+    }
+}
+
+size_t Decimator::process(const float* input, size_t length, float* output) {
+    if (stages_.empty()) {
+        std::copy(input, input + length, output);
+        return length;
+    }
+    
+    // The first stage reads the caller's buffer, later ones work in place in
+    // scratch, and the last writes straight to output
+    if (scratch_.size() < length) {
+        scratch_.resize(length);
+    }
+    const float* source = input;
+    size_t count = length;
+    for (size_t s = 0; s < stages_.size(); s++) {
+        float* target = (s + 1 == stages_.size()) ? output : scratch_.data();
+        count = processStage(stages_[s], source, count, target);
+        source = target;
+    }
+    return count;
+}
+
+size_t Decimator::processStage(Stage& stage, const float* input, size_t length, float* output) {
+    const size_t history = stage.taps.size() - 1;
+    stage.buffer.resize(history);
+    stage.buffer.insert(stage.buffer.end(), input, input + length);
+    
+    // Only every factor-th output is computed; the taps are symmetric, so this
+    // is a plain dot product over contiguous samples
+    const float* taps = stage.taps.data();
+    const size_t tapCount = stage.taps.size();
+    size_t produced = 0;
+    size_t start = stage.next;
+    while (start + tapCount <= stage.buffer.size()) {
+        const float* x = stage.buffer.data() + start;
+        float sum = 0.0f;
+        for (size_t k = 0; k < tapCount; k++) {
+            sum += taps[k] * x[k];
+        }
+        output[produced++] = sum;
+        start += stage.factor;
+    }
+    
+    // Keep the history for the next call
+    const size_t consumed = stage.buffer.size() - history;
+    stage.next = start - consumed;
+    std::copy(stage.buffer.begin() + consumed, stage.buffer.end(), stage.buffer.begin());
+    stage.buffer.resize(history);
+    return produced;
+}
+
+std::vector<float> Decimator::designLowpass(size_t taps, double cutoff) {
+    // Blackman windowed sinc, cutoff as a fraction of the input rate
+    std::vector<float> h(taps);
+    const double centre = (taps - 1) / 2.0;
+    double sum = 0.0;
+    
+    for (size_t n = 0; n < taps; n++) {
+        double t = n - centre;
+        double sinc = (t == 0.0) ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double w = 0.42 - 0.5 * cos(2.0 * M_PI * n / (taps - 1)) +
+                   0.08 * cos(4.0 * M_PI * n / (taps - 1));
+        h[n] = static_cast<float>(sinc * w);
+        sum += h[n];
+    }
+    
+    // Unity gain at DC
+    for (float& tap : h) {
+        tap = static_cast<float>(tap / sum);
+    }
+    return h;
+}
+
+void Decimator::reset() {
+    for (auto& stage : stages_) {
+        std::fill(stage.buffer.begin(), stage.buffer.end(), 0.0f);
+        stage.next = 0;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Integer-factor decimator for real signals, e.g. demodulated audio down to
+// 48 kHz. The factor is split into its prime factors, one polyphase FIR stage
+// each; a stage only has to remove what would alias into the final passband,
+// so the early high-rate stages stay short.
+class Decimator {
+public:
+    // passband in Hz: flat and alias free up to here at the output
+    Decimator(uint32_t inputRate, uint32_t factor, float passband);
+    
+    // Returns the number of samples written; output may be the input buffer.
+    // Produces about length / getFactor() samples, carrying remainders over.
+    size_t process(const float* input, size_t length, float* output);
+    
+    uint32_t getFactor() const { return factor_; }
+    void reset();
+    
+private:
+    struct Stage {
+        uint32_t factor;
+        std::vector<float> taps;
+        std::vector<float> buffer;      // taps - 1 samples of history, then new input
+        size_t next;                    // buffer index where the next output starts
+    };
+    
+    size_t processStage(Stage& stage, const float* input, size_t length, float* output);
+    static std::vector<float> designLowpass(size_t taps, double cutoff);
+    
+    uint32_t factor_;
+    std::vector<Stage> stages_;
+    std::vector<float> scratch_;
+};
+
+#endif // DECIMATOR_H
@@ -20,12 +20,16 @@ FMDemodulator::FMDemodulator(uint32_t sampleRate, uint32_t bandwidth)
     updateAudioFilter();
 }
 
-void FMDemodulator::demodulate(const std::complex<float>* input, float* output, size_t length) {
+void FMDemodulator::demodulate(const std::complex<float>* input, float* output, size_t length,
+                               float* composite) {
     // Quadrature demodulation with improved phase discrimination
     for (size_t i = 0; i < length; i++) {
         // Avoid division by zero
         if (std::abs(input[i]) < 1e-10f) {
             output[i] = 0.0f;
+            if (composite) {
+                composite[i] = 0.0f;
+            }
             lastSample_ = input[i];
             continue;
         }
@@ -51,6 +55,10 @@ void FMDemodulator::demodulate(const std::complex<float>* input, float* output,
         }
         demod = demod / maxDeviation;
         
+        if (composite) {
+            composite[i] = demod;
+        }
+        
         // Clamp to prevent overmodulation artifacts
         // Allow some headroom for strong signals
         demod = std::max(-1.5f, std::min(1.5f, demod));
@@ -11,7 +11,10 @@ public:
     FMDemodulator(uint32_t sampleRate, uint32_t bandwidth);
     ~FMDemodulator() = default;
     
-    void demodulate(const std::complex<float>* input, float* output, size_t length);
+    // Optional composite output receives the raw discriminator signal (MPX,
+    // before de-emphasis and audio filtering) for subcarrier decoders such as RDS
+    void demodulate(const std::complex<float>* input, float* output, size_t length,
+                    float* composite = nullptr);
     
     void setBandwidth(uint32_t bandwidth);
     uint32_t getBandwidth() const { return bandwidth_; }
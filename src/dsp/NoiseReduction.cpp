@@ -9,112 +9,182 @@
 NoiseReduction::NoiseReduction(uint32_t sampleRate)
     : sampleRate_(sampleRate)
     , reductionLevel_(0.5f)
-    , fftSize_(512)
-    , profileLearned_(false)
-    , bufferPos_(0) {
+    , fftSize_(64)
+    , hopFill_(0)
+    , subwindowFrames_(0)
+    , subwindowIndex_(0)
+    , trackingStarted_(false) {
     
-    // Initialize FFT
-    fftIn_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * fftSize_);
-    fftOut_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * fftSize_);
-    fftPlan_ = fftwf_plan_dft_r2c_1d(fftSize_, (float*)fftIn_, fftOut_, FFTW_MEASURE);
-    ifftPlan_ = fftwf_plan_dft_c2r_1d(fftSize_, fftOut_, (float*)fftIn_, FFTW_MEASURE);
+    // About 10 ms frames: 512 points at 48 kHz
+    while (fftSize_ < sampleRate_ / 100) {
+        fftSize_ *= 2;
+    }
+    hopSize_ = fftSize_ / 2;
+    bins_ = fftSize_ / 2 + 1;
     
-    // Initialize buffers
-    inputBuffer_.resize(fftSize_, 0.0f);
-    outputBuffer_.resize(fftSize_, 0.0f);
-    noiseProfile_.resize(fftSize_ / 2 + 1, 0.0f);
+    // Minimum over roughly 1.5 s, split into SUBWINDOWS parts
+    double framesPerSecond = static_cast<double>(sampleRate_) / hopSize_;
+    subwindowLength_ = std::max<size_t>(1, static_cast<size_t>(1.5 * framesPerSecond / SUBWINDOWS));
+    
+    // Initialize FFT
+    fftTime_ = (float*)fftwf_malloc(sizeof(float) * fftSize_);
+    fftFreq_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * bins_);
+    fftPlan_ = fftwf_plan_dft_r2c_1d(fftSize_, fftTime_, fftFreq_, FFTW_MEASURE);
+    ifftPlan_ = fftwf_plan_dft_c2r_1d(fftSize_, fftFreq_, fftTime_, FFTW_MEASURE);
     
-    // Create Hann window
+    // Periodic sqrt Hann on both sides: the squared windows sum to one at 50%
+    // overlap, so unity gain reconstructs the input exactly
     window_.resize(fftSize_);
     for (size_t i = 0; i < fftSize_; i++) {
-        window_[i] = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (fftSize_ - 1)));
+        window_[i] = sqrtf(0.5f * (1.0f - cosf(2.0f * M_PI * i / fftSize_)));
     }
+    
+    inputFrame_.assign(fftSize_, 0.0f);
+    overlapAdd_.assign(fftSize_, 0.0f);
+    ready_.assign(hopSize_, 0.0f);
+    
+    smoothedPower_.assign(bins_, 0.0f);
+    subwindowMin_.assign(bins_, 0.0f);
+    subwindowMins_.assign(SUBWINDOWS * bins_, 0.0f);
+    windowMin_.assign(bins_, 0.0f);
+    noisePower_.assign(bins_, 0.0f);
+    previousClean_.assign(bins_, 0.0f);
 }
 
 NoiseReduction::~NoiseReduction() {
     fftwf_destroy_plan(fftPlan_);
     fftwf_destroy_plan(ifftPlan_);
-    fftwf_free(fftIn_);
-    fftwf_free(fftOut_);
+    fftwf_free(fftTime_);
+    fftwf_free(fftFreq_);
 }
 
 void NoiseReduction::process(const float* input, float* output, size_t length) {
-    // Simple passthrough if noise profile not learned
-    if (!profileLearned_ || reductionLevel_ == 0.0f) {
-        std::copy(input, input + length, output);
-        return;
-    }
-    
-    // Process in blocks with 50% overlap
-    size_t hopSize = fftSize_ / 2;
-    
-    for (size_t i = 0; i < length; i++) {
-        // Add input to buffer
-        inputBuffer_[bufferPos_ + hopSize] = input[i];
+    // Block-wise: copy up to the next hop boundary, run a frame, repeat
+    size_t pos = 0;
+    while (pos < length) {
+        size_t take = std::min(hopSize_ - hopFill_, length - pos);
         
-        // Output from buffer
-        output[i] = outputBuffer_[bufferPos_];
-        
-        bufferPos_++;
+        // New input goes into the last hop of the frame; output comes from the
+        // frame finished one hop ago (read first, input and output may alias)
+        float* newest = inputFrame_.data() + (fftSize_ - hopSize_) + hopFill_;
+        for (size_t i = 0; i < take; i++) {
+            float sample = input[pos + i];
+            output[pos + i] = ready_[hopFill_ + i];
+            newest[i] = sample;
+        }
+        hopFill_ += take;
+        pos += take;
         
-        // Process block when we have enough data
-        if (bufferPos_ >= hopSize) {
-            processBlock();
-            
-            // Shift buffers
-            std::copy(inputBuffer_.begin() + hopSize, inputBuffer_.end(), inputBuffer_.begin());
-            std::copy(outputBuffer_.begin() + hopSize, outputBuffer_.end(), outputBuffer_.begin());
-            std::fill(outputBuffer_.begin() + hopSize, outputBuffer_.end(), 0.0f);
-            
-            bufferPos_ = 0;
+        if (hopFill_ == hopSize_) {
+            processFrame();
+            std::copy(inputFrame_.begin() + hopSize_, inputFrame_.end(), inputFrame_.begin());
+            hopFill_ = 0;
         }
     }
 }
 
-void NoiseReduction::processBlock() {
-    // Apply window and copy to FFT input
+void NoiseReduction::processFrame() {
     for (size_t i = 0; i < fftSize_; i++) {
-        ((float*)fftIn_)[i] = inputBuffer_[i] * window_[i];
+        fftTime_[i] = inputFrame_[i] * window_[i];
     }
-    
-    // Forward FFT
     fftwf_execute(fftPlan_);
     
-    // Spectral subtraction
-    for (size_t i = 0; i < fftSize_ / 2 + 1; i++) {
-        float real = fftOut_[i][0];
-        float imag = fftOut_[i][1];
-        float magnitude = sqrtf(real * real + imag * imag);
-        float phase = atan2f(imag, real);
-        
-        // Subtract noise profile
-        float cleanMagnitude = magnitude - reductionLevel_ * noiseProfile_[i];
-        cleanMagnitude = std::max(0.0f, cleanMagnitude);
+    // The time buffer is free until the inverse transform; hold the power there
+    float* power = fftTime_;
+    for (size_t k = 0; k < bins_; k++) {
+        power[k] = fftFreq_[k][0] * fftFreq_[k][0] + fftFreq_[k][1] * fftFreq_[k][1];
+    }
+    updateNoiseEstimate(power);
+    
+    // Decision-directed a priori SNR and Wiener gain. Gains are real, so the
+    // bins are scaled in place and the phase is left alone.
+    const float level = std::max(0.0f, std::min(1.0f, reductionLevel_));
+    const float gainFloor = powf(10.0f, -level * MAX_ATTENUATION_DB / 20.0f);
+    const float snrFloor = gainFloor * gainFloor;
+    for (size_t k = 0; k < bins_; k++) {
+        float noise = noisePower_[k] + 1e-20f;
+        float posteriori = power[k] / noise;
+        float priori = DD_WEIGHT * previousClean_[k] / noise +
+                       (1.0f - DD_WEIGHT) * std::max(posteriori - 1.0f, 0.0f);
+        priori = std::max(priori, snrFloor);
         
-        // Reconstruct complex number
-        fftOut_[i][0] = cleanMagnitude * cosf(phase);
-        fftOut_[i][1] = cleanMagnitude * sinf(phase);
+        float gain = std::max(priori / (1.0f + priori), gainFloor);
+        previousClean_[k] = gain * gain * power[k];
+        fftFreq_[k][0] *= gain;
+        fftFreq_[k][1] *= gain;
     }
     
-    // Inverse FFT
     fftwf_execute(ifftPlan_);
     
-    // Add windowed result to output buffer (overlap-add)
+    // Overlap-add; FFTW's round trip scales by fftSize_
+    const float scale = 1.0f / fftSize_;
     for (size_t i = 0; i < fftSize_; i++) {
-        outputBuffer_[i] += ((float*)fftIn_)[i] * window_[i] / fftSize_;
+        overlapAdd_[i] += fftTime_[i] * window_[i] * scale;
+    }
+    std::copy(overlapAdd_.begin(), overlapAdd_.begin() + hopSize_, ready_.begin());
+    std::copy(overlapAdd_.begin() + hopSize_, overlapAdd_.end(), overlapAdd_.begin());
+    std::fill(overlapAdd_.begin() + hopSize_, overlapAdd_.end(), 0.0f);
+}
+
+void NoiseReduction::updateNoiseEstimate(const float* power) {
+    if (!trackingStarted_) {
+        // Seed everything from the first frame
+        std::copy(power, power + bins_, smoothedPower_.begin());
+        std::copy(power, power + bins_, subwindowMin_.begin());
+        for (size_t u = 0; u < SUBWINDOWS; u++) {
+            std::copy(power, power + bins_, subwindowMins_.begin() + u * bins_);
+        }
+        std::copy(power, power + bins_, windowMin_.begin());
+        trackingStarted_ = true;
+    }
+    
+    for (size_t k = 0; k < bins_; k++) {
+        float smoothed = SMOOTHING * smoothedPower_[k] + (1.0f - SMOOTHING) * power[k];
+        smoothedPower_[k] = smoothed;
+        subwindowMin_[k] = std::min(subwindowMin_[k], smoothed);
+    }
+    
+    // Close a sub-window: its minimum replaces the oldest one and the search
+    // restarts, so the estimate can rise again within one window after the
+    // floor goes up. The ring is only rescanned here, not every frame.
+    if (++subwindowFrames_ >= subwindowLength_) {
+        std::copy(subwindowMin_.begin(), subwindowMin_.end(),
+                  subwindowMins_.begin() + subwindowIndex_ * bins_);
+        subwindowIndex_ = (subwindowIndex_ + 1) % SUBWINDOWS;
+        std::copy(smoothedPower_.begin(), smoothedPower_.end(), subwindowMin_.begin());
+        subwindowFrames_ = 0;
+        
+        std::copy(subwindowMins_.begin(), subwindowMins_.begin() + bins_, windowMin_.begin());
+        for (size_t u = 1; u < SUBWINDOWS; u++) {
+            const float* mins = subwindowMins_.data() + u * bins_;
+            for (size_t k = 0; k < bins_; k++) {
+                windowMin_[k] = std::min(windowMin_[k], mins[k]);
+            }
+        }
+    }
+    
+    for (size_t k = 0; k < bins_; k++) {
+        noisePower_[k] = MIN_BIAS * std::min(windowMin_[k], subwindowMin_[k]);
     }
 }
 
 void NoiseReduction::learnNoiseProfile() {
-    // In a real implementation, this would analyze a noise-only segment
-    // For now, just set a basic profile
-    for (size_t i = 0; i < noiseProfile_.size(); i++) {
-        noiseProfile_[i] = 0.01f; // Low-level noise floor
+    // Pin the tracker to the present spectrum
+    if (!trackingStarted_) {
+        return;
+    }
+    std::copy(smoothedPower_.begin(), smoothedPower_.end(), subwindowMin_.begin());
+    for (size_t u = 0; u < SUBWINDOWS; u++) {
+        std::copy(smoothedPower_.begin(), smoothedPower_.end(), subwindowMins_.begin() + u * bins_);
     }
-    profileLearned_ = true;
+    std::copy(smoothedPower_.begin(), smoothedPower_.end(), windowMin_.begin());
+    subwindowFrames_ = 0;
 }
 
 void NoiseReduction::resetNoiseProfile() {
-    std::fill(noiseProfile_.begin(), noiseProfile_.end(), 0.0f);
-    profileLearned_ = false;
+    trackingStarted_ = false;
+    subwindowFrames_ = 0;
+    subwindowIndex_ = 0;
+    std::fill(noisePower_.begin(), noisePower_.end(), 0.0f);
+    std::fill(previousClean_.begin(), previousClean_.end(), 0.0f);
 }
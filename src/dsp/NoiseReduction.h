@@ -7,17 +7,24 @@
 #include <cstdint>  // for uint32_t
 #include <fftw3.h>
 
+// STFT noise reduction for demodulated audio. The noise spectrum is tracked
+// continuously with minimum statistics, so no noise-only segment is needed;
+// each bin is scaled by a decision-directed Wiener gain. Meant for the audio
+// rate (48 kHz): frames are about 10 ms with 50% overlap.
 class NoiseReduction {
 public:
     explicit NoiseReduction(uint32_t sampleRate);
     ~NoiseReduction();
     
+    // Block in, block out, in place allowed. Output lags input by one frame.
     void process(const float* input, float* output, size_t length);
     
+    // 0 passes audio through, 1 allows the deepest attenuation
     void setLevel(float level) { reductionLevel_ = level; }
     float getLevel() const { return reductionLevel_; }
     
-    // Learn noise profile from current audio
+    // Take the current spectrum as the noise floor (call during noise only),
+    // or restart tracking from scratch
     void learnNoiseProfile();
     void resetNoiseProfile();
     
@@ -25,24 +32,45 @@ private:
     uint32_t sampleRate_;
     float reductionLevel_;
     
-    // FFT for spectral subtraction
+    // FFT
     size_t fftSize_;
+    size_t hopSize_;
+    size_t bins_;
     fftwf_plan fftPlan_;
     fftwf_plan ifftPlan_;
-    fftwf_complex* fftIn_;
-    fftwf_complex* fftOut_;
+    float* fftTime_;
+    fftwf_complex* fftFreq_;
+    std::vector<float> window_;         // sqrt Hann, used for analysis and synthesis
     
-    // Noise profile
-    std::vector<float> noiseProfile_;
-    bool profileLearned_;
+    // Framing: the last fftSize_ inputs, and the finished output of the last frame
+    std::vector<float> inputFrame_;
+    std::vector<float> overlapAdd_;
+    std::vector<float> ready_;
+    size_t hopFill_;
     
-    // Overlap-add buffers
-    std::vector<float> inputBuffer_;
-    std::vector<float> outputBuffer_;
-    std::vector<float> window_;
-    size_t bufferPos_;
+    // Minimum statistics: smoothed periodogram, minimum over the current
+    // sub-window and the minima of the last SUBWINDOWS sub-windows
+    std::vector<float> smoothedPower_;
+    std::vector<float> subwindowMin_;
+    std::vector<float> subwindowMins_;  // SUBWINDOWS x bins_
+    std::vector<float> windowMin_;      // minimum over subwindowMins_
+    std::vector<float> noisePower_;
+    size_t subwindowLength_;
+    size_t subwindowFrames_;
+    size_t subwindowIndex_;
+    bool trackingStarted_;
     
-    void processBlock();
+    // Decision-directed a priori SNR needs the previous clean estimate
+    std::vector<float> previousClean_;
+    
+    void processFrame();
+    void updateNoiseEstimate(const float* power);
+    
+    static constexpr size_t SUBWINDOWS = 8;
+    static constexpr float SMOOTHING = 0.85f;       // periodogram smoothing
+    static constexpr float MIN_BIAS = 1.5f;         // minimum of a smoothed periodogram sits below the mean
+    static constexpr float DD_WEIGHT = 0.98f;       // decision-directed weight on the previous frame
+    static constexpr float MAX_ATTENUATION_DB = 25.0f;
 };
 
 #endif // NOISEREDUCTION_H
@@ -2,6 +2,7 @@
 #include "../core/RTLSDRDevice.h"
 #include "../core/DSPEngine.h"
 #include <algorithm>
+#include <cmath>
 
 #ifdef HAS_SPDLOG
 #include <spdlog/spdlog.h>
@@ -22,7 +23,14 @@ Scanner::Scanner(QObject* parent)
     , signalDetectCount_(0)
     , priorityCheckInterval_(2000)
     , returningFromPriority_(false)
-    , savedFrequency_(0) {
+    , savedFrequency_(0)
+    , windowCenter_(0)
+    , windowSpan_(0)
+    , windowFrames_(0)
+    , windowSeen_(0)
+    , windowGeneration_(0)
+    , windowCapture_(false)
+    , windowSettleUntil_(0) {
     
     // Initialize scan parameters with defaults
     params_.startFreq = 88e6;     // 88 MHz
@@ -49,6 +57,18 @@ Scanner::~Scanner() {
     stopScan();
 }
 
+void Scanner::setDSPEngine(DSPEngine* dsp) {
+    dspEngine_ = dsp;
+    
+    // Installed once and only switched on for wideband scans, so the DSP
+    // thread never sees the callback change under it
+    if (dspEngine_) {
+        dspEngine_->setScanSpectrumCallback([this](const float* spectrum, size_t length) {
+            onWindowSpectrum(spectrum, length);
+        });
+    }
+}
+
 void Scanner::setScanParameters(const ScanParameters& params) {
     params_ = params;
     
@@ -107,6 +127,22 @@ void Scanner::startScan(ScanMode mode, ScanDirection direction) {
                 params_.startFreq : params_.endFreq;
             break;
             
+        case ScanMode::WIDEBAND: {
+            // Start one stride outside the range so the first hop lands on its edge
+            uint32_t sampleRate = dspEngine_ ? dspEngine_->getSampleRate() : 2400000;
+            windowSpan_ = sampleRate * WINDOW_USABLE_FRACTION;
+            windowCenter_ = (direction == ScanDirection::UP) ?
+                params_.startFreq - windowSpan_ / 2 : params_.endFreq + windowSpan_ / 2;
+            currentFrequency_ = (direction == ScanDirection::UP) ?
+                params_.startFreq : params_.endFreq;
+            pendingHits_.clear();
+            windowCapture_ = false;
+            if (dspEngine_) {
+                dspEngine_->setScanSpectrumEnabled(true);
+            }
+            break;
+        }
+            
         default:
             break;
     }
@@ -145,6 +181,12 @@ void Scanner::stopScan() {
     isPaused_ = false;
     currentMode_ = ScanMode::OFF;
     
+    windowCapture_ = false;
+    pendingHits_.clear();
+    if (dspEngine_) {
+        dspEngine_->setScanSpectrumEnabled(false);
+    }
+    
     scanTimer_->stop();
     dwellTimer_->stop();
     priorityTimer_->stop();
@@ -195,6 +237,12 @@ void Scanner::onScanTimer() {
             scanNextChannel();
             break;
             
+        case ScanMode::WIDEBAND:
+            // Hops are paced by spectrum arrival, not by the timer
+            scanTimer_->stop();
+            scanNextWindow();
+            break;
+            
         default:
             break;
     }
@@ -267,6 +315,11 @@ void Scanner::scanNextChannel() {
 void Scanner::onSignalStrength(float strength) {
     lastSignalStrength_ = strength;
     
+    // Wideband mode detects from the spectrum; the S-meter only sees the hop centre
+    if (currentMode_ == ScanMode::WIDEBAND) {
+        return;
+    }
+    
     // Check if signal is active
     if (isSignalActive(strength)) {
         signalDetectCount_++;
@@ -301,6 +354,159 @@ bool Scanner::isSignalActive(double strength) {
            (strength > noiseFloor_ + 10);
 }
 
+void Scanner::scanNextWindow() {
+    // Visit the active channels of the last window before hopping on
+    if (!pendingHits_.empty()) {
+        WindowHit hit = pendingHits_.front();
+        pendingHits_.erase(pendingHits_.begin());
+        
+        currentFrequency_ = hit.frequency;
+        if (rtlsdr_ && rtlsdr_->isOpen()) {
+            rtlsdr_->setCenterFrequency(currentFrequency_);
+        }
+        emit frequencyChanged(currentFrequency_);
+        
+        pauseScan();
+        emit signalDetected(currentFrequency_, hit.strength);
+        dwellTimer_->start(params_.dwellTimeMs);
+        return;
+    }
+    
+    if (scanDirection_ == ScanDirection::UP) {
+        windowCenter_ += windowSpan_;
+        if (windowCenter_ - windowSpan_ / 2 > params_.endFreq) {
+            windowCenter_ = params_.startFreq + windowSpan_ / 2;
+        }
+    } else {
+        windowCenter_ -= windowSpan_;
+        if (windowCenter_ + windowSpan_ / 2 < params_.startFreq) {
+            windowCenter_ = params_.endFreq - windowSpan_ / 2;
+        }
+    }
+    
+    tuneWindow(windowCenter_);
+}
+
+void Scanner::tuneWindow(double centerFreq) {
+    currentFrequency_ = centerFreq;
+    if (rtlsdr_ && rtlsdr_->isOpen()) {
+        rtlsdr_->setCenterFrequency(currentFrequency_);
+    }
+    emit frequencyChanged(currentFrequency_);
+    
+    // Frames captured before the tuner settles (and still queued in USB buffers)
+    // belong to the previous window, so the DSP side skips them by time
+    auto settle = std::chrono::steady_clock::now() + std::chrono::milliseconds(WINDOW_SETTLE_MS);
+    windowSettleUntil_ = settle.time_since_epoch().count();
+    windowGeneration_++;
+    windowCapture_ = true;
+    
+    double range = params_.endFreq - params_.startFreq;
+    if (range > 0) {
+        double position = std::max(0.0, std::min(range, centerFreq - params_.startFreq));
+        emit scanProgress(static_cast<int>((position / range) * 100));
+    }
+}
+
+void Scanner::onWindowSpectrum(const float* spectrum, size_t length) {
+    if (!windowCapture_) {
+        return;
+    }
+    if (std::chrono::steady_clock::now().time_since_epoch().count() < windowSettleUntil_) {
+        return;
+    }
+    
+    // A new window was tuned since the last frame; the average is ours to reset
+    uint32_t generation = windowGeneration_;
+    if (generation != windowSeen_) {
+        windowSeen_ = generation;
+        windowAverage_.clear();
+        windowFrames_ = -1;
+    }
+    
+    // Frames are power averaged over the whole frame period, so the first one
+    // after the settle time can still straddle the retune
+    if (windowFrames_ < 0) {
+        windowFrames_ = 0;
+        return;
+    }
+    
+    if (windowAverage_.size() != length) {
+        windowAverage_.assign(length, 0.0f);
+        windowFrames_ = 0;
+    }
+    for (size_t i = 0; i < length; i++) {
+        windowAverage_[i] += spectrum[i];
+    }
+    
+    if (++windowFrames_ < WINDOW_AVERAGE_FRAMES) {
+        return;
+    }
+    
+    windowCapture_ = false;
+    std::vector<float> averaged(windowAverage_);
+    for (float& bin : averaged) {
+        bin /= WINDOW_AVERAGE_FRAMES;
+    }
+    QMetaObject::invokeMethod(this, [this, averaged]() {
+        measureWindow(averaged);
+    }, Qt::QueuedConnection);
+}
+
+void Scanner::measureWindow(const std::vector<float>& spectrum) {
+    if (!isScanning_ || currentMode_ != ScanMode::WIDEBAND || spectrum.empty() ||
+        !dspEngine_ || params_.stepSize <= 0) {
+        return;
+    }
+    
+    const size_t bins = spectrum.size();
+    const double binWidth = static_cast<double>(dspEngine_->getSampleRate()) / bins;
+    
+    // The median bin is a robust noise floor for a mostly empty window. It
+    // is in FFT bin dB, not on the S-meter scale noiseFloor_ tracks, so it
+    // stays local to this window.
+    std::vector<float> sorted(spectrum);
+    std::nth_element(sorted.begin(), sorted.begin() + bins / 2, sorted.end());
+    const float windowFloor = sorted[bins / 2];
+    
+    // Peak within the centre half of each channel, so a strong neighbour's
+    // skirt is not mistaken for activity on an empty channel
+    const int halfWidth = std::max(1, static_cast<int>(params_.stepSize / 4 / binWidth));
+    const double low = std::max(params_.startFreq, windowCenter_ - windowSpan_ / 2);
+    const double high = std::min(params_.endFreq, windowCenter_ + windowSpan_ / 2);
+    
+    pendingHits_.clear();
+    double first = params_.startFreq +
+        std::ceil((low - params_.startFreq) / params_.stepSize) * params_.stepSize;
+    for (double freq = first; freq < high + 1.0; freq += params_.stepSize) {
+        int centre = static_cast<int>(std::lround((freq - windowCenter_) / binWidth)) +
+                     static_cast<int>(bins / 2);
+        int from = std::max(0, centre - halfWidth);
+        int to = std::min(static_cast<int>(bins) - 1, centre + halfWidth);
+        if (from > to) {
+            continue;
+        }
+        
+        float peak = *std::max_element(spectrum.begin() + from, spectrum.begin() + to + 1);
+        if (peak > params_.signalThreshold && peak > windowFloor + WINDOW_SNR_DB) {
+            pendingHits_.push_back({freq, peak});
+        }
+    }
+    
+    if (scanDirection_ == ScanDirection::DOWN) {
+        std::reverse(pendingHits_.begin(), pendingHits_.end());
+    }
+    
+#ifdef HAS_SPDLOG
+    spdlog::debug("Wideband window {:.3f} MHz: {} active channels, floor {:.1f} dB",
+                 windowCenter_ / 1e6, pendingHits_.size(), windowFloor);
+#endif
+    
+    if (!isPaused_) {
+        scanNextWindow();
+    }
+}
+
 void Scanner::onDwellTimer() {
     // Dwell time expired - check if signal still active
     if (isSignalActive(lastSignalStrength_)) {
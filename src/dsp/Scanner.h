@@ -5,6 +5,7 @@
 #include <QTimer>
 #include <vector>
 #include <atomic>
+#include <chrono>
 
 class RTLSDRDevice;
 class DSPEngine;
@@ -18,7 +19,8 @@ public:
         FREQUENCY,   // Scan frequency range
         CHANNEL,     // Scan predefined channels
         MEMORY,      // Scan memory channels
-        BAND         // Scan within band
+        BAND,        // Scan within band
+        WIDEBAND     // Measure every channel of a capture window from one FFT
     };
     
     enum class ScanDirection {
@@ -49,8 +51,9 @@ public:
     
     // Configuration
     void setRTLSDR(RTLSDRDevice* rtlsdr) { rtlsdr_ = rtlsdr; }
-    void setDSPEngine(DSPEngine* dsp) { dspEngine_ = dsp; }
+    void setDSPEngine(DSPEngine* dsp);  // before the engine is started
     void setScanParameters(const ScanParameters& params);
+    const ScanParameters& getScanParameters() const { return params_; }
     void setChannels(const std::vector<Channel>& channels);
     void setMemoryChannels(const std::vector<Channel>& channels);
     
@@ -94,6 +97,12 @@ private:
     void checkPriorityChannels();
     bool isSignalActive(double strength);
     
+    // Wideband scanning
+    void scanNextWindow();
+    void tuneWindow(double centerFreq);
+    void onWindowSpectrum(const float* spectrum, size_t length);  // DSP thread
+    void measureWindow(const std::vector<float>& spectrum);
+    
     // Hardware interfaces
     RTLSDRDevice* rtlsdr_;
     DSPEngine* dspEngine_;
@@ -129,6 +138,25 @@ private:
     int priorityCheckInterval_;
     bool returningFromPriority_;
     double savedFrequency_;
+    
+    // Wideband scanning: hop in capture-bandwidth strides, dwell only on hits
+    struct WindowHit {
+        double frequency;
+        float strength;
+    };
+    double windowCenter_;
+    double windowSpan_;                         // usable (flat) part of the capture
+    std::vector<WindowHit> pendingHits_;
+    std::vector<float> windowAverage_;          // DSP thread only
+    int windowFrames_;                          // DSP thread only; -1 while the first frame is discarded
+    uint32_t windowSeen_;                       // DSP thread only; last window it reset for
+    std::atomic<uint32_t> windowGeneration_;    // bumped by tuneWindow() for every new window
+    std::atomic<bool> windowCapture_;
+    std::atomic<int64_t> windowSettleUntil_;    // steady_clock ticks
+    static constexpr double WINDOW_USABLE_FRACTION = 0.8;  // drop the anti-alias roll-off
+    static constexpr int WINDOW_SETTLE_MS = 60;            // tuner PLL + queued USB buffers
+    static constexpr int WINDOW_AVERAGE_FRAMES = 2;        // frames are already Welch averaged
+    static constexpr double WINDOW_SNR_DB = 10.0;
 };
 
 #endif // SCANNER_H
@@ -0,0 +1,322 @@
+#include "SpectrumSweeper.h"
+#include "../core/RTLSDRDevice.h"
+#include <QDateTime>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#ifdef HAS_SPDLOG
+#include <spdlog/spdlog.h>
+#endif
+
+SpectrumSweeper::SpectrumSweeper(QObject* parent)
+    : QObject(parent)
+    , rtlsdr_(nullptr)
+    , hopCount_(0)
+    , keptBins_(0)
+    , binWidth_(0)
+    , stitchedStart_(0)
+    , captureState_(CaptureState::WAIT_TUNE)
+    , captureHop_(0)
+    , settleRemaining_(0)
+    , captureFill_(0)
+    , tunedHop_(-1)
+    , pendingHop_(0)
+    , pendingReady_(false)
+    , running_(false)
+    , fftPlan_(nullptr)
+    , fftIn_(nullptr)
+    , fftOut_(nullptr)
+    , sweepTimestamp_(0) {
+    
+    // 8-bit offset binary to float, same scaling as DSPEngine
+    for (int i = 0; i < 256; i++) {
+        iqTable_[i] = (i - 127.5f) / 127.5f;
+    }
+}
+
+SpectrumSweeper::~SpectrumSweeper() {
+    stop();
+}
+
+bool SpectrumSweeper::start(const SweepParameters& params) {
+    if (running_) {
+        stop();
+    }
+    
+    if (!rtlsdr_ || !rtlsdr_->isOpen()) {
+        emit errorOccurred("Sweep needs an open RTL-SDR device");
+        return false;
+    }
+    if (params.endFreq <= params.startFreq || params.fftSize < 64 || params.averages < 1 ||
+        params.usableFraction <= 0.0 || params.usableFraction > 1.0) {
+        emit errorOccurred("Invalid sweep parameters");
+        return false;
+    }
+    
+    params_ = params;
+    
+    // Hop plan: each hop contributes its flat centre, neighbouring hops abut exactly
+    binWidth_ = static_cast<double>(params_.sampleRate) / params_.fftSize;
+    keptBins_ = std::max<size_t>(1, static_cast<size_t>(params_.fftSize * params_.usableFraction));
+    double hopSpan = keptBins_ * binWidth_;
+    hopCount_ = std::max<size_t>(1, static_cast<size_t>(
+        std::ceil((params_.endFreq - params_.startFreq) / hopSpan)));
+    stitchedStart_ = params_.startFreq;
+    stitched_.assign(hopCount_ * keptBins_, -120.0f);
+    
+    // Hann window computed once
+    window_.resize(params_.fftSize);
+    for (size_t i = 0; i < params_.fftSize; i++) {
+        window_[i] = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (params_.fftSize - 1)));
+    }
+    hopPower_.resize(params_.fftSize);
+    
+    fftIn_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * params_.fftSize);
+    fftOut_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * params_.fftSize);
+    fftPlan_ = fftwf_plan_dft_1d(params_.fftSize, fftIn_, fftOut_, FFTW_FORWARD, FFTW_MEASURE);
+    
+    // Capture buffers (interleaved 8-bit I/Q)
+    size_t captureBytes = params_.fftSize * params_.averages * 2;
+    captureBuffer_.assign(captureBytes, 0);
+    pendingBuffer_.assign(captureBytes, 0);
+    workBuffer_.assign(captureBytes, 0);
+    
+    captureState_ = CaptureState::WAIT_TUNE;
+    captureHop_ = 0;
+    captureFill_ = 0;
+    settleRemaining_ = 0;
+    tunedHop_ = -1;
+    pendingReady_ = false;
+    
+    if (params_.logFormat != LogFormat::NONE && !params_.logPath.isEmpty()) {
+        logFile_.setFileName(params_.logPath);
+        if (!logFile_.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            emit errorOccurred(QString("Cannot open sweep log %1: %2")
+                               .arg(params_.logPath).arg(logFile_.errorString()));
+        }
+    }
+    
+    running_ = true;
+    workerThread_ = std::thread(&SpectrumSweeper::sweepWorker, this);
+
+#ifdef HAS_SPDLOG
+    spdlog::info("Sweep started: {:.3f}-{:.3f} MHz, {} hops of {} bins ({:.1f} Hz)",
+                 params_.startFreq / 1e6, params_.endFreq / 1e6, hopCount_, keptBins_, binWidth_);
+#endif
+
+    return true;
+}
+
+void SpectrumSweeper::stop() {
+    if (!running_) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        running_ = false;
+    }
+    handoffCondition_.notify_all();
+    if (workerThread_.joinable()) {
+        workerThread_.join();
+    }
+    
+    if (fftPlan_) {
+        fftwf_destroy_plan(fftPlan_);
+        fftPlan_ = nullptr;
+    }
+    if (fftIn_) {
+        fftwf_free(fftIn_);
+        fftIn_ = nullptr;
+    }
+    if (fftOut_) {
+        fftwf_free(fftOut_);
+        fftOut_ = nullptr;
+    }
+    
+    if (logFile_.isOpen()) {
+        logFile_.close();
+    }
+
+#ifdef HAS_SPDLOG
+    spdlog::info("Sweep stopped");
+#endif
+}
+
+void SpectrumSweeper::processIQ(const uint8_t* data, size_t length) {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    if (!running_) {
+        return;
+    }
+    
+    size_t pos = 0;
+    while (pos < length) {
+        if (captureState_ == CaptureState::WAIT_TUNE) {
+            // Everything up to the retune belongs to the previous hop
+            if (tunedHop_.load() != static_cast<int64_t>(captureHop_)) {
+                return;
+            }
+            settleRemaining_ = static_cast<size_t>(
+                params_.sampleRate * (params_.settleMs / 1000.0)) * 2;
+            captureState_ = CaptureState::SETTLE;
+        }
+        
+        if (captureState_ == CaptureState::SETTLE) {
+            size_t skip = std::min(settleRemaining_, length - pos);
+            pos += skip;
+            settleRemaining_ -= skip;
+            if (settleRemaining_ == 0) {
+                captureFill_ = 0;
+                captureState_ = CaptureState::CAPTURE;
+            }
+            continue;
+        }
+        
+        size_t count = std::min(captureBuffer_.size() - captureFill_, length - pos);
+        std::memcpy(captureBuffer_.data() + captureFill_, data + pos, count);
+        captureFill_ += count;
+        pos += count;
+        
+        if (captureFill_ == captureBuffer_.size()) {
+            {
+                std::lock_guard<std::mutex> lock(handoffMutex_);
+                captureBuffer_.swap(pendingBuffer_);
+                pendingHop_ = captureHop_;
+                pendingReady_ = true;
+            }
+            handoffCondition_.notify_one();
+            
+            captureHop_ = (captureHop_ + 1) % hopCount_;
+            captureState_ = CaptureState::WAIT_TUNE;
+        }
+    }
+}
+
+void SpectrumSweeper::sweepWorker() {
+    // First hop
+    if (rtlsdr_) {
+        rtlsdr_->setCenterFrequency(static_cast<uint32_t>(hopCenter(0)));
+    }
+    tunedHop_ = 0;
+    
+    while (running_) {
+        size_t hop;
+        {
+            std::unique_lock<std::mutex> lock(handoffMutex_);
+            handoffCondition_.wait(lock, [this]() { return pendingReady_ || !running_; });
+            if (!running_) {
+                break;
+            }
+            pendingBuffer_.swap(workBuffer_);
+            hop = pendingHop_;
+            pendingReady_ = false;
+        }
+        
+        // Retune first so the tuner settles while this hop is transformed
+        size_t next = (hop + 1) % hopCount_;
+        if (rtlsdr_ && next != hop) {
+            rtlsdr_->setCenterFrequency(static_cast<uint32_t>(hopCenter(next)));
+        }
+        tunedHop_ = static_cast<int64_t>(next);
+        
+        if (hop == 0) {
+            sweepTimestamp_ = QDateTime::currentMSecsSinceEpoch();
+        }
+        
+        processHop(hop, workBuffer_);
+        emit sweepProgress(static_cast<int>((hop + 1) * 100 / hopCount_));
+        
+        if (hop == hopCount_ - 1) {
+            emit sweepCompleted(stitched_, stitchedStart_, binWidth_);
+            writeLog();
+        }
+    }
+}
+
+void SpectrumSweeper::processHop(size_t hop, const std::vector<uint8_t>& capture) {
+    const size_t n = params_.fftSize;
+    std::fill(hopPower_.begin(), hopPower_.end(), 0.0f);
+    
+    for (int segment = 0; segment < params_.averages; segment++) {
+        const uint8_t* iq = capture.data() + segment * n * 2;
+        
+        // Per-segment mean removes the LO leakage spike at the hop centre
+        float meanI = 0.0f;
+        float meanQ = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            meanI += iqTable_[iq[2 * i]];
+            meanQ += iqTable_[iq[2 * i + 1]];
+        }
+        meanI /= n;
+        meanQ /= n;
+        
+        for (size_t i = 0; i < n; i++) {
+            fftIn_[i][0] = (iqTable_[iq[2 * i]] - meanI) * window_[i];
+            fftIn_[i][1] = (iqTable_[iq[2 * i + 1]] - meanQ) * window_[i];
+        }
+        fftwf_execute(fftPlan_);
+        
+        for (size_t i = 0; i < n; i++) {
+            hopPower_[i] += fftOut_[i][0] * fftOut_[i][0] + fftOut_[i][1] * fftOut_[i][1];
+        }
+    }
+    
+    // Keep the centre keptBins_ (FFT order: DC at 0, negative frequencies at the top)
+    const float norm = 1.0f / (static_cast<float>(n) * n * params_.averages);
+    float* out = stitched_.data() + hop * keptBins_;
+    const size_t firstBin = n - keptBins_ / 2;
+    for (size_t k = 0; k < keptBins_; k++) {
+        float power = hopPower_[(firstBin + k) % n] * norm;
+        out[k] = std::max(-120.0f, 10.0f * log10f(power + 1e-12f));
+    }
+}
+
+double SpectrumSweeper::hopCenter(size_t hop) const {
+    // Output bin k of a hop sits at centre + (k - keptBins_/2) * binWidth
+    return stitchedStart_ + (hop * keptBins_ + keptBins_ / 2) * binWidth_;
+}
+
+void SpectrumSweeper::writeLog() {
+    if (!logFile_.isOpen()) {
+        return;
+    }
+    
+    if (params_.logFormat == LogFormat::CSV) {
+        QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(sweepTimestamp_);
+        QString date = timestamp.toString("yyyy-MM-dd");
+        QString time = timestamp.toString("HH:mm:ss");
+        
+        for (size_t hop = 0; hop < hopCount_; hop++) {
+            double low = stitchedStart_ + hop * keptBins_ * binWidth_;
+            double high = low + keptBins_ * binWidth_;
+            QString line = QString("%1, %2, %3, %4, %5, %6")
+                               .arg(date).arg(time)
+                               .arg(static_cast<qint64>(low)).arg(static_cast<qint64>(high))
+                               .arg(binWidth_, 0, 'f', 2)
+                               .arg(params_.fftSize * params_.averages);
+            const float* bins = stitched_.data() + hop * keptBins_;
+            for (size_t k = 0; k < keptBins_; k++) {
+                line += ", " + QString::number(bins[k], 'f', 2);
+            }
+            line += "\n";
+            logFile_.write(line.toUtf8());
+        }
+    } else {
+        qint64 timestamp = sweepTimestamp_;
+        double start = stitchedStart_;
+        double binWidth = binWidth_;
+        quint32 count = static_cast<quint32>(stitched_.size());
+        logFile_.write(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+        logFile_.write(reinterpret_cast<const char*>(&start), sizeof(start));
+        logFile_.write(reinterpret_cast<const char*>(&binWidth), sizeof(binWidth));
+        logFile_.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        logFile_.write(reinterpret_cast<const char*>(stitched_.data()),
+                       stitched_.size() * sizeof(float));
+    }
+    logFile_.flush();
+}
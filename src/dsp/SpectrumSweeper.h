@@ -0,0 +1,126 @@
+#ifndef SPECTRUMSWEEPER_H
+#define SPECTRUMSWEEPER_H
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fftw3.h>
+
+class RTLSDRDevice;
+
+// Panoramic (rtl_power style) sweep: hops the tuner across a range wider than one
+// capture, averages several FFTs per hop and stitches the flat centre of each hop
+// into a single power array.
+class SpectrumSweeper : public QObject {
+    Q_OBJECT
+    
+public:
+    enum class LogFormat {
+        NONE,
+        CSV,        // rtl_power compatible, one line per hop
+        BINARY      // per sweep: timestamp, start, bin width, count, float32 dB bins
+    };
+    
+    struct SweepParameters {
+        double startFreq;
+        double endFreq;
+        uint32_t sampleRate;
+        size_t fftSize;         // bins per hop before trimming
+        int averages;           // FFTs averaged per hop
+        double usableFraction;  // centre part of each hop kept (filter roll-off trimmed)
+        int settleMs;           // samples discarded after each retune
+        LogFormat logFormat;
+        QString logPath;
+        
+        SweepParameters() : startFreq(88e6), endFreq(108e6), sampleRate(2400000), fftSize(1024),
+                            averages(16), usableFraction(0.75), settleMs(30),
+                            logFormat(LogFormat::NONE) {}
+    };
+    
+    explicit SpectrumSweeper(QObject* parent = nullptr);
+    ~SpectrumSweeper();
+    
+    void setRTLSDR(RTLSDRDevice* rtlsdr) { rtlsdr_ = rtlsdr; }
+    
+    // Control
+    bool start(const SweepParameters& params);
+    void stop();
+    bool isRunning() const { return running_; }
+    
+    // Raw 8-bit IQ from the RTL-SDR callback while a sweep is running
+    void processIQ(const uint8_t* data, size_t length);
+    
+    // Layout of the stitched output
+    double getStitchedStartFrequency() const { return stitchedStart_; }
+    double getBinWidth() const { return binWidth_; }
+    size_t getHopCount() const { return hopCount_; }
+    
+signals:
+    void sweepCompleted(const std::vector<float>& power, double startFreq, double binWidth);
+    void sweepProgress(int percent);
+    void errorOccurred(const QString& error);
+    
+private:
+    enum class CaptureState {
+        WAIT_TUNE,  // retune for the next hop not issued yet
+        SETTLE,     // discarding samples while the tuner settles
+        CAPTURE     // collecting averages * fftSize samples
+    };
+    
+    void sweepWorker();
+    void processHop(size_t hop, const std::vector<uint8_t>& capture);
+    double hopCenter(size_t hop) const;
+    void writeLog();
+    
+    RTLSDRDevice* rtlsdr_;
+    SweepParameters params_;
+    
+    // Hop plan
+    size_t hopCount_;
+    size_t keptBins_;
+    double binWidth_;
+    double stitchedStart_;
+    
+    // Capture side (RTL-SDR callback thread). stop() clears running_ under
+    // captureMutex_, so no processIQ() call is left in flight for start() to
+    // reallocate under.
+    std::mutex captureMutex_;
+    CaptureState captureState_;
+    size_t captureHop_;
+    size_t settleRemaining_;
+    size_t captureFill_;
+    std::vector<uint8_t> captureBuffer_;
+    std::atomic<int64_t> tunedHop_;   // last hop the tuner was moved to, -1 before the first
+    
+    // Hand-off to the worker; the worker retunes before it processes, so the
+    // next hop's settling overlaps the FFTs of the previous one
+    std::mutex handoffMutex_;
+    std::condition_variable handoffCondition_;
+    std::vector<uint8_t> pendingBuffer_;
+    size_t pendingHop_;
+    bool pendingReady_;
+    
+    // Worker side
+    std::thread workerThread_;
+    std::atomic<bool> running_;
+    std::vector<uint8_t> workBuffer_;
+    std::vector<float> window_;
+    std::vector<float> hopPower_;
+    std::vector<float> stitched_;
+    float iqTable_[256];
+    
+    fftwf_plan fftPlan_;
+    fftwf_complex* fftIn_;
+    fftwf_complex* fftOut_;
+    
+    // Logging
+    QFile logFile_;
+    qint64 sweepTimestamp_;
+};
+
+#endif // SPECTRUMSWEEPER_H
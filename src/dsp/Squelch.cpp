@@ -2,31 +2,150 @@
 #include <cmath>
 #include <algorithm>
 
-Squelch::Squelch(float threshold)
-    : threshold_(threshold)
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+Squelch::Squelch(float threshold, uint32_t sampleRate)
+    : sampleRate_(sampleRate)
+    , mode_(LEVEL)
+    , activeMode_(LEVEL)
+    , threshold_(threshold)
     , squelched_(true)
+    , open_(false)
+    , hysteresis_(3.0f)
+    , hangTime_(250.0f)
+    , hangSamples_(0)
     , attackTime_(5.0f)    // 5ms attack
     , decayTime_(100.0f)   // 100ms decay
-    , fadeLevel_(0.0f) {
+    , fadeLevel_(0.0f)
+    , metric_(-100.0f)
+    , noiseFilter_(2, 1)
+    , noisePower_(1.0f) {
+    
+    // Fourth order Butterworth high-pass: two sections with Q 0.541 and 1.307
+    const float qs[2] = {0.5412f, 1.3066f};
+    const float omega = 2.0f * M_PI * NOISE_CORNER / sampleRate_;
+    const float cosOmega = cosf(omega);
+    for (size_t s = 0; s < 2; s++) {
+        float alpha = sinf(omega) / (2.0f * qs[s]);
+        float a0 = 1.0f + alpha;
+        BiquadCascade::Coefficients c;
+        c.b0 = (1.0f + cosOmega) / (2.0f * a0);
+        c.b1 = -(1.0f + cosOmega) / a0;
+        c.b2 = c.b0;
+        c.a1 = -2.0f * cosOmega / a0;
+        c.a2 = (1.0f - alpha) / a0;
+        noiseFilter_.setImmediate(s, c);
+    }
+}
+
+bool Squelch::process(float* audio, size_t length, float signalLevel, float snr) {
+    measure(audio, length, signalLevel, snr);
+    return apply(audio, length);
 }
 
-bool Squelch::process(float* audio, size_t length, float signalLevel) {
-    bool shouldSquelch = signalLevel < threshold_;
+void Squelch::measure(const float* audio, size_t length, float signalLevel, float snr) {
+    if (length == 0) {
+        return;
+    }
     
-    // State change detection
-    if (shouldSquelch != squelched_) {
-        squelched_ = shouldSquelch;
-        
-        // Apply smooth transition
-        applyFade(audio, length, !squelched_);
-    } else if (squelched_) {
-        // Mute audio if squelched
-        std::fill(audio, audio + length, 0.0f);
+    // Mode changes arrive from the UI; restart the measurements here
+    const Mode mode = mode_;
+    if (mode != activeMode_) {
+        activeMode_ = mode;
+        hangSamples_ = 0;
+        noiseFilter_.reset();
+        noisePower_ = 1.0f;
+    }
+    
+    // Everything is compared as "higher is better" in dB
+    float metric = 0.0f;
+    switch (mode) {
+        case LEVEL:
+            metric = signalLevel;
+            break;
+        case NOISE:
+            // Quieting: how far the out-of-band noise sits below full scale
+            metric = -10.0f * log10f(measureNoise(audio, length) + 1e-12f);
+            break;
+        case SNR:
+            metric = snr;
+            break;
     }
+    metric_ = metric;
+    
+    const float required = requiredMetric(threshold_);
+    const float hysteresis = hysteresis_;
+    if (!open_) {
+        if (metric >= required + hysteresis / 2.0f) {
+            open_ = true;
+            hangSamples_ = 0;
+        }
+    } else if (metric < required - hysteresis / 2.0f) {
+        // Ride through short fades before closing
+        hangSamples_ += length;
+        if (hangSamples_ >= static_cast<size_t>(hangTime_ * sampleRate_ / 1000.0f)) {
+            open_ = false;
+        }
+    } else {
+        hangSamples_ = 0;
+    }
+}
+
+bool Squelch::apply(float* audio, size_t length) {
+    if (length == 0) {
+        return squelched_;
+    }
+    
+    applyFade(audio, length);
     
+    // Only report squelched once the fade out has finished, so downstream
+    // stages can skip work without cutting the tail
+    squelched_ = !open_ && fadeLevel_ == 0.0f;
     return squelched_;
 }
 
+float Squelch::measureNoise(const float* audio, size_t length) {
+    if (noiseScratch_.size() < length) {
+        noiseScratch_.resize(length);
+    }
+    std::copy(audio, audio + length, noiseScratch_.begin());
+    noiseFilter_.process(noiseScratch_.data(), length);
+    
+    float sum = 0.0f;
+    for (size_t i = 0; i < length; i++) {
+        sum += noiseScratch_[i] * noiseScratch_[i];
+    }
+    
+    // Smooth over about 20 ms so single blocks do not flap the gate
+    float alpha = 1.0f - expf(-static_cast<float>(length) / (0.02f * sampleRate_));
+    noisePower_ += alpha * (sum / length - noisePower_);
+    return noisePower_;
+}
+
+float Squelch::requiredMetric(float threshold) const {
+    // Knob position, 0 fully open to 1 tightest
+    float position = std::max(0.0f, std::min(1.0f, (threshold + 100.0f) / 100.0f));
+    switch (activeMode_) {
+        case NOISE:
+            return position * 40.0f;
+        case SNR:
+            return position * 30.0f;
+        case LEVEL:
+        default:
+            return threshold;
+    }
+}
+
+void Squelch::setHysteresis(float dB) {
+    hysteresis_ = std::max(0.0f, std::min(20.0f, dB));
+}
+
+void Squelch::setHangTime(float ms) {
+    hangTime_ = std::max(0.0f, std::min(5000.0f, ms));
+}
+
 void Squelch::setAttackTime(float ms) {
     attackTime_ = std::max(0.1f, std::min(100.0f, ms));
 }
@@ -35,12 +154,21 @@ void Squelch::setDecayTime(float ms) {
     decayTime_ = std::max(1.0f, std::min(1000.0f, ms));
 }
 
-void Squelch::applyFade(float* audio, size_t length, bool opening) {
-    float fadeTime = opening ? attackTime_ : decayTime_;
-    float fadeRate = 1000.0f / (fadeTime * 48000.0f); // Assuming 48kHz audio
+void Squelch::applyFade(float* audio, size_t length) {
+    // Ramp towards the gate state every block, not only on the transition
+    const float target = open_ ? 1.0f : 0.0f;
+    if (fadeLevel_ == target) {
+        if (!open_) {
+            std::fill(audio, audio + length, 0.0f);
+        }
+        return;
+    }
+    
+    float fadeTime = open_ ? attackTime_.load() : decayTime_.load();
+    float fadeRate = 1000.0f / (fadeTime * sampleRate_);
     
     for (size_t i = 0; i < length; i++) {
-        if (opening) {
+        if (open_) {
             fadeLevel_ = std::min(1.0f, fadeLevel_ + fadeRate);
         } else {
             fadeLevel_ = std::max(0.0f, fadeLevel_ - fadeRate);
@@ -1,33 +1,79 @@
 #ifndef SQUELCH_H
 #define SQUELCH_H
 
+#include <atomic>
 #include <cstddef>  // for size_t
+#include <cstdint>  // for uint32_t
+#include <vector>
+#include "BiquadCascade.h"
 
 class Squelch {
 public:
-    explicit Squelch(float threshold = -20.0f);
+    enum Mode {
+        LEVEL,      // wideband signal strength
+        NOISE,      // FM quieting: discriminator noise above 5 kHz
+        SNR         // channel power over the spectrum noise floor
+    };
+    
+    explicit Squelch(float threshold = -20.0f, uint32_t sampleRate = 48000);
     ~Squelch() = default;
     
-    // Process audio and return true if squelched (muted)
-    bool process(float* audio, size_t length, float signalLevel);
+    // Process audio and return true if squelched (muted). signalLevel is used
+    // in LEVEL mode, snr (dB) in SNR mode; NOISE mode measures the audio itself.
+    bool process(float* audio, size_t length, float signalLevel, float snr = 0.0f);
+    
+    // The two halves of process(), for when the audio is rescaled in between
+    // (AGC): measure() decides on the demodulator's output, where the noise
+    // level means something, and apply() fades the rescaled audio.
+    void measure(const float* audio, size_t length, float signalLevel, float snr = 0.0f);
+    bool apply(float* audio, size_t length);
     
+    // Threshold on the squelch knob's -100..0 dB scale. LEVEL uses it as is;
+    // NOISE maps it onto 0..40 dB of quieting and SNR onto 0..30 dB.
+    // The setters may be called from another thread than process().
     void setThreshold(float threshold) { threshold_ = threshold; }
     float getThreshold() const { return threshold_; }
     
+    void setMode(Mode mode) { mode_ = mode; }
+    Mode getMode() const { return mode_; }
+    
+    // Opens at threshold + hysteresis / 2, closes below threshold - hysteresis / 2
+    // once it has stayed there for the hang time
+    void setHysteresis(float dB);
+    void setHangTime(float ms);
     void setAttackTime(float ms);
     void setDecayTime(float ms);
     
     bool isOpen() const { return !squelched_; }
     
+    // Last value compared against the threshold, in dB (higher is better)
+    float getMetric() const { return metric_; }
+    
 private:
-    float threshold_;     // Threshold in dB
+    uint32_t sampleRate_;
+    std::atomic<Mode> mode_;
+    Mode activeMode_;     // mode the measurements were last run in
+    std::atomic<float> threshold_;    // Threshold in dB
     bool squelched_;      // Current squelch state
-    float attackTime_;    // Time to open squelch (ms)
-    float decayTime_;     // Time to close squelch (ms)
+    bool open_;           // Gate decision; audio fades towards it
+    std::atomic<float> hysteresis_;   // dB between open and close points
+    std::atomic<float> hangTime_;     // ms below the close point before closing
+    size_t hangSamples_;  // samples spent below the close point
+    std::atomic<float> attackTime_;   // Time to open squelch (ms)
+    std::atomic<float> decayTime_;    // Time to close squelch (ms)
     float fadeLevel_;     // Current fade level (0-1)
+    std::atomic<float> metric_;
+    
+    // FM noise measurement
+    BiquadCascade noiseFilter_;
+    std::vector<float> noiseScratch_;
+    float noisePower_;
+    
+    float measureNoise(const float* audio, size_t length);
+    float requiredMetric(float threshold) const;
+    void applyFade(float* audio, size_t length);
     
-    // Smooth transitions
-    void applyFade(float* audio, size_t length, bool opening);
+    static constexpr float NOISE_CORNER = 5000.0f;   // Hz
 };
 
 #endif // SQUELCH_H
@@ -0,0 +1,178 @@
+#include "ZoomFFT.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Blackman windowed half-band: passband to 0.19 fs, 70+ dB beyond 0.31 fs, so
+// after each halving the outer eighth on either side of the band may alias
+const std::array<float, ZoomFFT::HALFBAND_TAPS> ZoomFFT::HALFBAND = ZoomFFT::buildHalfband();
+
+ZoomFFT::ZoomFFT(uint32_t sampleRate, uint32_t decimation, double offset, size_t fftSize)
+    : sampleRate_(sampleRate)
+    , offset_(offset)
+    , fftSize_(fftSize)
+    , keptBins_(static_cast<size_t>(fftSize * USABLE_FRACTION))
+    , mixerPhasor_(1.0f, 0.0f)
+    , historyFill_(0)
+    , averages_(0)
+    , frameFill_(0)
+    , powerScale_(1.0f) {
+    
+    // Mixer moves offset down to DC
+    float step = static_cast<float>(-2.0 * M_PI * offset / sampleRate);
+    mixerStep_ = std::complex<float>(cosf(step), sinf(step));
+    
+    size_t stageCount = 1;
+    while ((2u << stageCount) <= decimation && stageCount < 16) {
+        stageCount++;
+    }
+    stages_.resize(stageCount);
+    
+    // Hann window, normalised so a tone reads the same as on the full spectrum
+    window_.resize(fftSize_);
+    double coherentGain = 0.0;
+    for (size_t i = 0; i < fftSize_; i++) {
+        window_[i] = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (fftSize_ - 1)));
+        coherentGain += window_[i];
+    }
+    powerScale_ = static_cast<float>(1.0 / (coherentGain * coherentGain));
+    
+    history_.resize(fftSize_);
+    accum_.assign(fftSize_, 0.0f);
+    
+    fftIn_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * fftSize_);
+    fftOut_ = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * fftSize_);
+    fftPlan_ = fftwf_plan_dft_1d(fftSize_, fftIn_, fftOut_, FFTW_FORWARD, FFTW_MEASURE);
+}
+
+ZoomFFT::~ZoomFFT() {
+    fftwf_destroy_plan(fftPlan_);
+    fftwf_free(fftIn_);
+    fftwf_free(fftOut_);
+}
+
+bool ZoomFFT::process(const std::complex<float>* data, size_t length, std::vector<float>& frame,
+                      size_t frameSamples) {
+    for (auto& buffer : stageBuffer_) {
+        if (buffer.size() < length) {
+            buffer.resize(length);
+        }
+    }
+    
+    // Shift, then halve the rate stage by stage, ping-ponging between two buffers
+    std::complex<float>* shifted = stageBuffer_[0].data();
+    if (offset_ != 0.0) {
+        for (size_t i = 0; i < length; i++) {
+            shifted[i] = data[i] * mixerPhasor_;
+            mixerPhasor_ *= mixerStep_;
+        }
+        // Keep the recursive phasor on the unit circle
+        mixerPhasor_ /= std::abs(mixerPhasor_);
+    } else {
+        std::copy(data, data + length, shifted);
+    }
+    
+    size_t count = length;
+    int current = 0;
+    for (auto& stage : stages_) {
+        count = decimate(stage, stageBuffer_[current].data(), count,
+                         stageBuffer_[current ^ 1].data());
+        current ^= 1;
+    }
+    
+    // Welch segments on the decimated stream
+    const std::complex<float>* slow = stageBuffer_[current].data();
+    const size_t hop = fftSize_ / 2;
+    size_t pos = 0;
+    while (pos < count) {
+        size_t take = std::min(fftSize_ - historyFill_, count - pos);
+        std::copy(slow + pos, slow + pos + take, history_.begin() + historyFill_);
+        historyFill_ += take;
+        pos += take;
+        if (historyFill_ < fftSize_) {
+            break;
+        }
+        
+        for (size_t i = 0; i < fftSize_; i++) {
+            fftIn_[i][0] = history_[i].real() * window_[i];
+            fftIn_[i][1] = history_[i].imag() * window_[i];
+        }
+        fftwf_execute(fftPlan_);
+        for (size_t i = 0; i < fftSize_; i++) {
+            accum_[i] += fftOut_[i][0] * fftOut_[i][0] + fftOut_[i][1] * fftOut_[i][1];
+        }
+        averages_++;
+        
+        std::copy(history_.begin() + hop, history_.end(), history_.begin());
+        historyFill_ = fftSize_ - hop;
+    }
+    
+    frameFill_ += length;
+    if (averages_ == 0 || frameFill_ < frameSamples) {
+        return false;
+    }
+    
+    // Centre keptBins_ only (FFT order: DC at 0, negative frequencies at the top)
+    frame.resize(keptBins_);
+    const float normFactor = powerScale_ / averages_;
+    const size_t firstBin = fftSize_ - keptBins_ / 2;
+    for (size_t k = 0; k < keptBins_; k++) {
+        float dB = 10.0f * log10f(accum_[(firstBin + k) % fftSize_] * normFactor + 1e-20f);
+        frame[k] = std::max(-120.0f, std::min(0.0f, dB));
+    }
+    std::fill(accum_.begin(), accum_.end(), 0.0f);
+    averages_ = 0;
+    frameFill_ = 0;
+    return true;
+}
+
+size_t ZoomFFT::decimate(HalfbandStage& stage, const std::complex<float>* input, size_t length,
+                         std::complex<float>* output) {
+    const int centre = HALFBAND_TAPS / 2;
+    size_t produced = 0;
+    
+    for (size_t i = 0; i < length; i++) {
+        stage.delay[stage.writePos] = input[i];
+        stage.delay[stage.writePos + HALFBAND_TAPS] = input[i];
+        stage.writePos = (stage.writePos + 1) % HALFBAND_TAPS;
+        
+        stage.skip = !stage.skip;
+        if (stage.skip) {
+            continue;
+        }
+        
+        // Last HALFBAND_TAPS samples, oldest first. Symmetric taps, and every
+        // other tap except the centre is zero.
+        const std::complex<float>* x = stage.delay.data() + stage.writePos;
+        std::complex<float> sum = HALFBAND[centre] * x[centre];
+        for (int k = 1; k <= centre; k += 2) {
+            sum += HALFBAND[centre - k] * (x[centre - k] + x[centre + k]);
+        }
+        output[produced++] = sum;
+    }
+    return produced;
+}
+
+std::array<float, ZoomFFT::HALFBAND_TAPS> ZoomFFT::buildHalfband() {
+    std::array<float, HALFBAND_TAPS> taps;
+    const int centre = HALFBAND_TAPS / 2;
+    double sum = 0.0;
+    
+    for (int n = 0; n < HALFBAND_TAPS; n++) {
+        int k = n - centre;
+        double sinc = (k == 0) ? 0.5 : sin(M_PI * k / 2.0) / (M_PI * k);
+        double w = 0.42 - 0.5 * cos(2.0 * M_PI * n / (HALFBAND_TAPS - 1)) +
+                   0.08 * cos(4.0 * M_PI * n / (HALFBAND_TAPS - 1));
+        taps[n] = static_cast<float>(sinc * w);
+        sum += taps[n];
+    }
+    
+    // Unity gain at DC
+    for (float& tap : taps) {
+        tap = static_cast<float>(tap / sum);
+    }
+    return taps;
+}
@@ -0,0 +1,78 @@
+#ifndef ZOOMFFT_H
+#define ZOOMFFT_H
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <fftw3.h>
+
+// Zoom spectrum: mixes the capture so the region of interest sits at DC, halves
+// the rate through a chain of half-band filters and runs a high resolution FFT
+// on the slow stream. Only the alias-free centre of the decimated band is returned.
+class ZoomFFT {
+public:
+    // decimation is rounded down to a power of two (at least 2)
+    ZoomFFT(uint32_t sampleRate, uint32_t decimation, double offset, size_t fftSize = 2048);
+    ~ZoomFFT();
+    
+    // Consumes full-rate IQ. Returns true when frame holds a new power spectrum in
+    // dB, negative frequencies first. Segments are averaged until at least
+    // frameSamples full-rate samples have gone by, which paces the frames.
+    bool process(const std::complex<float>* data, size_t length, std::vector<float>& frame,
+                 size_t frameSamples = 0);
+    
+    uint32_t getDecimation() const { return 1u << stages_.size(); }
+    double getOutputRate() const { return static_cast<double>(sampleRate_) / getDecimation(); }
+    double getSpan() const { return getOutputRate() * USABLE_FRACTION; }
+    double getBinWidth() const { return getOutputRate() / fftSize_; }
+    double getOffset() const { return offset_; }
+    
+    // Part of each decimated band outside the half-band transition regions
+    static constexpr double USABLE_FRACTION = 0.75;
+    
+private:
+    static constexpr int HALFBAND_TAPS = 47;
+    
+    struct HalfbandStage {
+        std::array<std::complex<float>, 2 * HALFBAND_TAPS> delay;  // each sample stored twice
+        size_t writePos;
+        bool skip;                      // every other input produces no output
+        
+        HalfbandStage() : writePos(0), skip(false) { delay.fill(std::complex<float>(0.0f, 0.0f)); }
+    };
+    
+    size_t decimate(HalfbandStage& stage, const std::complex<float>* input, size_t length,
+                    std::complex<float>* output);
+    
+    static std::array<float, HALFBAND_TAPS> buildHalfband();
+    static const std::array<float, HALFBAND_TAPS> HALFBAND;
+    
+    uint32_t sampleRate_;
+    double offset_;
+    size_t fftSize_;
+    size_t keptBins_;
+    
+    // Frequency shift
+    std::complex<float> mixerPhasor_;
+    std::complex<float> mixerStep_;
+    
+    // Decimation
+    std::vector<HalfbandStage> stages_;
+    std::vector<std::complex<float>> stageBuffer_[2];
+    
+    // High resolution FFT on the decimated stream (Welch, 50% overlap)
+    std::vector<std::complex<float>> history_;
+    size_t historyFill_;
+    std::vector<float> window_;
+    std::vector<float> accum_;
+    size_t averages_;
+    size_t frameFill_;                  // full-rate samples since the last frame
+    float powerScale_;
+    fftwf_plan fftPlan_;
+    fftwf_complex* fftIn_;
+    fftwf_complex* fftOut_;
+};
+
+#endif // ZOOMFFT_H
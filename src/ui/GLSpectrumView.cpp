@@ -0,0 +1,426 @@
+#include "GLSpectrumView.h"
+#include "WaterfallRenderer.h"
+#include <QPainter>
+#include <algorithm>
+
+#ifdef HAS_SPDLOG
+#include <spdlog/spdlog.h>
+#endif
+
+// GLSL 1.10 so the shaders build on any desktop context, llvmpipe included
+static const char* TRACE_VERTEX_SHADER =
+    "attribute vec2 position;\n"
+    "uniform vec4 area;\n"
+    "uniform vec2 range;\n"
+    "varying float level;\n"
+    "void main() {\n"
+    "    level = clamp((position.y - range.x) / (range.y - range.x), 0.0, 1.0);\n"
+    "    gl_Position = vec4(mix(area.x, area.z, position.x), mix(area.y, area.w, level), 0.0, 1.0);\n"
+    "}\n";
+
+static const char* TRACE_FRAGMENT_SHADER =
+    "uniform vec4 color;\n"
+    "uniform float fade;\n"
+    "varying float level;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(color.rgb, color.a * mix(1.0, level, fade));\n"
+    "}\n";
+
+static const char* WATERFALL_VERTEX_SHADER =
+    "attribute vec2 position;\n"
+    "uniform vec4 area;\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "    texCoord = position;\n"
+    "    gl_Position = vec4(mix(area.x, area.z, position.x), mix(area.y, area.w, position.y), 0.0, 1.0);\n"
+    "}\n";
+
+static const char* WATERFALL_FRAGMENT_SHADER =
+    "uniform sampler2D levels;\n"
+    "uniform sampler2D palette;\n"
+    "uniform float newestRow;\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "    float index = texture2D(levels, vec2(texCoord.x, newestRow + 1.0 - texCoord.y)).r;\n"
+    "    gl_FragColor = texture2D(palette, vec2(index * (255.0 / 256.0) + 0.5 / 256.0, 0.5));\n"
+    "}\n";
+
+GLSpectrumView::GLSpectrumView(QWidget* parent)
+    : QOpenGLWidget(parent)
+    , initialized_(false)
+    , showSpectrum_(true)
+    , showWaterfall_(true)
+    , minDb_(-120.0f)
+    , maxDb_(-10.0f)
+    , axisLow_(0.0)
+    , axisHigh_(0.0)
+    , traceBuffer_(QOpenGLBuffer::VertexBuffer)
+    , quadBuffer_(QOpenGLBuffer::VertexBuffer)
+    , levelsTexture_(0)
+    , paletteTexture_(0)
+    , fillRange_{0, 0}
+    , envelopeRange_{0, 0}
+    , lineRange_{0, 0}
+    , phosphorRange_{0, 0}
+    , peakRange_{0, 0}
+    , minRange_{0, 0}
+    , verticesDirty_(false)
+    , paletteDirty_(true)
+    , textureWidth_(0)
+    , newestRow_(0)
+    , pendingCount_(0)
+    , waterfallReset_(true) {
+    
+    setColorScheme(0, 1.0f);
+}
+
+GLSpectrumView::~GLSpectrumView() {
+    if (!initialized_) {
+        return;
+    }
+    
+    makeCurrent();
+    glDeleteTextures(1, &levelsTexture_);
+    glDeleteTextures(1, &paletteTexture_);
+    traceBuffer_.destroy();
+    quadBuffer_.destroy();
+    doneCurrent();
+}
+
+void GLSpectrumView::setPanes(bool spectrum, bool waterfall) {
+    showSpectrum_ = spectrum;
+    showWaterfall_ = waterfall;
+    update();
+}
+
+void GLSpectrumView::setLevels(float minDb, float maxDb) {
+    minDb_ = minDb;
+    maxDb_ = maxDb;
+}
+
+void GLSpectrumView::setFrequencyAxis(double lowHz, double highHz) {
+    axisLow_ = lowHz;
+    axisHigh_ = highHz;
+    update();
+}
+
+void GLSpectrumView::setColorScheme(int scheme, float intensity) {
+    for (int i = 0; i < 256; i++) {
+        QRgb color = WaterfallRenderer::schemeColor(scheme, std::min(1.0f, (i / 255.0f) * intensity));
+        palette_[i * 4] = static_cast<uint8_t>(qRed(color));
+        palette_[i * 4 + 1] = static_cast<uint8_t>(qGreen(color));
+        palette_[i * 4 + 2] = static_cast<uint8_t>(qBlue(color));
+        palette_[i * 4 + 3] = 255;
+    }
+    paletteDirty_ = true;
+    update();
+}
+
+void GLSpectrumView::setTraces(const std::vector<float>& spectrum,
+                               const std::vector<float>* phosphor,
+                               const std::vector<float>* peakHold,
+                               const std::vector<float>* minHold) {
+    const int columns = std::max(1, width());
+    vertices_.clear();
+    
+    // Fill under the curve and the min/max envelope are triangle strips of
+    // (bottom or min, max) pairs; the trace itself is the max line
+    WaterfallRenderer::decimate(spectrum.data(), spectrum.size(), columns, columnMin_, columnMax_);
+    fillRange_ = {0, 2 * columns};
+    for (int x = 0; x < columns; x++) {
+        float position = (x + 0.5f) / columns;
+        vertices_.insert(vertices_.end(), {position, -1000.0f, position, columnMax_[x]});
+    }
+    envelopeRange_ = {2 * columns, 2 * columns};
+    for (int x = 0; x < columns; x++) {
+        float position = (x + 0.5f) / columns;
+        vertices_.insert(vertices_.end(), {position, columnMin_[x], position, columnMax_[x]});
+    }
+    lineRange_ = {4 * columns, 0};
+    appendColumns(columnMax_, lineRange_);
+    
+    phosphorRange_.count = 0;
+    if (phosphor && !phosphor->empty()) {
+        WaterfallRenderer::decimate(phosphor->data(), phosphor->size(), columns,
+                                    columnMin_, columnMax_);
+        appendColumns(columnMax_, phosphorRange_);
+    }
+    peakRange_.count = 0;
+    if (peakHold && !peakHold->empty()) {
+        WaterfallRenderer::decimate(peakHold->data(), peakHold->size(), columns,
+                                    columnMin_, columnMax_);
+        appendColumns(columnMax_, peakRange_);
+    }
+    minRange_.count = 0;
+    if (minHold && !minHold->empty()) {
+        WaterfallRenderer::decimate(minHold->data(), minHold->size(), columns,
+                                    columnMin_, columnMax_);
+        appendColumns(columnMin_, minRange_);
+    }
+    verticesDirty_ = true;
+}
+
+void GLSpectrumView::appendColumns(const std::vector<float>& columns, TraceRange& range) {
+    range.first = static_cast<int>(vertices_.size() / 2);
+    range.count = static_cast<int>(columns.size());
+    for (size_t x = 0; x < columns.size(); x++) {
+        float position = (x + 0.5f) / columns.size();
+        vertices_.insert(vertices_.end(), {position, columns[x]});
+    }
+}
+
+void GLSpectrumView::addWaterfallLine(const std::vector<float>& spectrum) {
+    if (textureWidth_ <= 0 || spectrum.empty()) {
+        return;
+    }
+    
+    // Quantise to palette indices here; colouring happens in the shader
+    WaterfallRenderer::decimate(spectrum.data(), spectrum.size(), textureWidth_,
+                                columnMin_, columnMax_);
+    if (pendingCount_ == HISTORY_ROWS) {
+        // The GUI has not painted for a whole history; keep the newest rows
+        pendingRows_.erase(pendingRows_.begin(), pendingRows_.begin() + textureWidth_);
+        pendingCount_--;
+    }
+    
+    const float scale = (maxDb_ > minDb_) ? 255.0f / (maxDb_ - minDb_) : 0.0f;
+    size_t offset = pendingRows_.size();
+    pendingRows_.resize(offset + textureWidth_);
+    for (int x = 0; x < textureWidth_; x++) {
+        int index = static_cast<int>((columnMax_[x] - minDb_) * scale);
+        pendingRows_[offset + x] = static_cast<uint8_t>(std::max(0, std::min(255, index)));
+    }
+    pendingCount_++;
+}
+
+void GLSpectrumView::clearWaterfall() {
+    pendingRows_.clear();
+    pendingCount_ = 0;
+    waterfallReset_ = true;
+    update();
+}
+
+void GLSpectrumView::initializeGL() {
+    initializeOpenGLFunctions();
+    
+    if (!traceProgram_.addShaderFromSourceCode(QOpenGLShader::Vertex, TRACE_VERTEX_SHADER) ||
+        !traceProgram_.addShaderFromSourceCode(QOpenGLShader::Fragment, TRACE_FRAGMENT_SHADER) ||
+        !traceProgram_.link() ||
+        !waterfallProgram_.addShaderFromSourceCode(QOpenGLShader::Vertex, WATERFALL_VERTEX_SHADER) ||
+        !waterfallProgram_.addShaderFromSourceCode(QOpenGLShader::Fragment, WATERFALL_FRAGMENT_SHADER) ||
+        !waterfallProgram_.link()) {
+        emit initializationFailed(traceProgram_.log() + waterfallProgram_.log());
+        return;
+    }
+    
+    traceBuffer_.create();
+    traceBuffer_.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    
+    static const float quad[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    quadBuffer_.create();
+    quadBuffer_.bind();
+    quadBuffer_.allocate(quad, sizeof(quad));
+    quadBuffer_.release();
+    
+    glGenTextures(1, &levelsTexture_);
+    glBindTexture(GL_TEXTURE_2D, levelsTexture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    
+    glGenTextures(1, &paletteTexture_);
+    glBindTexture(GL_TEXTURE_2D, paletteTexture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    // Rows are tightly packed bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    initialized_ = true;
+
+#ifdef HAS_SPDLOG
+    spdlog::info("OpenGL spectrum: {} ({})",
+                 reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+                 reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+#endif
+}
+
+void GLSpectrumView::resizeGL(int w, int h) {
+    Q_UNUSED(h);
+    
+    // One texel per pixel column; the history restarts at the new width
+    if (w != textureWidth_) {
+        textureWidth_ = w;
+        pendingRows_.clear();
+        pendingCount_ = 0;
+        waterfallReset_ = true;
+    }
+}
+
+void GLSpectrumView::paintGL() {
+    glClearColor(0.0f, 10.0f / 255.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (!initialized_) {
+        return;
+    }
+    
+    if (paletteDirty_) {
+        glBindTexture(GL_TEXTURE_2D, paletteTexture_);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     palette_.data());
+        paletteDirty_ = false;
+    }
+    uploadWaterfall();
+    
+    if (verticesDirty_) {
+        traceBuffer_.bind();
+        traceBuffer_.allocate(vertices_.data(), static_cast<int>(vertices_.size() * sizeof(float)));
+        traceBuffer_.release();
+        verticesDirty_ = false;
+    }
+    
+    if (showWaterfall_) {
+        drawWaterfall();
+    }
+    if (showSpectrum_) {
+        drawTraces();
+    }
+    drawGrid();
+}
+
+void GLSpectrumView::uploadWaterfall() {
+    if (textureWidth_ <= 0) {
+        return;
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, levelsTexture_);
+    if (waterfallReset_) {
+        std::vector<uint8_t> blank(static_cast<size_t>(textureWidth_) * HISTORY_ROWS, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, textureWidth_, HISTORY_ROWS, 0,
+                     GL_LUMINANCE, GL_UNSIGNED_BYTE, blank.data());
+        newestRow_ = 0;
+        waterfallReset_ = false;
+    }
+    
+    // Each row is one glTexSubImage2D into the ring, stepping backwards so the
+    // newest row has the lowest index above the previous one
+    for (int row = 0; row < pendingCount_; row++) {
+        newestRow_ = (newestRow_ + HISTORY_ROWS - 1) % HISTORY_ROWS;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, newestRow_, textureWidth_, 1, GL_LUMINANCE,
+                        GL_UNSIGNED_BYTE, pendingRows_.data() + static_cast<size_t>(row) * textureWidth_);
+    }
+    pendingRows_.clear();
+    pendingCount_ = 0;
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GLSpectrumView::drawWaterfall() {
+    // Clip space: bottom half when both panes are shown
+    const float top = showSpectrum_ ? 0.0f : 1.0f;
+    
+    waterfallProgram_.bind();
+    waterfallProgram_.setUniformValue("area", -1.0f, -1.0f, 1.0f, top);
+    waterfallProgram_.setUniformValue("newestRow", (newestRow_ + 0.5f) / HISTORY_ROWS);
+    waterfallProgram_.setUniformValue("levels", 0);
+    waterfallProgram_.setUniformValue("palette", 1);
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, levelsTexture_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, paletteTexture_);
+    
+    quadBuffer_.bind();
+    int position = waterfallProgram_.attributeLocation("position");
+    waterfallProgram_.enableAttributeArray(position);
+    waterfallProgram_.setAttributeBuffer(position, GL_FLOAT, 0, 2);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    waterfallProgram_.disableAttributeArray(position);
+    quadBuffer_.release();
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    waterfallProgram_.release();
+}
+
+void GLSpectrumView::drawTraces() {
+    if (lineRange_.count == 0) {
+        return;
+    }
+    
+    const float bottom = showWaterfall_ ? 0.0f : -1.0f;
+    
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    
+    traceProgram_.bind();
+    traceProgram_.setUniformValue("area", -1.0f, bottom, 1.0f, 1.0f);
+    traceProgram_.setUniformValue("range", minDb_, maxDb_);
+    
+    traceBuffer_.bind();
+    int position = traceProgram_.attributeLocation("position");
+    traceProgram_.enableAttributeArray(position);
+    traceProgram_.setAttributeBuffer(position, GL_FLOAT, 0, 2);
+    
+    auto draw = [this](GLenum primitive, const TraceRange& range, const QColor& color, float fade) {
+        if (range.count == 0) {
+            return;
+        }
+        traceProgram_.setUniformValue("color", color);
+        traceProgram_.setUniformValue("fade", fade);
+        glDrawArrays(primitive, range.first, range.count);
+    };
+    
+    // Same colours as the QPainter path
+    draw(GL_TRIANGLE_STRIP, fillRange_, QColor(0, 255, 0, 100), 1.0f);
+    draw(GL_LINE_STRIP, phosphorRange_, QColor(0, 180, 0, 150), 0.0f);
+    draw(GL_TRIANGLE_STRIP, envelopeRange_, QColor(0, 255, 0, 120), 0.0f);
+    draw(GL_LINE_STRIP, lineRange_, QColor(0, 255, 0), 0.0f);
+    draw(GL_LINE_STRIP, minRange_, QColor(0, 160, 255), 0.0f);
+    draw(GL_LINE_STRIP, peakRange_, QColor(255, 200, 0), 0.0f);
+    
+    traceProgram_.disableAttributeArray(position);
+    traceBuffer_.release();
+    traceProgram_.release();
+    glDisable(GL_BLEND);
+}
+
+void GLSpectrumView::drawGrid() {
+    // A few lines and labels; QPainter on top of the GL frame is fine for this
+    QPainter painter(this);
+    painter.setPen(QPen(QColor(0, 100, 0, 100), 1, Qt::DotLine));
+    
+    const QRect area = rect();
+    const int numVLines = 10;
+    for (int i = 1; i < numVLines; i++) {
+        int x = area.left() + (area.width() * i) / numVLines;
+        painter.drawLine(x, area.top(), x, area.bottom());
+    }
+    
+    const int numHLines = 5;
+    for (int i = 1; i < numHLines; i++) {
+        int y = area.top() + (area.height() * i) / numHLines;
+        painter.drawLine(area.left(), y, area.right(), y);
+    }
+    
+    QFont font = painter.font();
+    font.setPixelSize(10);
+    painter.setFont(font);
+    painter.setPen(QColor(0, 200, 0));
+    for (int i = 0; i <= numHLines; i++) {
+        int y = area.top() + (area.height() * i) / numHLines;
+        float db = maxDb_ - (maxDb_ - minDb_) * i / numHLines;
+        painter.drawText(area.left() + 5, y + 3, QString("%1 dB").arg(static_cast<int>(db)));
+    }
+    
+    if (axisHigh_ > axisLow_) {
+        for (int i = 1; i < numVLines; i++) {
+            int x = area.left() + (area.width() * i) / numVLines;
+            double freq = axisLow_ + (axisHigh_ - axisLow_) * i / numVLines;
+            painter.drawText(x + 3, area.bottom() - 4, QString("%1").arg(freq / 1e6, 0, 'f', 3));
+        }
+    }
+}
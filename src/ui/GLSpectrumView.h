@@ -0,0 +1,96 @@
+#ifndef GLSPECTRUMVIEW_H
+#define GLSPECTRUMVIEW_H
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLBuffer>
+#include <array>
+#include <vector>
+
+// OpenGL renderer for SpectrumDisplay. Waterfall rows go into a texture used as
+// a ring (GL_REPEAT plus a row offset) and are coloured through a palette texture
+// in the fragment shader; traces are one vertex buffer in dB, scaled on the GPU.
+// Runs on whatever GL the platform offers, including Mesa llvmpipe.
+class GLSpectrumView : public QOpenGLWidget, protected QOpenGLFunctions {
+    Q_OBJECT
+    
+public:
+    explicit GLSpectrumView(QWidget* parent = nullptr);
+    ~GLSpectrumView();
+    
+    void setPanes(bool spectrum, bool waterfall);
+    void setLevels(float minDb, float maxDb);
+    void setColorScheme(int scheme, float intensity);
+    void setFrequencyAxis(double lowHz, double highHz);  // MHz labels when high > low
+    
+    // Traces in dB across the span; null pointers hide the optional ones
+    void setTraces(const std::vector<float>& spectrum, const std::vector<float>* phosphor,
+                   const std::vector<float>* peakHold, const std::vector<float>* minHold);
+    void addWaterfallLine(const std::vector<float>& spectrum);
+    void clearWaterfall();
+    
+signals:
+    // No usable context or shaders; the owner should fall back to QPainter
+    void initializationFailed(const QString& reason);
+    
+protected:
+    void initializeGL() override;
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
+    
+private:
+    // Vertex buffer layout, in vertices of (x 0..1, dB)
+    struct TraceRange {
+        int first;
+        int count;
+    };
+    
+    void drawTraces();
+    void drawWaterfall();
+    void drawGrid();
+    void uploadWaterfall();
+    void appendColumns(const std::vector<float>& columns, TraceRange& range);
+    
+    bool initialized_;
+    bool showSpectrum_;
+    bool showWaterfall_;
+    float minDb_;
+    float maxDb_;
+    double axisLow_;
+    double axisHigh_;
+    
+    // Shaders and buffers
+    QOpenGLShaderProgram traceProgram_;
+    QOpenGLShaderProgram waterfallProgram_;
+    QOpenGLBuffer traceBuffer_;
+    QOpenGLBuffer quadBuffer_;
+    GLuint levelsTexture_;
+    GLuint paletteTexture_;
+    
+    // CPU side staging, uploaded in paintGL
+    std::vector<float> vertices_;
+    std::vector<float> columnMin_;
+    std::vector<float> columnMax_;
+    TraceRange fillRange_;
+    TraceRange envelopeRange_;
+    TraceRange lineRange_;
+    TraceRange phosphorRange_;
+    TraceRange peakRange_;
+    TraceRange minRange_;
+    bool verticesDirty_;
+    
+    std::array<uint8_t, 256 * 4> palette_;
+    bool paletteDirty_;
+    
+    // Waterfall ring: rows are 8-bit palette indices, newest at newestRow_
+    int textureWidth_;
+    int newestRow_;
+    std::vector<uint8_t> pendingRows_;      // oldest first
+    int pendingCount_;
+    bool waterfallReset_;
+    
+    static constexpr int HISTORY_ROWS = 512;
+};
+
+#endif // GLSPECTRUMVIEW_H
@@ -12,10 +12,16 @@
 #include "../config/Settings.h"
 #include "../core/RTLSDRDevice.h"
 #include "../core/DSPEngine.h"
+#include "../core/DeviceManager.h"
 #include "../audio/AudioOutput.h"
 #include "../audio/VintageEqualizer.h"
 #include "../audio/RecordingManager.h"
+#include "../audio/RecordingScheduler.h"
 #include "../dsp/Scanner.h"
+#include "../dsp/SpectrumSweeper.h"
+#include "../decoders/CTCSSDecoder.h"
+#include "../decoders/RDSDecoder.h"
+#include "../decoders/ADSBDecoder.h"
 #include "../config/MemoryChannel.h"
 
 #include <QVBoxLayout>
@@ -36,7 +42,16 @@
 #include <QStatusBar>
 #include <QLineEdit>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QDateTimeEdit>
+#include <QDialog>
+#include <QListWidget>
 #include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 #ifdef HAS_SPDLOG
 #include <spdlog/spdlog.h>
@@ -45,7 +60,9 @@
 MainWindow::MainWindow(std::shared_ptr<Settings> settings, QWidget* parent)
     : QMainWindow(parent)
     , settings_(settings)
+    , adsbEngine_(nullptr)
     , isRunning_(false)
+    , spectrumPending_(false)
     , currentFrequency_(96900000) // 96.9 MHz
     , currentBand_(2)  // FM band
     , currentTheme_(0) // Military Olive default
@@ -56,12 +73,19 @@ MainWindow::MainWindow(std::shared_ptr<Settings> settings, QWidget* parent)
     
     // Initialize components
     rtlsdr_ = std::make_unique<RTLSDRDevice>();
+    
+    // FFT plans measured in earlier sessions make planning instant
+    QDir().mkpath(settings_->getDataPath());
+    DSPEngine::importFFTWisdom(fftWisdomPath().toStdString());
     dspEngine_ = std::make_unique<DSPEngine>();
     audioOutput_ = std::make_unique<AudioOutput>(this);
     equalizer_ = std::make_unique<VintageEqualizer>(48000, VintageEqualizer::MODERN);
     memoryManager_ = std::make_unique<MemoryChannelManager>();
     recordingManager_ = std::make_unique<RecordingManager>();
+    scheduler_ = std::make_unique<RecordingScheduler>(recordingManager_.get());
     scanner_ = std::make_unique<Scanner>();
+    sweeper_ = std::make_unique<SpectrumSweeper>();
+    deviceManager_ = std::make_unique<DeviceManager>();
     
     setupUI();
     connectSignals();
@@ -79,13 +103,16 @@ MainWindow::MainWindow(std::shared_ptr<Settings> settings, QWidget* parent)
         std::vector<float> eqBuffer(length);
         equalizer_->process(data, eqBuffer.data(), length);
         
+        // Live audio feeds the recorder and the time-shift buffer; while
+        // replaying, the delayed audio replaces it at the output
+        recordingManager_->writeAudioData(eqBuffer.data(), length);
+        CTCSSDecoder* ctcss = dspEngine_->getCTCSSDecoder();
+        recordingManager_->updateTrigger(!dspEngine_->isSquelched(),
+                                         ctcss && ctcss->isToneDetected() ? ctcss->getCurrentTone() : 0.0f);
+        recordingManager_->applyTimeShiftPlayback(eqBuffer.data(), length);
+        
         // Send to audio output
         audioOutput_->writeAudio(eqBuffer.data(), length);
-        
-        // Send to recording manager if recording
-        if (recordingManager_->isRecording()) {
-            recordingManager_->writeAudioData(eqBuffer.data(), length);
-        }
     });
     
     dspEngine_->setSignalCallback([this](float strength) {
@@ -94,13 +121,23 @@ MainWindow::MainWindow(std::shared_ptr<Settings> settings, QWidget* parent)
         }, Qt::QueuedConnection);
     });
     
-    dspEngine_->setSpectrumCallback([this](const float* data, size_t length) {
-        // Copy data for thread safety
-        std::vector<float> spectrumData(data, data + length);
-        QMetaObject::invokeMethod(this, [this, spectrumData]() {
-            onSpectrumData(spectrumData.data(), spectrumData.size());
+    dspEngine_->setSpectrumCallback([this](const float*, size_t) {
+        // Only a notification: at most one repaint is queued and it picks up the
+        // newest frame, so a slow GUI drops frames instead of queueing copies
+        if (spectrumPending_.exchange(true)) {
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this]() {
+            spectrumPending_ = false;
+            size_t length = 0;
+            const float* spectrum = dspEngine_->acquireSpectrum(length);
+            if (spectrum) {
+                onSpectrumData(spectrum, length);
+            }
         }, Qt::QueuedConnection);
     });
+    
+    startDevicePipelines();
 }
 
 MainWindow::~MainWindow() {
@@ -130,6 +167,10 @@ void MainWindow::createMenuBar() {
     connect(settingsAction, &QAction::triggered, this, &MainWindow::onSettingsTriggered);
     fileMenu->addAction(settingsAction);
     
+    auto* scheduleAction = new QAction(tr("Schedule &Recordings..."), this);
+    connect(scheduleAction, &QAction::triggered, this, &MainWindow::showScheduleDialog);
+    fileMenu->addAction(scheduleAction);
+    
     fileMenu->addSeparator();
     
     auto* exitAction = new QAction(tr("E&xit"), this);
@@ -184,6 +225,54 @@ void MainWindow::createMenuBar() {
     connect(desertAction, &QAction::triggered, [this]() { onThemeChanged(VintageTheme::DESERT_TAN); });
     connect(blackOpsAction, &QAction::triggered, [this]() { onThemeChanged(VintageTheme::BLACK_OPS); });
     
+    viewMenu->addSeparator();
+    
+    // Panoramic sweep across the current band, replacing the live spectrum
+    sweepAction_ = new QAction(tr("Panoramic &Sweep"), this);
+    sweepAction_->setShortcut(QKeySequence("Ctrl+Shift+P"));
+    sweepAction_->setCheckable(true);
+    connect(sweepAction_, &QAction::toggled, this, &MainWindow::onSweepToggled);
+    viewMenu->addAction(sweepAction_);
+    
+    // Spectrum hold traces
+    auto* peakHoldAction = new QAction(tr("&Peak Hold"), this);
+    peakHoldAction->setCheckable(true);
+    connect(peakHoldAction, &QAction::toggled, [this](bool enabled) {
+        spectrumDisplay_->setPeakHold(enabled);
+    });
+    viewMenu->addAction(peakHoldAction);
+    
+    auto* minHoldAction = new QAction(tr("&Min Hold"), this);
+    minHoldAction->setCheckable(true);
+    connect(minHoldAction, &QAction::toggled, [this](bool enabled) {
+        spectrumDisplay_->setMinHold(enabled);
+    });
+    viewMenu->addAction(minHoldAction);
+    
+    auto* resetHoldsAction = new QAction(tr("&Reset Holds"), this);
+    connect(resetHoldsAction, &QAction::triggered, [this]() { spectrumDisplay_->resetHolds(); });
+    viewMenu->addAction(resetHoldsAction);
+    
+    // GPU rendering; the display drops back to QPainter if GL is unusable
+    auto* openGLAction = new QAction(tr("&OpenGL Spectrum"), this);
+    openGLAction->setCheckable(true);
+    openGLAction->setChecked(settings_->getValue("spectrum_opengl", true).toBool());
+    connect(openGLAction, &QAction::toggled, [this](bool enabled) {
+        spectrumDisplay_->setAccelerated(enabled);
+        settings_->setValue("spectrum_opengl", enabled);
+    });
+    viewMenu->addAction(openGLAction);
+    
+    auto* pipelinesAction = new QAction(tr("Device &Pipelines..."), this);
+    connect(pipelinesAction, &QAction::triggered, this, &MainWindow::showDeviceStats);
+    viewMenu->addAction(pipelinesAction);
+    
+    connect(sweeper_.get(), &SpectrumSweeper::sweepCompleted,
+            this, &MainWindow::onSweepCompleted, Qt::QueuedConnection);
+    connect(sweeper_.get(), &SpectrumSweeper::errorOccurred, this, [this](const QString& error) {
+        updateStatus(error);
+    });
+    
     auto* helpMenu = menuBar()->addMenu(tr("&Help"));
     auto* aboutAction = new QAction(tr("&About"), this);
     connect(aboutAction, &QAction::triggered, this, [this]() {
@@ -447,6 +536,11 @@ void MainWindow::connectSignals() {
     connect(startStopButton_, &QPushButton::clicked,
             this, &MainWindow::onStartStop);
     
+    // Spectrum zoom around the tuned frequency
+    connect(spectrumDisplay_, &SpectrumDisplay::zoomChanged, [this](int decimation) {
+        dspEngine_->setSpectrumZoom(decimation);
+    });
+    
     // Frequency control
     connect(frequencyDial_, &FrequencyDial::frequencyChanged,
             this, &MainWindow::onFrequencyChanged);
@@ -500,6 +594,22 @@ void MainWindow::connectSignals() {
             this, &MainWindow::onMemoryChannelChanged);
     connect(quickChannelCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onQuickChannelSelected);
+    
+    // Scheduled recordings tune the radio like the user would
+    connect(scheduler_.get(), &RecordingScheduler::retuneRequested,
+            this, [this](double frequency, const QString& mode) {
+                int index = modeSelector_->findText(mode);
+                if (index >= 0) {
+                    modeSelector_->setCurrentIndex(index);
+                }
+                onFrequencyChanged(frequency);
+            });
+    connect(scheduler_.get(), &RecordingScheduler::captureStarted,
+            this, [this](const QString& fileName, int jobCount) {
+                updateStatus(tr("Scheduled recording (%1 job(s)): %2").arg(jobCount).arg(fileName));
+            });
+    connect(scheduler_.get(), &RecordingScheduler::conflictDetected,
+            this, &MainWindow::updateStatus);
 }
 
 void MainWindow::applyTheme() {
@@ -537,6 +647,22 @@ void MainWindow::onStartStop() {
     }
 }
 
+// USB streaming as saved by the settings dialog: a preset, or custom values
+static RTLSDRDevice::StreamConfig streamConfigFrom(const Settings& settings) {
+    int preset = settings.getValue("rtl_usb_preset", 1).toInt();
+    RTLSDRDevice::StreamConfig config;
+    if (preset >= 0 && preset <= 2) {
+        config = RTLSDRDevice::getStreamPreset(static_cast<RTLSDRDevice::StreamPreset>(preset));
+    } else {
+        config.bufferCount = static_cast<uint32_t>(settings.getValue("rtl_usb_buffers", 15).toInt());
+        config.bufferLength = static_cast<uint32_t>(settings.getValue("rtl_usb_buffer_kb", 32).toInt()) * 1024;
+        config.priority = static_cast<RTLSDRDevice::StreamPriority>(
+            settings.getValue("rtl_stream_priority", 0).toInt());
+    }
+    config.cpu = settings.getValue("rtl_stream_cpu", -1).toInt();
+    return config;
+}
+
 void MainWindow::startRadio() {
     if (deviceCombo_->count() == 0 || rtlsdr_->getDeviceCount() == 0) {
         QMessageBox::warning(this, tr("No Device"),
@@ -557,27 +683,33 @@ void MainWindow::startRadio() {
         uint32_t sampleRate = settingsDialog_ ? settingsDialog_->getRtlSampleRate() : 2400000;
         rtlsdr_->setSampleRate(sampleRate);
         dspEngine_->setSampleRate(sampleRate);
+        spectrumDisplay_->setSampleRate(sampleRate);
         
         rtlsdr_->setGain(gainKnob_->value() * 10); // Convert to tenths of dB
+        recordingManager_->setIQSource(sampleRate, gainKnob_->value());
         
-        // Apply PPM and bias-T from settings dialog if it exists
-        if (settingsDialog_) {
-            rtlsdr_->setFrequencyCorrection(settingsDialog_->getPpm());
-            if (settingsDialog_->getBiasT()) {
-                rtlsdr_->setBiasT(true);
-            }
+        // Apply PPM, bias-T and USB streaming from the saved settings; the
+        // settings dialog is only created once opened
+        rtlsdr_->setFrequencyCorrection(settings_->getValue("rtl_ppm", 0).toInt());
+        if (settings_->getValue("rtl_bias_t", false).toBool()) {
+            rtlsdr_->setBiasT(true);
         }
+        rtlsdr_->setStreamConfig(streamConfigFrom(*settings_));
         
         // Set RTL-SDR data callback
         rtlsdr_->setDataCallback([this](const uint8_t* data, size_t length) {
+            // A running sweep owns the tuner; the demodulator would only hear hops
+            if (sweeper_->isRunning()) {
+                sweeper_->processIQ(data, length);
+                return;
+            }
+            
             dspEngine_->processIQ(data, length);
             
-            // Send IQ data to recording manager if recording IQ
+            // Send IQ data to recording manager if recording IQ; it checks the
+            // recording type itself and only queues the block for its writer
             if (recordingManager_->isRecording()) {
-                auto info = recordingManager_->getCurrentRecording();
-                if (info.type == RecordingManager::RecordingType::IQ) {
-                    recordingManager_->writeIQData(data, length);
-                }
+                recordingManager_->writeIQData(data, length);
             }
         });
         
@@ -686,6 +818,10 @@ void MainWindow::startRadio() {
 }
 
 void MainWindow::stopRadio() {
+    if (sweeper_->isRunning()) {
+        sweepAction_->setChecked(false);
+    }
+    
     if (rtlsdr_->isStreaming()) {
         rtlsdr_->stopStreaming();
     }
@@ -750,10 +886,11 @@ void MainWindow::onFrequencyChanged(double frequency) {
     // Update antenna recommendation
     antennaWidget_->updateFrequency(frequency);
     
-    // Update recording widget
+    // Update recording widget; IQ recordings start a new SigMF capture
     if (recordingWidget_) {
         recordingWidget_->setFrequency(frequency);
     }
+    recordingManager_->noteFrequencyChange(frequency);
     
     // Update decoder widget
     if (decoderWidget_) {
@@ -834,6 +971,7 @@ void MainWindow::onModeChanged(int mode) {
     if (recordingWidget_) {
         recordingWidget_->setMode(modeSelector_->currentText());
     }
+    recordingManager_->noteModeChange(modeSelector_->currentText());
     
     // Update decoder widget
     if (decoderWidget_) {
@@ -854,6 +992,7 @@ void MainWindow::onSquelchChanged(double value) {
 void MainWindow::onGainChanged(double value) {
     if (rtlsdr_->isOpen()) {
         rtlsdr_->setGain(value * 10); // Convert to tenths of dB
+        recordingManager_->setIQSource(rtlsdr_->getSampleRate(), value);
     }
 }
 
@@ -998,6 +1137,8 @@ void MainWindow::saveSettings() {
     QString memoryFile = settings_->getConfigPath() + "/memory_channels.json";
     memoryManager_->saveToFile(memoryFile);
     
+    DSPEngine::exportFFTWisdom(fftWisdomPath().toStdString());
+    
     settings_->save();
 }
 
@@ -1021,12 +1162,23 @@ void MainWindow::loadSettings() {
     
     // Dynamic bandwidth will be loaded by the settings dialog
     
+    applySpectrumSettings();
+    applySquelchSettings();
+    recordingManager_->setDirectIO(settings_->getValue("recording_direct_io", false).toBool());
+    recordingManager_->noteModeChange(modeSelector_->currentText());
+    recordingManager_->setOpusBitrate(settings_->getValue("recording_opus_bitrate",
+                                                          OggOpusEncoder::DEFAULT_BITRATE).toInt());
+    spectrumDisplay_->setAccelerated(settings_->getValue("spectrum_opengl", true).toBool());
+    
     // Load memory channels
     QString memoryFile = settings_->getConfigPath() + "/memory_channels.json";
     if (QFile::exists(memoryFile)) {
         memoryManager_->loadFromFile(memoryFile);
         updateMemoryChannelsForScanner();
     }
+    
+    // Recording schedule; starts its timer once loaded
+    scheduler_->load(settings_->getConfigPath() + "/schedule.json");
 }
 
 void MainWindow::closeEvent(QCloseEvent* event) {
@@ -1093,6 +1245,17 @@ void MainWindow::createSettingsDialog() {
             this, &MainWindow::onPpmChanged);
     connect(settingsDialog_, &SettingsDialog::rtlSampleRateChanged,
             this, &MainWindow::onRtlSampleRateChanged);
+    connect(settingsDialog_, &SettingsDialog::spectrumSettingsChanged,
+            this, &MainWindow::onSpectrumSettingsChanged);
+    connect(settingsDialog_, &SettingsDialog::squelchSettingsChanged,
+            this, &MainWindow::applySquelchSettings);
+    connect(settingsDialog_, &SettingsDialog::triggerSettingsChanged,
+            [this]() {
+                // Restart with the new settings; the file in progress is closed
+                if (recordingManager_->isTriggeredRecording()) {
+                    onTriggeredRecordingToggled(true);
+                }
+            });
     connect(settingsDialog_, &SettingsDialog::resetAllClicked,
             this, &MainWindow::onResetAllClicked);
 }
@@ -1152,11 +1315,324 @@ void MainWindow::onRtlSampleRateChanged(int index) {
         if (rtlsdr_->isOpen()) {
             rtlsdr_->setSampleRate(rtlRates[index]);
             dspEngine_->setSampleRate(rtlRates[index]);
+            spectrumDisplay_->setSampleRate(rtlRates[index]);
+            recordingManager_->setIQSource(rtlRates[index], gainKnob_->value());
             updateStatus(tr("RTL-SDR sample rate set to %1 MHz").arg(rtlRates[index] / 1e6, 0, 'f', 1));
         }
     }
 }
 
+void MainWindow::onSpectrumSettingsChanged() {
+    applySpectrumSettings();
+    updateStatus(tr("Spectrum: %1 point FFT").arg(dspEngine_->getSpectrumFFTSize()));
+}
+
+void MainWindow::applySpectrumSettings() {
+    const float overlaps[] = {0.0f, 0.25f, 0.5f, 0.75f};
+    int sizeIndex = qBound(0, settings_->getValue("spectrum_fft_size", 2).toInt(), 7);
+    int window = qBound(0, settings_->getValue("spectrum_window", 0).toInt(), 2);
+    int overlapIndex = qBound(0, settings_->getValue("spectrum_overlap", 2).toInt(), 3);
+    
+    dspEngine_->setSpectrumConfig(512u << sizeIndex, static_cast<DSPEngine::SpectrumWindow>(window),
+                                  overlaps[overlapIndex]);
+    
+    // Keep whatever was just measured for the next start
+    DSPEngine::exportFFTWisdom(fftWisdomPath().toStdString());
+}
+
+void MainWindow::applySquelchSettings() {
+    int mode = qBound(0, settings_->getValue("squelch_mode", 0).toInt(), 2);
+    dspEngine_->setSquelchMode(static_cast<Squelch::Mode>(mode),
+                               settings_->getValue("squelch_hysteresis", 3).toFloat(),
+                               settings_->getValue("squelch_hang", 250).toFloat());
+}
+
+static RecordingManager::TriggerSettings triggerSettingsFrom(const Settings& settings) {
+    RecordingManager::TriggerSettings trigger;
+    trigger.source = settings.getValue("trigger_source", 0).toInt() == 1
+                     ? RecordingManager::TriggerSource::CTCSS
+                     : RecordingManager::TriggerSource::SQUELCH;
+    trigger.prerollSeconds = settings.getValue("trigger_preroll", 2).toDouble();
+    trigger.maxSeconds = settings.getValue("trigger_max_seconds", 300).toInt();
+    trigger.maxBytes = settings.getValue("trigger_max_mb", 0).toLongLong() * 1024 * 1024;
+    trigger.format = settings.getValue("trigger_format", 0).toInt() == 1 && OggOpusEncoder::isAvailable()
+                     ? RecordingManager::Format::OPUS
+                     : RecordingManager::Format::WAV;
+    return trigger;
+}
+
+void MainWindow::onTriggeredRecordingToggled(bool enabled) {
+    recordingManager_->stopTriggeredRecording();
+    if (!enabled) {
+        return;
+    }
+    
+    recordingManager_->startTriggeredRecording(triggerSettingsFrom(*settings_), currentFrequency_);
+}
+
+void MainWindow::startDevicePipelines() {
+    // Dongles beyond the one on the front panel, listed in devices.json:
+    // {"pipelines": [{"name": "Airband", "serial": "00000002",
+    //   "frequency": 118100000, "mode": "AM", "gain": 40, "squelch": -30,
+    //   "format": "opus", "usb_preset": "robust", "stream_cpu": 2, "dsp_cpu": 3}, ...]}
+    // An "adsb": true pipeline defaults to the decoder's 2 MHz sample rate;
+    // DeviceManager refuses any other.
+    QFile file(settings_->getConfigPath() + "/devices.json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QJsonArray pipelines = QJsonDocument::fromJson(file.readAll()).object()["pipelines"].toArray();
+    
+    for (const auto& value : pipelines) {
+        QJsonObject json = value.toObject();
+        QString name = json["name"].toString(json["serial"].toString());
+        QString mode = json["mode"].toString("FM-Narrow");
+        
+        DeviceManager::PipelineConfig config;
+        config.name = name.toStdString();
+        config.serial = json["serial"].toString().toStdString();
+        config.frequency = static_cast<uint32_t>(json["frequency"].toDouble());
+        config.adsb = json["adsb"].toBool();
+        config.sampleRate = static_cast<uint32_t>(json["sample_rate"].toDouble(
+            config.adsb ? ADSBDecoder::ADSB_SAMPLE_RATE : 2400000));
+        config.gain = static_cast<int>(json["gain"].toDouble(25.0) * 10);
+        config.ppm = json["ppm"].toInt();
+        config.biasT = json["bias_t"].toBool();
+        config.mode = static_cast<DSPEngine::Mode>(std::max(0, modeSelector_->findText(mode)));
+        config.squelch = static_cast<float>(json["squelch"].toDouble(-20.0));
+        QString preset = json["usb_preset"].toString("balanced");
+        config.preset = preset == "low_latency" ? RTLSDRDevice::StreamPreset::LOW_LATENCY
+                      : preset == "robust" ? RTLSDRDevice::StreamPreset::ROBUST
+                      : RTLSDRDevice::StreamPreset::BALANCED;
+        config.streamCpu = json["stream_cpu"].toInt(-1);
+        config.dspCpu = json["dsp_cpu"].toInt(-1);
+        
+        int id = deviceManager_->addPipeline(config);
+        if (id < 0) {
+            updateStatus(QString::fromStdString(deviceManager_->getLastError()));
+            continue;
+        }
+        DSPEngine* engine = deviceManager_->getEngine(id);
+        
+        // An ADS-B pipeline feeds the decoder panel in place of the main
+        // receiver's decoder, and the panel's switch now runs it
+        if (config.adsb) {
+            decoderWidget_->setADSBDecoder(engine->getADSBDecoder());
+            adsbEngine_ = engine;
+            continue;
+        }
+        
+        // The others have no speaker; they log each transmission to a
+        // directory of their own, catalogued with the main recordings so
+        // the LOG search finds them too
+        if (!json["record"].toBool(true)) {
+            continue;
+        }
+        auto recorder = std::make_unique<RecordingManager>();
+        recorder->shareCatalog(&recordingManager_->getCatalog());
+        recorder->setRecordingDirectory(recordingManager_->getRecordingDirectory() + "/" + name);
+        recorder->noteModeChange(mode);
+        recorder->noteFrequencyChange(config.frequency);
+        recorder->setOpusBitrate(settings_->getValue("recording_opus_bitrate",
+                                                     OggOpusEncoder::DEFAULT_BITRATE).toInt());
+        
+        RecordingManager* output = recorder.get();
+        engine->setAudioCallback([output, engine](const float* data, size_t length) {
+            output->writeAudioData(data, length);
+            output->updateTrigger(!engine->isSquelched(), 0.0f);
+        });
+        
+        // No CTCSS decoder runs here, so the squelch alone triggers
+        RecordingManager::TriggerSettings trigger = triggerSettingsFrom(*settings_);
+        trigger.source = RecordingManager::TriggerSource::SQUELCH;
+        if (json.contains("format") && OggOpusEncoder::isAvailable()) {
+            trigger.format = json["format"].toString() == "opus" ? RecordingManager::Format::OPUS
+                                                                 : RecordingManager::Format::WAV;
+        }
+        output->startTriggeredRecording(trigger, config.frequency);
+        pipelineRecorders_.push_back(std::move(recorder));
+    }
+    
+    if (!deviceManager_->startAll()) {
+        updateStatus(QString::fromStdString(deviceManager_->getLastError()));
+    }
+}
+
+void MainWindow::showDeviceStats() {
+    // Callback timing for tuning the USB buffering: a jitter or late count
+    // that keeps growing means the transfers are too short for this machine
+    auto timing = [this](const RTLSDRDevice::StreamStats& stream) {
+        return tr("    USB callback every %1 ms (expected %2), jitter %3 ms, max %4 ms, %5 late%6\n")
+               .arg(stream.meanIntervalMs, 0, 'f', 2)
+               .arg(stream.expectedIntervalMs, 0, 'f', 2)
+               .arg(stream.jitterMs, 0, 'f', 2)
+               .arg(stream.maxIntervalMs, 0, 'f', 1)
+               .arg(stream.lateCallbacks)
+               .arg(stream.priorityApplied ? QString() : tr(", priority not raised"));
+    };
+    
+    QString text;
+    if (rtlsdr_->isStreaming()) {
+        text += tr("Main receiver: %1 MB received, %2 samples dropped\n")
+                .arg(rtlsdr_->getBytesReceived() / (1024 * 1024))
+                .arg(dspEngine_->getDroppedSamples());
+        text += timing(rtlsdr_->getStreamStats());
+    }
+    
+    DeviceManager::Stats stats = deviceManager_->getStats();
+    if (stats.pipelines.empty()) {
+        text += tr("\nNo extra devices configured.\n\nList them in %1")
+                .arg(settings_->getConfigPath() + "/devices.json");
+        QMessageBox::information(this, tr("Device Pipelines"), text.trimmed());
+        return;
+    }
+    
+    for (const auto& pipeline : stats.pipelines) {
+        text += tr("%1 (SN %2): %3, %4 MB received, %5 samples dropped, %6 dB%7\n")
+                .arg(QString::fromStdString(pipeline.name))
+                .arg(QString::fromStdString(pipeline.serial))
+                .arg(pipeline.streaming ? tr("streaming") : tr("stopped"))
+                .arg(pipeline.bytesReceived / (1024 * 1024))
+                .arg(pipeline.droppedSamples)
+                .arg(pipeline.signalStrength, 0, 'f', 1)
+                .arg(pipeline.squelched ? QString() : tr(", open"));
+        if (pipeline.streaming) {
+            text += timing(pipeline.stream);
+        }
+    }
+    text += tr("\n%1 of %2 streaming, %3 MB received, %4 samples dropped")
+            .arg(stats.streaming)
+            .arg(stats.pipelines.size())
+            .arg(stats.bytesReceived / (1024 * 1024))
+            .arg(stats.droppedSamples);
+    
+    QMessageBox::information(this, tr("Device Pipelines"), text);
+}
+
+void MainWindow::showScheduleDialog() {
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Scheduled Recordings"));
+    dialog.resize(640, 480);
+    auto* layout = new QGridLayout(&dialog);
+    
+    auto* jobList = new QListWidget(&dialog);
+    auto* removeButton = new QPushButton(tr("REMOVE"), &dialog);
+    
+    // New job, prefilled with the current channel from a minute from now
+    auto* nameEdit = new QLineEdit(&dialog);
+    auto* frequencySpin = new QDoubleSpinBox(&dialog);
+    frequencySpin->setRange(0.5, 2000.0);
+    frequencySpin->setDecimals(4);
+    frequencySpin->setSuffix(" MHz");
+    frequencySpin->setValue(currentFrequency_ / 1e6);
+    
+    auto* bandwidthSpin = new QDoubleSpinBox(&dialog);
+    bandwidthSpin->setRange(1.0, 250.0);
+    bandwidthSpin->setDecimals(1);
+    bandwidthSpin->setSuffix(" kHz");
+    bandwidthSpin->setValue(12.5);
+    
+    auto* modeCombo = new QComboBox(&dialog);
+    for (int i = 0; i < modeSelector_->count(); i++) {
+        modeCombo->addItem(modeSelector_->itemText(i));
+    }
+    modeCombo->setCurrentIndex(modeSelector_->currentIndex());
+    
+    // Jobs sharing an IQ capture with others always log WAV
+    auto* formatCombo = new QComboBox(&dialog);
+    formatCombo->addItem(tr("WAV"), static_cast<int>(RecordingManager::Format::WAV));
+    formatCombo->addItem(tr("FLAC"), static_cast<int>(RecordingManager::Format::FLAC));
+#ifdef HAS_OPUS
+    formatCombo->addItem(tr("Opus"), static_cast<int>(RecordingManager::Format::OPUS));
+#endif
+    formatCombo->addItem(tr("IQ WAV"), static_cast<int>(RecordingManager::Format::IQ_WAV));
+    formatCombo->addItem(tr("IQ FLAC"), static_cast<int>(RecordingManager::Format::IQ_FLAC));
+    
+    auto* startEdit = new QDateTimeEdit(QDateTime::currentDateTime().addSecs(60), &dialog);
+    startEdit->setCalendarPopup(true);
+    auto* durationSpin = new QSpinBox(&dialog);
+    durationSpin->setRange(1, 24 * 60);
+    durationSpin->setSuffix(tr(" min"));
+    durationSpin->setValue(30);
+    
+    auto* repeatCombo = new QComboBox(&dialog);
+    repeatCombo->addItem(tr("Once"), static_cast<int>(RecordingScheduler::Repeat::ONCE));
+    repeatCombo->addItem(tr("Daily"), static_cast<int>(RecordingScheduler::Repeat::DAILY));
+    repeatCombo->addItem(tr("Weekdays"), static_cast<int>(RecordingScheduler::Repeat::WEEKDAYS));
+    repeatCombo->addItem(tr("Weekly"), static_cast<int>(RecordingScheduler::Repeat::WEEKLY));
+    
+    auto* addButton = new QPushButton(tr("ADD"), &dialog);
+    
+    layout->addWidget(jobList, 0, 0, 1, 4);
+    layout->addWidget(removeButton, 1, 3);
+    layout->addWidget(new QLabel(tr("Name:")), 2, 0);
+    layout->addWidget(nameEdit, 2, 1, 1, 3);
+    layout->addWidget(new QLabel(tr("Frequency:")), 3, 0);
+    layout->addWidget(frequencySpin, 3, 1);
+    layout->addWidget(new QLabel(tr("Bandwidth:")), 3, 2);
+    layout->addWidget(bandwidthSpin, 3, 3);
+    layout->addWidget(new QLabel(tr("Mode:")), 4, 0);
+    layout->addWidget(modeCombo, 4, 1);
+    layout->addWidget(new QLabel(tr("Format:")), 4, 2);
+    layout->addWidget(formatCombo, 4, 3);
+    layout->addWidget(new QLabel(tr("Start:")), 5, 0);
+    layout->addWidget(startEdit, 5, 1);
+    layout->addWidget(new QLabel(tr("Duration:")), 5, 2);
+    layout->addWidget(durationSpin, 5, 3);
+    layout->addWidget(new QLabel(tr("Repeat:")), 6, 0);
+    layout->addWidget(repeatCombo, 6, 1);
+    layout->addWidget(addButton, 6, 3);
+    
+    auto refresh = [this, jobList, repeatCombo]() {
+        jobList->clear();
+        for (const RecordingScheduler::Job& job : scheduler_->getJobs()) {
+            auto* item = new QListWidgetItem(tr("%1  %2 MHz %3, %4 for %5 min, %6")
+                                             .arg(job.name)
+                                             .arg(job.frequency / 1e6, 0, 'f', 4)
+                                             .arg(job.mode)
+                                             .arg(job.start.toString("yyyy-MM-dd HH:mm"))
+                                             .arg(job.durationSeconds / 60)
+                                             .arg(repeatCombo->itemText(
+                                                  repeatCombo->findData(static_cast<int>(job.repeat)))),
+                                             jobList);
+            item->setData(Qt::UserRole, job.id);
+        }
+    };
+    
+    connect(addButton, &QPushButton::clicked, &dialog, [=]() {
+        RecordingScheduler::Job job;
+        job.id = 0;
+        job.name = nameEdit->text().trimmed();
+        if (job.name.isEmpty()) {
+            job.name = QString("%1MHz").arg(frequencySpin->value(), 0, 'f', 3);
+        }
+        job.frequency = frequencySpin->value() * 1e6;
+        job.bandwidth = bandwidthSpin->value() * 1e3;
+        job.mode = modeCombo->currentText();
+        job.format = static_cast<RecordingManager::Format>(formatCombo->currentData().toInt());
+        job.start = startEdit->dateTime();
+        job.durationSeconds = durationSpin->value() * 60;
+        job.repeat = static_cast<RecordingScheduler::Repeat>(repeatCombo->currentData().toInt());
+        job.enabled = true;
+        scheduler_->addJob(job);
+        refresh();
+    });
+    connect(removeButton, &QPushButton::clicked, &dialog, [=]() {
+        QListWidgetItem* item = jobList->currentItem();
+        if (item) {
+            scheduler_->removeJob(item->data(Qt::UserRole).toInt());
+            refresh();
+        }
+    });
+    
+    refresh();
+    dialog.exec();
+}
+
+QString MainWindow::fftWisdomPath() const {
+    return settings_->getDataPath() + "/fftw_wisdom";
+}
+
 void MainWindow::createMemoryPanel() {
     auto* memoryGroup = new QGroupBox(tr("MEMORY CHANNELS"));
     memoryGroup->setObjectName("memoryPanel");
@@ -1334,6 +1810,8 @@ void MainWindow::createRecordingPanel() {
     recordingWidget_->setRecordingManager(recordingManager_.get());
     recordingWidget_->setFrequency(currentFrequency_);
     recordingWidget_->setMode(modeSelector_->currentText());
+    connect(recordingWidget_, &RecordingWidget::triggeredRecordingToggled,
+            this, &MainWindow::onTriggeredRecordingToggled);
     
     recordingLayout->addWidget(recordingWidget_);
     
@@ -1366,6 +1844,62 @@ void MainWindow::onScannerFrequencyChanged(double frequency) {
     onFrequencyChanged(frequency);
 }
 
+void MainWindow::onSweepToggled(bool enabled) {
+    if (!enabled) {
+        sweeper_->stop();
+        spectrumDisplay_->setFrequencyAxis(0.0, 0.0);
+        spectrumDisplay_->clear();
+        
+        // Hand the tuner back to the receiver
+        if (rtlsdr_->isOpen()) {
+            rtlsdr_->setCenterFrequency(currentFrequency_);
+        }
+        updateStatus(tr("Sweep stopped"));
+        return;
+    }
+    
+    if (!isRunning_) {
+        sweepAction_->setChecked(false);
+        updateStatus(tr("Start the radio before sweeping"));
+        return;
+    }
+    
+    if (scanner_->isScanning()) {
+        scanner_->stopScan();
+    }
+    
+    const auto& band = scanner_->getScanParameters();
+    SpectrumSweeper::SweepParameters params;
+    params.startFreq = band.startFreq;
+    params.endFreq = band.endFreq;
+    params.sampleRate = rtlsdr_->getSampleRate();
+    
+    QString sweepDir = settings_->getDataPath() + "/sweeps";
+    QDir().mkpath(sweepDir);
+    params.logFormat = SpectrumSweeper::LogFormat::CSV;
+    params.logPath = sweepDir + "/sweep_" +
+        QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".csv";
+    
+    sweeper_->setRTLSDR(rtlsdr_.get());
+    if (!sweeper_->start(params)) {
+        sweepAction_->setChecked(false);
+        return;
+    }
+    
+    updateStatus(tr("Sweeping %1 - %2 MHz")
+                 .arg(params.startFreq / 1e6, 0, 'f', 3)
+                 .arg(params.endFreq / 1e6, 0, 'f', 3));
+}
+
+void MainWindow::onSweepCompleted(const std::vector<float>& power, double startFreq,
+                                  double binWidth) {
+    if (sweeper_->isRunning()) {
+        // The stitched hops span the whole band, not one capture
+        spectrumDisplay_->setFrequencyAxis(startFreq, startFreq + binWidth * power.size());
+        spectrumDisplay_->updateSpectrum(power.data(), power.size());
+    }
+}
+
 void MainWindow::updateMemoryChannelsForScanner() {
     std::vector<Scanner::Channel> scannerChannels;
     
@@ -1401,6 +1935,10 @@ void MainWindow::createDecoderPanel() {
     decoderWidget_->setRDSDecoder(dspEngine_->getRDSDecoder());
     decoderWidget_->setADSBDecoder(dspEngine_->getADSBDecoder());
     
+    // Station names go into the recording catalog
+    connect(dspEngine_->getRDSDecoder(), &RDSDecoder::programServiceChanged,
+            recordingManager_.get(), &RecordingManager::noteProgramService);
+    
     // Set initial frequency and mode
     decoderWidget_->setFrequency(currentFrequency_);
     decoderWidget_->setMode(modeSelector_->currentText());
@@ -1422,8 +1960,9 @@ void MainWindow::createDecoderPanel() {
     
     connect(decoderWidget_, &DecoderWidget::adsbEnableChanged,
             [this](bool enabled) {
-                if (dspEngine_) {
-                    dspEngine_->enableADSB(enabled);
+                DSPEngine* engine = adsbEngine_ ? adsbEngine_ : dspEngine_.get();
+                if (engine) {
+                    engine->enableADSB(enabled);
                 }
             });
     
@@ -4,6 +4,7 @@
 #include <QMainWindow>
 #include <memory>
 #include <atomic>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 class QLabel;
@@ -11,6 +12,7 @@ class QComboBox;
 class QPushButton;
 class QGroupBox;
 class QCheckBox;
+class QAction;
 QT_END_NAMESPACE
 
 class Settings;
@@ -27,8 +29,11 @@ class QSpinBox;
 class AntennaWidget;
 class RecordingWidget;
 class RecordingManager;
+class RecordingScheduler;
+class DeviceManager;
 class Scanner;
 class ScannerWidget;
+class SpectrumSweeper;
 class DecoderWidget;
 
 class MainWindow : public QMainWindow {
@@ -73,6 +78,8 @@ private slots:
     void onResetAllClicked();
     void onPpmChanged(int value);
     void onRtlSampleRateChanged(int index);
+    void onSpectrumSettingsChanged();
+    void onTriggeredRecordingToggled(bool enabled);
     
     // DSP callbacks
     void onSignalStrengthChanged(float strength);
@@ -92,6 +99,10 @@ private slots:
     void onScannerFrequencyChanged(double frequency);
     void updateMemoryChannelsForScanner();
     
+    // Panoramic sweep
+    void onSweepToggled(bool enabled);
+    void onSweepCompleted(const std::vector<float>& power, double startFreq, double binWidth);
+    
     // Decoder control
     void updateDecoderState();
     
@@ -104,7 +115,14 @@ private:
     std::unique_ptr<VintageEqualizer> equalizer_;
     std::unique_ptr<MemoryChannelManager> memoryManager_;
     std::unique_ptr<RecordingManager> recordingManager_;
+    std::unique_ptr<RecordingScheduler> scheduler_;
     std::unique_ptr<Scanner> scanner_;
+    std::unique_ptr<SpectrumSweeper> sweeper_;
+    
+    // Further dongles, each a pipeline of its own; recorders before the
+    // manager so the pipelines feeding them stop first
+    std::vector<std::unique_ptr<RecordingManager>> pipelineRecorders_;
+    std::unique_ptr<DeviceManager> deviceManager_;
     
     // UI components
     FrequencyDial* frequencyDial_;
@@ -133,6 +151,7 @@ private:
     // Buttons
     QPushButton* startStopButton_;
     QPushButton* resetEQButton_;
+    QAction* sweepAction_;
     
     // Memory channel controls
     QComboBox* memoryBankCombo_;
@@ -149,7 +168,9 @@ private:
     RecordingWidget* recordingWidget_;
     ScannerWidget* scannerWidget_;
     DecoderWidget* decoderWidget_;
+    DSPEngine* adsbEngine_;             // an ADS-B pipeline's engine, else the main one feeds the panel
     std::atomic<bool> isRunning_;
+    std::atomic<bool> spectrumPending_;     // a spectrum repaint is already queued
     
     // Current state
     double currentFrequency_;
@@ -174,6 +195,9 @@ private:
     
     // Device methods
     void initializeDevices();
+    void startDevicePipelines();
+    void showDeviceStats();
+    void showScheduleDialog();
     void startRadio();
     void stopRadio();
     
@@ -184,6 +208,9 @@ private:
     void applyOptimalGain(double frequency);
     void saveSettings();
     void loadSettings();
+    void applySpectrumSettings();
+    void applySquelchSettings();
+    QString fftWisdomPath() const;
     void createSettingsDialog();
 };
 
@@ -8,6 +8,16 @@
 #include <QMessageBox>
 #include <QDateTime>
 #include <QInputDialog>
+#include <QSignalBlocker>
+#include <QDialog>
+#include <QGridLayout>
+#include <QDoubleSpinBox>
+#include <QDateTimeEdit>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QElapsedTimer>
+#include <cmath>
 
 RecordingWidget::RecordingWidget(QWidget* parent)
     : QWidget(parent)
@@ -30,7 +40,10 @@ RecordingWidget::RecordingWidget(QWidget* parent)
     
     // Format selector
     formatCombo_ = new QComboBox(this);
-    formatCombo_->addItems({"WAV", "FLAC", "MP3", "IQ"});
+    formatCombo_->addItems({"WAV", "FLAC", "MP3", "IQ", "IQ FLAC"});
+#ifdef HAS_OPUS
+    formatCombo_->addItem("OPUS");
+#endif
     formatCombo_->setToolTip(tr("Recording format"));
     formatCombo_->setFixedWidth(80);
     layout->addWidget(formatCombo_);
@@ -60,6 +73,26 @@ RecordingWidget::RecordingWidget(QWidget* parent)
     connect(saveTimeShiftButton_, &QPushButton::clicked, this, &RecordingWidget::onSaveTimeShiftClicked);
     layout->addWidget(saveTimeShiftButton_);
     
+    replayButton_ = new QPushButton(tr("REPLAY"), this);
+    replayButton_->setCheckable(true);
+    replayButton_->setEnabled(false);
+    replayButton_->setToolTip(tr("Listen back from the time-shift buffer; release to return to live"));
+    connect(replayButton_, &QPushButton::toggled, this, &RecordingWidget::onReplayToggled);
+    layout->addWidget(replayButton_);
+    
+    // Squelch-triggered recording
+    autoButton_ = new QPushButton(tr("AUTO"), this);
+    autoButton_->setCheckable(true);
+    autoButton_->setToolTip(tr("Record each transmission to its own file when the squelch opens"));
+    connect(autoButton_, &QPushButton::toggled, this, &RecordingWidget::onAutoToggled);
+    layout->addWidget(autoButton_);
+    
+    // Recording catalog search
+    logButton_ = new QPushButton(tr("LOG"), this);
+    logButton_->setToolTip(tr("Search the recordings by frequency and time"));
+    connect(logButton_, &QPushButton::clicked, this, &RecordingWidget::onLogClicked);
+    layout->addWidget(logButton_);
+    
     // Set initial state
     updateRecordButton();
     
@@ -108,6 +141,12 @@ void RecordingWidget::setRecordingManager(RecordingManager* manager) {
                 this, &RecordingWidget::onRecordingProgress);
         connect(recordingManager_, &RecordingManager::recordingError,
                 this, &RecordingWidget::onRecordingError);
+        connect(recordingManager_, &RecordingManager::recordingOverrun,
+                this, &RecordingWidget::onRecordingOverrun);
+        connect(recordingManager_, &RecordingManager::timeShiftSaved,
+                this, &RecordingWidget::onTimeShiftSaved);
+        connect(recordingManager_, &RecordingManager::transmissionRecorded,
+                this, &RecordingWidget::onTransmissionRecorded);
     }
 }
 
@@ -131,6 +170,11 @@ void RecordingWidget::onRecordButtonClicked() {
                 format = RecordingManager::Format::IQ_WAV;
                 type = RecordingManager::RecordingType::IQ;
                 break;
+            case 4:
+                format = RecordingManager::Format::IQ_FLAC;
+                type = RecordingManager::RecordingType::IQ;
+                break;
+            case 5: format = RecordingManager::Format::OPUS; break;
         }
         
         if (recordingManager_->startRecording(fileName, format, type,
@@ -152,8 +196,12 @@ void RecordingWidget::onRecordButtonClicked() {
 
 void RecordingWidget::onTimeShiftToggled(bool checked) {
     if (recordingManager_) {
+        if (!checked) {
+            replayButton_->setChecked(false);
+        }
         recordingManager_->enableTimeShift(checked);
         saveTimeShiftButton_->setEnabled(checked);
+        replayButton_->setEnabled(checked);
         
         if (checked) {
             statusLabel_->setText(tr("Time-shift buffer enabled"));
@@ -179,9 +227,157 @@ void RecordingWidget::onSaveTimeShiftClicked() {
     
     QString fileName = generateFileName() + "_timeshift";
     if (recordingManager_->saveTimeShiftBuffer(fileName, seconds)) {
-        QMessageBox::information(this, tr("Time-Shift Saved"),
-                               tr("Saved %1 seconds to %2.wav").arg(seconds).arg(fileName));
+        saveTimeShiftButton_->setEnabled(false);
+        statusLabel_->setText(tr("Saving time-shift buffer..."));
+    }
+}
+
+void RecordingWidget::onTimeShiftSaved(const QString& fileName, qint64 bytes) {
+    saveTimeShiftButton_->setEnabled(timeShiftCheck_->isChecked());
+    statusLabel_->setText(tr("Time-shift buffer saved"));
+    QMessageBox::information(this, tr("Time-Shift Saved"),
+                           tr("Saved %1 seconds to %2").arg(bytes / (2 * 48000)).arg(fileName));
+}
+
+void RecordingWidget::onReplayToggled(bool checked) {
+    if (!recordingManager_) {
+        return;
+    }
+    
+    if (!checked) {
+        recordingManager_->stopTimeShiftPlayback();
+        statusLabel_->setText(tr("Live"));
+        return;
+    }
+    
+    bool ok;
+    int seconds = QInputDialog::getInt(this, tr("Replay Time-Shift Buffer"),
+                                      tr("Seconds back (buffered: %1):")
+                                      .arg(recordingManager_->getTimeShiftBufferSeconds()),
+                                      30, 1, 1800, 1, &ok);
+    if (!ok || !recordingManager_->startTimeShiftPlayback(seconds)) {
+        QSignalBlocker blocker(replayButton_);
+        replayButton_->setChecked(false);
+        return;
+    }
+    
+    statusLabel_->setText(tr("Replaying %1 s behind live").arg(recordingManager_->getTimeShiftDelaySeconds()));
+}
+
+void RecordingWidget::onAutoToggled(bool checked) {
+    // Transmissions are cut from the time-shift buffer, so it stays on meanwhile
+    if (checked) {
+        timeShiftCheck_->setChecked(true);
+    }
+    timeShiftCheck_->setEnabled(!checked);
+    
+    statusLabel_->setText(checked ? tr("Waiting for a transmission...") : tr("Ready"));
+    emit triggeredRecordingToggled(checked);
+}
+
+void RecordingWidget::onTransmissionRecorded(const QString& fileName, qint64 bytes, double seconds) {
+    Q_UNUSED(bytes);
+    statusLabel_->setText(tr("Saved %1 (%2 s)").arg(fileName).arg(seconds, 0, 'f', 1));
+}
+
+void RecordingWidget::onLogClicked() {
+    if (!recordingManager_) {
+        return;
+    }
+    RecordingCatalog& catalog = recordingManager_->getCatalog();
+    
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Recording Log"));
+    dialog.resize(760, 480);
+    auto* layout = new QGridLayout(&dialog);
+    
+    // Frequency range in MHz, 0 for any; defaults to the current channel's MHz
+    auto* lowSpin = new QDoubleSpinBox(&dialog);
+    auto* highSpin = new QDoubleSpinBox(&dialog);
+    for (QDoubleSpinBox* spin : {lowSpin, highSpin}) {
+        spin->setRange(0.0, 2000.0);
+        spin->setDecimals(4);
+        spin->setSuffix(" MHz");
+        spin->setSpecialValueText(tr("Any"));
     }
+    lowSpin->setValue(std::floor(currentFrequency_ / 1e6));
+    highSpin->setValue(std::floor(currentFrequency_ / 1e6) + 1.0);
+    
+    // Since yesterday evening by default
+    auto* fromEdit = new QDateTimeEdit(QDateTime(QDate::currentDate().addDays(-1), QTime(18, 0)), &dialog);
+    auto* toEdit = new QDateTimeEdit(QDateTime::currentDateTime().addSecs(3600), &dialog);
+    fromEdit->setCalendarPopup(true);
+    toEdit->setCalendarPopup(true);
+    
+    auto* toneCheck = new QCheckBox(tr("CTCSS only"), &dialog);
+    auto* searchButton = new QPushButton(tr("SEARCH"), &dialog);
+    auto* exportButton = new QPushButton(tr("EXPORT"), &dialog);
+    auto* resultLabel = new QLabel(&dialog);
+    
+    auto* table = new QTableWidget(0, 7, &dialog);
+    table->setHorizontalHeaderLabels({tr("Start"), tr("Duration"), tr("Frequency"), tr("Mode"),
+                                      tr("CTCSS"), tr("Station"), tr("File")});
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    
+    layout->addWidget(new QLabel(tr("Frequency:")), 0, 0);
+    layout->addWidget(lowSpin, 0, 1);
+    layout->addWidget(highSpin, 0, 2);
+    layout->addWidget(toneCheck, 0, 3);
+    layout->addWidget(new QLabel(tr("Time:")), 1, 0);
+    layout->addWidget(fromEdit, 1, 1);
+    layout->addWidget(toEdit, 1, 2);
+    layout->addWidget(searchButton, 1, 3);
+    layout->addWidget(table, 2, 0, 1, 4);
+    layout->addWidget(resultLabel, 3, 0, 1, 3);
+    layout->addWidget(exportButton, 3, 3);
+    
+    auto makeQuery = [=]() {
+        RecordingCatalog::Query query;
+        query.lowFrequency = lowSpin->value() * 1e6;
+        query.highFrequency = highSpin->value() * 1e6;
+        query.from = fromEdit->dateTime();
+        query.to = toEdit->dateTime();
+        query.toneOnly = toneCheck->isChecked();
+        return query;
+    };
+    
+    auto search = [=, &catalog]() {
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<RecordingCatalog::Entry> entries = catalog.query(makeQuery());
+        qint64 elapsed = timer.elapsed();
+        
+        // Newest at the top
+        table->setRowCount(static_cast<int>(entries.size()));
+        int row = 0;
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it, ++row) {
+            table->setItem(row, 0, new QTableWidgetItem(it->start.toString("yyyy-MM-dd HH:mm:ss")));
+            table->setItem(row, 1, new QTableWidgetItem(QString("%1 s").arg(it->durationSeconds, 0, 'f', 1)));
+            table->setItem(row, 2, new QTableWidgetItem(QString("%1 MHz").arg(it->frequency / 1e6, 0, 'f', 4)));
+            table->setItem(row, 3, new QTableWidgetItem(it->mode));
+            table->setItem(row, 4, new QTableWidgetItem(it->ctcssTone > 0.0f ?
+                                                        QString("%1 Hz").arg(it->ctcssTone, 0, 'f', 1) : QString()));
+            table->setItem(row, 5, new QTableWidgetItem(it->programService));
+            table->setItem(row, 6, new QTableWidgetItem(it->fileName));
+        }
+        resultLabel->setText(tr("%1 of %2 recordings (%3 ms)")
+                             .arg(entries.size()).arg(catalog.size()).arg(elapsed));
+    };
+    
+    connect(searchButton, &QPushButton::clicked, &dialog, search);
+    connect(exportButton, &QPushButton::clicked, &dialog, [=, &dialog, &catalog]() {
+        QString path = QFileDialog::getSaveFileName(&dialog, tr("Export Recording Log"),
+                                                    recordingManager_->getRecordingDirectory() + "/log.json",
+                                                    tr("JSON (*.json)"));
+        if (!path.isEmpty() && !catalog.exportJson(path, makeQuery())) {
+            QMessageBox::warning(&dialog, tr("Export Failed"), tr("Could not write %1").arg(path));
+        }
+    });
+    
+    search();
+    dialog.exec();
 }
 
 void RecordingWidget::onRecordingStarted(const QString& fileName) {
@@ -217,12 +413,22 @@ void RecordingWidget::onRecordingProgress(qint64 bytes, const QString& time) {
 
 void RecordingWidget::onRecordingError(const QString& error) {
     statusLabel_->setText(tr("Error: %1").arg(error));
+    if (recordingManager_ && !recordingManager_->isTriggeredRecording()) {
+        QSignalBlocker blocker(autoButton_);
+        autoButton_->setChecked(false);
+        timeShiftCheck_->setEnabled(true);
+    }
     recordButton_->setChecked(false);
     isRecording_ = false;
     formatCombo_->setEnabled(true);
     updateRecordButton();
 }
 
+void RecordingWidget::onRecordingOverrun(quint64 droppedBytes) {
+    statusLabel_->setText(tr("Recording... disk too slow, %1 KB lost")
+                          .arg(droppedBytes / 1024));
+}
+
 void RecordingWidget::updateRecordButton() {
     if (isRecording_) {
         recordButton_->setText(tr("STOP"));
@@ -24,15 +24,22 @@ public:
 signals:
     void recordingStartRequested();
     void recordingStopRequested();
+    void triggeredRecordingToggled(bool enabled);
     
 private slots:
     void onRecordButtonClicked();
     void onTimeShiftToggled(bool checked);
     void onSaveTimeShiftClicked();
+    void onTimeShiftSaved(const QString& fileName, qint64 bytes);
+    void onReplayToggled(bool checked);
+    void onAutoToggled(bool checked);
+    void onTransmissionRecorded(const QString& fileName, qint64 bytes, double seconds);
+    void onLogClicked();
     void onRecordingStarted(const QString& fileName);
     void onRecordingStopped(const QString& fileName, qint64 bytes);
     void onRecordingProgress(qint64 bytes, const QString& time);
     void onRecordingError(const QString& error);
+    void onRecordingOverrun(quint64 droppedBytes);
     
 private:
     void updateRecordButton();
@@ -47,6 +54,9 @@ private:
     QComboBox* formatCombo_;
     QCheckBox* timeShiftCheck_;
     QPushButton* saveTimeShiftButton_;
+    QPushButton* replayButton_;
+    QPushButton* autoButton_;
+    QPushButton* logButton_;
     
     // State
     bool isRecording_;
@@ -31,7 +31,8 @@ ScannerWidget::ScannerWidget(QWidget* parent)
     controlLayout->addWidget(scanButton_);
     
     modeCombo_ = new QComboBox(this);
-    modeCombo_->addItems({tr("Frequency"), tr("Channel"), tr("Memory"), tr("Band")});
+    modeCombo_->addItems({tr("Frequency"), tr("Channel"), tr("Memory"), tr("Band"),
+                          tr("Wideband")});
     modeCombo_->setToolTip(tr("Scan mode"));
     connect(modeCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &ScannerWidget::onModeChanged);
@@ -216,7 +217,8 @@ void ScannerWidget::onModeChanged(int index) {
     
     // Enable/disable step size based on mode
     bool enableStep = (currentMode_ == Scanner::ScanMode::FREQUENCY || 
-                      currentMode_ == Scanner::ScanMode::BAND);
+                      currentMode_ == Scanner::ScanMode::BAND ||
+                      currentMode_ == Scanner::ScanMode::WIDEBAND);
     stepCombo_->setEnabled(enableStep);
 }
 
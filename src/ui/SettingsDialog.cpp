@@ -51,6 +51,9 @@ void SettingsDialog::setupUI() {
     // Create settings sections
     createAudioSettings();
     createRtlSdrSettings();
+    createSpectrumSettings();
+    createSquelchSettings();
+    createTriggerSettings();
     createGeneralSettings();
     
     // Button box
@@ -118,9 +121,165 @@ void SettingsDialog::createRtlSdrSettings() {
     rtlSampleRateCombo_->setToolTip(tr("Higher rates may cause USB drops. 2.4 MHz recommended for stability."));
     rtlLayout->addWidget(rtlSampleRateCombo_, 2, 1);
     
+    // USB buffering, taking effect when the radio is next started
+    rtlLayout->addWidget(new QLabel(tr("USB Buffering:")), 3, 0);
+    usbPresetCombo_ = new QComboBox();
+    usbPresetCombo_->addItems({tr("Low latency"), tr("Balanced"), tr("Robust"), tr("Custom")});
+    usbPresetCombo_->setCurrentIndex(1);
+    usbPresetCombo_->setToolTip(tr("Low latency: short transfers at real-time priority.\n"
+                                   "Robust: long transfers that ride out system stalls.\n"
+                                   "Applied when the radio is started."));
+    rtlLayout->addWidget(usbPresetCombo_, 3, 1);
+    
+    rtlLayout->addWidget(new QLabel(tr("USB Buffers:")), 4, 0);
+    usbBuffersSpin_ = new QSpinBox();
+    usbBuffersSpin_->setRange(2, 64);
+    usbBuffersSpin_->setToolTip(tr("Transfers in flight; more survive longer stalls"));
+    rtlLayout->addWidget(usbBuffersSpin_, 4, 1);
+    
+    rtlLayout->addWidget(new QLabel(tr("USB Buffer Size:")), 5, 0);
+    usbBufferSizeSpin_ = new QSpinBox();
+    usbBufferSizeSpin_->setRange(1, 256);
+    usbBufferSizeSpin_->setSuffix(" KB");
+    usbBufferSizeSpin_->setToolTip(tr("Bytes per transfer; smaller means less latency but more callbacks"));
+    rtlLayout->addWidget(usbBufferSizeSpin_, 5, 1);
+    
+    rtlLayout->addWidget(new QLabel(tr("Streaming Priority:")), 6, 0);
+    streamPriorityCombo_ = new QComboBox();
+    streamPriorityCombo_->addItems({tr("Normal"), tr("High (nice -10)"), tr("Real-time (SCHED_FIFO)")});
+    streamPriorityCombo_->setToolTip(tr("Raised priorities need CAP_SYS_NICE or an rtprio limit;\n"
+                                        "real-time falls back to high without it"));
+    rtlLayout->addWidget(streamPriorityCombo_, 6, 1);
+    
+    rtlLayout->addWidget(new QLabel(tr("Streaming CPU:")), 7, 0);
+    streamCpuSpin_ = new QSpinBox();
+    streamCpuSpin_->setRange(-1, 255);
+    streamCpuSpin_->setValue(-1);
+    streamCpuSpin_->setSpecialValueText(tr("Any"));
+    streamCpuSpin_->setToolTip(tr("Pin the USB streaming thread to one CPU"));
+    rtlLayout->addWidget(streamCpuSpin_, 7, 1);
+    applyUsbPreset(1);
+    
     layout()->addWidget(rtlGroup);
 }
 
+void SettingsDialog::createSpectrumSettings() {
+    auto* spectrumGroup = new QGroupBox(tr("Spectrum Settings"), this);
+    auto* spectrumLayout = new QGridLayout(spectrumGroup);
+    
+    // FFT size
+    spectrumLayout->addWidget(new QLabel(tr("FFT Size:")), 0, 0);
+    fftSizeCombo_ = new QComboBox();
+    for (int size = 512; size <= 65536; size *= 2) {
+        fftSizeCombo_->addItem(QString::number(size));
+    }
+    fftSizeCombo_->setCurrentIndex(2); // 2048 default
+    fftSizeCombo_->setToolTip(tr("Larger sizes give finer resolution but update more slowly"));
+    spectrumLayout->addWidget(fftSizeCombo_, 0, 1);
+    
+    // Window function
+    spectrumLayout->addWidget(new QLabel(tr("Window:")), 1, 0);
+    fftWindowCombo_ = new QComboBox();
+    fftWindowCombo_->addItems({tr("Hann"), tr("Blackman-Harris"), tr("Flat-top")});
+    fftWindowCombo_->setToolTip(tr("Blackman-Harris for weak signals near strong ones, "
+                                   "flat-top for accurate levels"));
+    spectrumLayout->addWidget(fftWindowCombo_, 1, 1);
+    
+    // Segment overlap
+    spectrumLayout->addWidget(new QLabel(tr("Overlap:")), 2, 0);
+    fftOverlapCombo_ = new QComboBox();
+    fftOverlapCombo_->addItems({"0%", "25%", "50%", "75%"});
+    fftOverlapCombo_->setCurrentIndex(2); // 50% default
+    spectrumLayout->addWidget(fftOverlapCombo_, 2, 1);
+    
+    layout()->addWidget(spectrumGroup);
+}
+
+void SettingsDialog::createSquelchSettings() {
+    auto* squelchGroup = new QGroupBox(tr("Squelch Settings"), this);
+    auto* squelchLayout = new QGridLayout(squelchGroup);
+    
+    // Squelch mode
+    squelchLayout->addWidget(new QLabel(tr("Mode:")), 0, 0);
+    squelchModeCombo_ = new QComboBox();
+    squelchModeCombo_->addItems({tr("Signal level"), tr("FM noise"), tr("SNR")});
+    squelchModeCombo_->setToolTip(tr("FM noise opens on discriminator quieting above 5 kHz, "
+                                     "SNR on channel power over the spectrum noise floor"));
+    squelchLayout->addWidget(squelchModeCombo_, 0, 1);
+    
+    // Hysteresis
+    squelchLayout->addWidget(new QLabel(tr("Hysteresis:")), 1, 0);
+    squelchHysteresisSpin_ = new QSpinBox();
+    squelchHysteresisSpin_->setRange(0, 20);
+    squelchHysteresisSpin_->setValue(3);
+    squelchHysteresisSpin_->setSuffix(" dB");
+    squelchLayout->addWidget(squelchHysteresisSpin_, 1, 1);
+    
+    // Hang time
+    squelchLayout->addWidget(new QLabel(tr("Hang Time:")), 2, 0);
+    squelchHangSpin_ = new QSpinBox();
+    squelchHangSpin_->setRange(0, 2000);
+    squelchHangSpin_->setSingleStep(50);
+    squelchHangSpin_->setValue(250);
+    squelchHangSpin_->setSuffix(" ms");
+    squelchHangSpin_->setToolTip(tr("How long the signal may drop below the threshold "
+                                    "before the squelch closes"));
+    squelchLayout->addWidget(squelchHangSpin_, 2, 1);
+    
+    layout()->addWidget(squelchGroup);
+}
+
+void SettingsDialog::createTriggerSettings() {
+    auto* triggerGroup = new QGroupBox(tr("Triggered Recording"), this);
+    auto* triggerLayout = new QGridLayout(triggerGroup);
+    
+    // Trigger source
+    triggerLayout->addWidget(new QLabel(tr("Trigger:")), 0, 0);
+    triggerSourceCombo_ = new QComboBox();
+    triggerSourceCombo_->addItems({tr("Squelch open"), tr("CTCSS tone")});
+    triggerSourceCombo_->setToolTip(tr("CTCSS tone needs the CTCSS decoder enabled"));
+    triggerLayout->addWidget(triggerSourceCombo_, 0, 1);
+    
+    // Pre-roll
+    triggerLayout->addWidget(new QLabel(tr("Pre-roll:")), 1, 0);
+    triggerPrerollSpin_ = new QSpinBox();
+    triggerPrerollSpin_->setRange(0, 30);
+    triggerPrerollSpin_->setValue(2);
+    triggerPrerollSpin_->setSuffix(" s");
+    triggerPrerollSpin_->setToolTip(tr("Audio kept from before the trigger"));
+    triggerLayout->addWidget(triggerPrerollSpin_, 1, 1);
+    
+    // Rotation limits
+    triggerLayout->addWidget(new QLabel(tr("Max Length:")), 2, 0);
+    triggerMaxSecondsSpin_ = new QSpinBox();
+    triggerMaxSecondsSpin_->setRange(0, 3600);
+    triggerMaxSecondsSpin_->setSingleStep(30);
+    triggerMaxSecondsSpin_->setValue(300);
+    triggerMaxSecondsSpin_->setSuffix(" s");
+    triggerMaxSecondsSpin_->setSpecialValueText(tr("No limit"));
+    triggerMaxSecondsSpin_->setToolTip(tr("Longer transmissions continue in a new file"));
+    triggerLayout->addWidget(triggerMaxSecondsSpin_, 2, 1);
+    
+    triggerLayout->addWidget(new QLabel(tr("Max Size:")), 3, 0);
+    triggerMaxSizeSpin_ = new QSpinBox();
+    triggerMaxSizeSpin_->setRange(0, 4096);
+    triggerMaxSizeSpin_->setValue(0);
+    triggerMaxSizeSpin_->setSuffix(" MB");
+    triggerMaxSizeSpin_->setSpecialValueText(tr("No limit"));
+    triggerLayout->addWidget(triggerMaxSizeSpin_, 3, 1);
+    
+    triggerLayout->addWidget(new QLabel(tr("Format:")), 4, 0);
+    triggerFormatCombo_ = new QComboBox();
+    triggerFormatCombo_->addItem(tr("WAV"));
+#ifdef HAS_OPUS
+    triggerFormatCombo_->addItem(tr("Opus (low bitrate)"));
+#endif
+    triggerFormatCombo_->setToolTip(tr("Opus keeps long unattended logs small"));
+    triggerLayout->addWidget(triggerFormatCombo_, 4, 1);
+    
+    layout()->addWidget(triggerGroup);
+}
+
 void SettingsDialog::createGeneralSettings() {
     auto* generalGroup = new QGroupBox(tr("General Settings"), this);
     auto* generalLayout = new QVBoxLayout(generalGroup);
@@ -163,6 +322,69 @@ void SettingsDialog::connectSignals() {
             this, &SettingsDialog::ppmChanged);
     connect(rtlSampleRateCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &SettingsDialog::rtlSampleRateChanged);
+    connect(usbPresetCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &SettingsDialog::applyUsbPreset);
+    
+    // Spectrum settings take effect immediately, like the audio device
+    connect(fftSizeCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                settings_->setValue("spectrum_fft_size", index);
+                emit spectrumSettingsChanged();
+            });
+    connect(fftWindowCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                settings_->setValue("spectrum_window", index);
+                emit spectrumSettingsChanged();
+            });
+    connect(fftOverlapCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                settings_->setValue("spectrum_overlap", index);
+                emit spectrumSettingsChanged();
+            });
+    
+    // Squelch settings, also immediate
+    connect(squelchModeCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                settings_->setValue("squelch_mode", index);
+                emit squelchSettingsChanged();
+            });
+    connect(squelchHysteresisSpin_, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int value) {
+                settings_->setValue("squelch_hysteresis", value);
+                emit squelchSettingsChanged();
+            });
+    connect(squelchHangSpin_, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int value) {
+                settings_->setValue("squelch_hang", value);
+                emit squelchSettingsChanged();
+            });
+    
+    // Triggered recording settings, picked up by a running trigger
+    connect(triggerSourceCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                settings_->setValue("trigger_source", index);
+                emit triggerSettingsChanged();
+            });
+    connect(triggerPrerollSpin_, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int value) {
+                settings_->setValue("trigger_preroll", value);
+                emit triggerSettingsChanged();
+            });
+    connect(triggerMaxSecondsSpin_, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int value) {
+                settings_->setValue("trigger_max_seconds", value);
+                emit triggerSettingsChanged();
+            });
+    connect(triggerMaxSizeSpin_, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int value) {
+                settings_->setValue("trigger_max_mb", value);
+                emit triggerSettingsChanged();
+            });
+    connect(triggerFormatCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                settings_->setValue("trigger_format", index);
+                emit triggerSettingsChanged();
+            });
     
     // General settings
     connect(dynamicBandwidthCheck_, &QCheckBox::toggled,
@@ -204,6 +426,33 @@ void SettingsDialog::loadSettings() {
     biasTCheck_->setChecked(settings_->getValue("rtl_bias_t", false).toBool());
     ppmSpin_->setValue(settings_->getValue("rtl_ppm", 0).toInt());
     rtlSampleRateCombo_->setCurrentIndex(settings_->getValue("rtl_sample_rate", 1).toInt());
+    usbPresetCombo_->setCurrentIndex(settings_->getValue("rtl_usb_preset", 1).toInt());
+    applyUsbPreset(usbPresetCombo_->currentIndex());
+    if (usbPresetCombo_->currentIndex() == 3) {
+        usbBuffersSpin_->setValue(settings_->getValue("rtl_usb_buffers", 15).toInt());
+        usbBufferSizeSpin_->setValue(settings_->getValue("rtl_usb_buffer_kb", 32).toInt());
+        streamPriorityCombo_->setCurrentIndex(settings_->getValue("rtl_stream_priority", 0).toInt());
+    }
+    streamCpuSpin_->setValue(settings_->getValue("rtl_stream_cpu", -1).toInt());
+    
+    // Spectrum settings
+    fftSizeCombo_->setCurrentIndex(settings_->getValue("spectrum_fft_size", 2).toInt());
+    fftWindowCombo_->setCurrentIndex(settings_->getValue("spectrum_window", 0).toInt());
+    fftOverlapCombo_->setCurrentIndex(settings_->getValue("spectrum_overlap", 2).toInt());
+    
+    // Squelch settings
+    squelchModeCombo_->setCurrentIndex(settings_->getValue("squelch_mode", 0).toInt());
+    squelchHysteresisSpin_->setValue(settings_->getValue("squelch_hysteresis", 3).toInt());
+    squelchHangSpin_->setValue(settings_->getValue("squelch_hang", 250).toInt());
+    
+    // Triggered recording settings
+    triggerSourceCombo_->setCurrentIndex(settings_->getValue("trigger_source", 0).toInt());
+    triggerPrerollSpin_->setValue(settings_->getValue("trigger_preroll", 2).toInt());
+    triggerMaxSecondsSpin_->setValue(settings_->getValue("trigger_max_seconds", 300).toInt());
+    triggerMaxSizeSpin_->setValue(settings_->getValue("trigger_max_mb", 0).toInt());
+    // Opus is only listed when built in
+    int triggerFormat = settings_->getValue("trigger_format", 0).toInt();
+    triggerFormatCombo_->setCurrentIndex(triggerFormat < triggerFormatCombo_->count() ? triggerFormat : 0);
     
     // General settings
     dynamicBandwidthCheck_->setChecked(settings_->getValue("dynamic_bandwidth", true).toBool());
@@ -218,6 +467,28 @@ void SettingsDialog::saveSettings() {
     settings_->setValue("rtl_bias_t", biasTCheck_->isChecked());
     settings_->setValue("rtl_ppm", ppmSpin_->value());
     settings_->setValue("rtl_sample_rate", rtlSampleRateCombo_->currentIndex());
+    settings_->setValue("rtl_usb_preset", usbPresetCombo_->currentIndex());
+    settings_->setValue("rtl_usb_buffers", usbBuffersSpin_->value());
+    settings_->setValue("rtl_usb_buffer_kb", usbBufferSizeSpin_->value());
+    settings_->setValue("rtl_stream_priority", streamPriorityCombo_->currentIndex());
+    settings_->setValue("rtl_stream_cpu", streamCpuSpin_->value());
+    
+    // Spectrum settings
+    settings_->setValue("spectrum_fft_size", fftSizeCombo_->currentIndex());
+    settings_->setValue("spectrum_window", fftWindowCombo_->currentIndex());
+    settings_->setValue("spectrum_overlap", fftOverlapCombo_->currentIndex());
+    
+    // Squelch settings
+    settings_->setValue("squelch_mode", squelchModeCombo_->currentIndex());
+    settings_->setValue("squelch_hysteresis", squelchHysteresisSpin_->value());
+    settings_->setValue("squelch_hang", squelchHangSpin_->value());
+    
+    // Triggered recording settings
+    settings_->setValue("trigger_source", triggerSourceCombo_->currentIndex());
+    settings_->setValue("trigger_preroll", triggerPrerollSpin_->value());
+    settings_->setValue("trigger_max_seconds", triggerMaxSecondsSpin_->value());
+    settings_->setValue("trigger_max_mb", triggerMaxSizeSpin_->value());
+    settings_->setValue("trigger_format", triggerFormatCombo_->currentIndex());
     
     // General settings
     settings_->setValue("dynamic_bandwidth", dynamicBandwidthCheck_->isChecked());
@@ -237,6 +508,19 @@ void SettingsDialog::onResetAllClicked() {
         biasTCheck_->setChecked(false);
         ppmSpin_->setValue(0);
         rtlSampleRateCombo_->setCurrentIndex(1); // 2.4 MHz
+        usbPresetCombo_->setCurrentIndex(1); // Balanced
+        streamCpuSpin_->setValue(-1);
+        fftSizeCombo_->setCurrentIndex(2); // 2048
+        fftWindowCombo_->setCurrentIndex(0); // Hann
+        fftOverlapCombo_->setCurrentIndex(2); // 50%
+        squelchModeCombo_->setCurrentIndex(0); // Signal level
+        squelchHysteresisSpin_->setValue(3);
+        squelchHangSpin_->setValue(250);
+        triggerSourceCombo_->setCurrentIndex(0); // Squelch open
+        triggerPrerollSpin_->setValue(2);
+        triggerMaxSecondsSpin_->setValue(300);
+        triggerMaxSizeSpin_->setValue(0);
+        triggerFormatCombo_->setCurrentIndex(0); // WAV
         dynamicBandwidthCheck_->setChecked(true);
         
         // Emit reset signal
@@ -286,3 +570,28 @@ int SettingsDialog::getRtlSampleRate() const {
     int index = rtlSampleRateCombo_->currentIndex();
     return (index >= 0 && index < 4) ? rates[index] : 2400000;
 }
+
+RTLSDRDevice::StreamConfig SettingsDialog::getStreamConfig() const {
+    RTLSDRDevice::StreamConfig config;
+    config.bufferCount = static_cast<uint32_t>(usbBuffersSpin_->value());
+    config.bufferLength = static_cast<uint32_t>(usbBufferSizeSpin_->value()) * 1024;
+    config.priority = static_cast<RTLSDRDevice::StreamPriority>(streamPriorityCombo_->currentIndex());
+    config.cpu = streamCpuSpin_->value();
+    return config;
+}
+
+void SettingsDialog::applyUsbPreset(int index) {
+    // A preset fills in the custom fields and locks them
+    bool custom = index < 0 || index > 2;
+    if (!custom) {
+        RTLSDRDevice::StreamConfig preset =
+            RTLSDRDevice::getStreamPreset(static_cast<RTLSDRDevice::StreamPreset>(index));
+        // The library default transfer count is 15
+        usbBuffersSpin_->setValue(preset.bufferCount ? static_cast<int>(preset.bufferCount) : 15);
+        usbBufferSizeSpin_->setValue(static_cast<int>(preset.bufferLength / 1024));
+        streamPriorityCombo_->setCurrentIndex(static_cast<int>(preset.priority));
+    }
+    usbBuffersSpin_->setEnabled(custom);
+    usbBufferSizeSpin_->setEnabled(custom);
+    streamPriorityCombo_->setEnabled(custom);
+}
@@ -33,6 +33,7 @@ public:
     bool getBiasT() const;
     int getPpm() const;
     int getRtlSampleRate() const;
+    RTLSDRDevice::StreamConfig getStreamConfig() const;
     
 signals:
     // Settings changed signals
@@ -43,6 +44,9 @@ signals:
     void biasTChanged(bool checked);
     void ppmChanged(int value);
     void rtlSampleRateChanged(int index);
+    void spectrumSettingsChanged();
+    void squelchSettingsChanged();
+    void triggerSettingsChanged();
     void resetAllClicked();
     
 public slots:
@@ -59,9 +63,13 @@ private:
     void setupUI();
     void createAudioSettings();
     void createRtlSdrSettings();
+    void createSpectrumSettings();
+    void createSquelchSettings();
+    void createTriggerSettings();
     void createGeneralSettings();
     void connectSignals();
     void populateAudioDevices();
+    void applyUsbPreset(int index);
     
     // Core components
     std::shared_ptr<Settings> settings_;
@@ -77,6 +85,28 @@ private:
     QCheckBox* biasTCheck_;
     QSpinBox* ppmSpin_;
     QComboBox* rtlSampleRateCombo_;
+    QComboBox* usbPresetCombo_;
+    QSpinBox* usbBuffersSpin_;
+    QSpinBox* usbBufferSizeSpin_;
+    QComboBox* streamPriorityCombo_;
+    QSpinBox* streamCpuSpin_;
+    
+    // Spectrum settings
+    QComboBox* fftSizeCombo_;
+    QComboBox* fftWindowCombo_;
+    QComboBox* fftOverlapCombo_;
+    
+    // Squelch settings
+    QComboBox* squelchModeCombo_;
+    QSpinBox* squelchHysteresisSpin_;
+    QSpinBox* squelchHangSpin_;
+    
+    // Triggered recording settings
+    QComboBox* triggerSourceCombo_;
+    QSpinBox* triggerPrerollSpin_;
+    QSpinBox* triggerMaxSecondsSpin_;
+    QSpinBox* triggerMaxSizeSpin_;
+    QComboBox* triggerFormatCombo_;
     
     // General settings
     QCheckBox* dynamicBandwidthCheck_;
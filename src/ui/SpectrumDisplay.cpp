@@ -1,16 +1,32 @@
 #include "SpectrumDisplay.h"
+#include "GLSpectrumView.h"
+#include "../dsp/ZoomFFT.h"
+#include <QComboBox>
 #include <QPainter>
 #include <QPainterPath>
 #include <QLinearGradient>
 #include <algorithm>
 #include <cmath>
 
+#ifdef HAS_SPDLOG
+#include <spdlog/spdlog.h>
+#endif
+
 SpectrumDisplay::SpectrumDisplay(QWidget* parent)
     : QWidget(parent)
     , displayMode_(BOTH)
     , averaging_(4)
     , intensity_(1.0f)
-    , waterfallPos_(0)
+    , averageMode_(RUNNING_SUM)
+    , ringIndex_(0)
+    , ringCount_(0)
+    , peakHoldEnabled_(false)
+    , minHoldEnabled_(false)
+    , spanSelector_(nullptr)
+    , sampleRate_(2400000)
+    , axisLow_(0.0)
+    , axisHigh_(0.0)
+    , glView_(nullptr)
     , persistenceEnabled_(true)
     , phosphorDecay_(0.95f)
     , colorScheme_(0)
@@ -29,17 +45,148 @@ SpectrumDisplay::SpectrumDisplay(QWidget* parent)
     pal.setColor(QPalette::Window, Qt::black);
     setAutoFillBackground(true);
     setPalette(pal);
+    
+    // Span selector floats in the top right corner
+    spanSelector_ = new QComboBox(this);
+    spanSelector_->setToolTip(tr("Spectrum span: zoom in around the tuned frequency"));
+    populateSpanSelector();
+    connect(spanSelector_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                emit zoomChanged(spanSelector_->itemData(index).toInt());
+            });
+}
+
+void SpectrumDisplay::setSampleRate(uint32_t sampleRate) {
+    if (sampleRate == sampleRate_) {
+        return;
+    }
+    sampleRate_ = sampleRate;
+    populateSpanSelector();
+}
+
+void SpectrumDisplay::setFrequencyAxis(double lowHz, double highHz) {
+    axisLow_ = lowHz;
+    axisHigh_ = highHz;
+    spanSelector_->setVisible(highHz <= lowHz);
+    if (glView_) {
+        glView_->setFrequencyAxis(lowHz, highHz);
+    }
+    update();
+}
+
+void SpectrumDisplay::setAccelerated(bool enable) {
+    if (enable == (glView_ != nullptr)) {
+        return;
+    }
+    
+    if (!enable) {
+        glView_->deleteLater();
+        glView_ = nullptr;
+        waterfall_.resize(waterfallRect().size());
+        update();
+        return;
+    }
+    
+    glView_ = new GLSpectrumView(this);
+    glView_->setGeometry(rect());
+    glView_->setPanes(displayMode_ != WATERFALL, displayMode_ != SPECTRUM);
+    glView_->setColorScheme(colorScheme_, intensity_);
+    glView_->setFrequencyAxis(axisLow_, axisHigh_);
+    
+    // initializeGL runs on first show; drop back to QPainter if it cannot work
+    connect(glView_, &GLSpectrumView::initializationFailed, this,
+            [this](const QString& reason) {
+#ifdef HAS_SPDLOG
+                spdlog::warn("OpenGL spectrum unavailable, using software painting: {}",
+                             reason.toStdString());
+#else
+                Q_UNUSED(reason);
+#endif
+                setAccelerated(false);
+            }, Qt::QueuedConnection);
+    
+    glView_->show();
+    spanSelector_->raise();
+}
+
+void SpectrumDisplay::populateSpanSelector() {
+    // Only the labels depend on the rate; the selection stays
+    int current = std::max(0, spanSelector_->currentIndex());
+    spanSelector_->blockSignals(true);
+    spanSelector_->clear();
+    spanSelector_->addItem(tr("Full span"), 1);
+    for (int decimation = 16; decimation <= 512; decimation *= 2) {
+        double span = sampleRate_ * ZoomFFT::USABLE_FRACTION / decimation;
+        spanSelector_->addItem(tr("%1 kHz").arg(span / 1000.0, 0, 'f', 1), decimation);
+    }
+    spanSelector_->setCurrentIndex(current);
+    spanSelector_->blockSignals(false);
+    spanSelector_->adjustSize();
+    spanSelector_->move(width() - spanSelector_->width() - 5, 5);
 }
 
 void SpectrumDisplay::updateSpectrum(const float* data, size_t length) {
-    // Update spectrum data
-    spectrumData_.assign(data, data + length);
+    if (length == 0) {
+        return;
+    }
+    if (spectrumData_.size() != length) {
+        resetAveraging(length);
+    }
     
-    // Auto-ranging
-    if (autoRange_ && !spectrumData_.empty()) {
-        float minVal = *std::min_element(spectrumData_.begin(), spectrumData_.end());
-        float maxVal = *std::max_element(spectrumData_.begin(), spectrumData_.end());
+    const size_t frames = static_cast<size_t>(averaging_);
+    float* out = spectrumData_.data();
+    float* sum = averageSum_.data();
+    float* peak = peakHold_.data();
+    float* low = minHold_.data();
+    float minVal = data[0];
+    float maxVal = data[0];
+    
+    // One pass over the bins: average, holds and auto-range extremes. The loops
+    // are branch free so the compiler can vectorise them.
+    if (averageMode_ == EXPONENTIAL) {
+        // The first frame after a reset seeds the average
+        const float alpha = (ringCount_ > 0) ? 2.0f / (frames + 1) : 1.0f;
+        for (size_t i = 0; i < length; i++) {
+            float value = sum[i] + alpha * (data[i] - sum[i]);
+            sum[i] = value;
+            out[i] = value;
+            peak[i] = std::max(peak[i], value);
+            low[i] = std::min(low[i], value);
+            minVal = std::min(minVal, data[i]);
+            maxVal = std::max(maxVal, data[i]);
+        }
+    } else {
+        // Replace the oldest frame in the ring; sum += new - old
+        float* slot = averageRing_.data() + ringIndex_ * length;
+        const float scale = 1.0f / std::min(ringCount_ + 1, frames);
+        for (size_t i = 0; i < length; i++) {
+            float total = sum[i] + data[i] - slot[i];
+            slot[i] = data[i];
+            sum[i] = total;
+            float value = total * scale;
+            out[i] = value;
+            peak[i] = std::max(peak[i], value);
+            low[i] = std::min(low[i], value);
+            minVal = std::min(minVal, data[i]);
+            maxVal = std::max(maxVal, data[i]);
+        }
         
+        ringIndex_ = (ringIndex_ + 1) % frames;
+        if (ringIndex_ == 0) {
+            // Re-sum once per lap so float rounding in the running sum cannot drift
+            std::fill(averageSum_.begin(), averageSum_.end(), 0.0f);
+            for (size_t f = 0; f < frames; f++) {
+                const float* frame = averageRing_.data() + f * length;
+                for (size_t i = 0; i < length; i++) {
+                    sum[i] += frame[i];
+                }
+            }
+        }
+    }
+    ringCount_ = std::min(ringCount_ + 1, frames);
+    
+    // Auto-ranging
+    if (autoRange_) {
         // Add some headroom
         minVal -= 10.0f;
         maxVal += 10.0f;
@@ -60,27 +207,14 @@ void SpectrumDisplay::updateSpectrum(const float* data, size_t length) {
         }
     }
     
-    // Update averaging buffer
-    if (averaging_ > 1) {
-        averageBuffer_.push_back(spectrumData_);
-        if (averageBuffer_.size() > static_cast<size_t>(averaging_)) {
-            averageBuffer_.pop_front();
-        }
-        
-        // Calculate average
-        averagedData_.resize(length, 0.0f);
-        for (const auto& buffer : averageBuffer_) {
-            for (size_t i = 0; i < length && i < buffer.size(); i++) {
-                averagedData_[i] += buffer[i];
-            }
-        }
-        
-        float scale = 1.0f / averageBuffer_.size();
-        for (float& value : averagedData_) {
-            value *= scale;
-        }
-        
-        spectrumData_ = averagedData_;
+    // Update phosphor
+    if (persistenceEnabled_) {
+        updatePhosphor();
+    }
+    
+    if (glView_) {
+        updateGLView();
+        return;
     }
     
     // Update waterfall
@@ -88,37 +222,93 @@ void SpectrumDisplay::updateSpectrum(const float* data, size_t length) {
         updateWaterfall();
     }
     
-    // Update phosphor
-    if (persistenceEnabled_) {
-        updatePhosphor();
-    }
-    
     update();
 }
 
+void SpectrumDisplay::updateGLView() {
+    // The GL view does its own column reduction and quantisation
+    glView_->setLevels(minDb_, maxDb_);
+    if (displayMode_ != SPECTRUM) {
+        glView_->addWaterfallLine(spectrumData_);
+    }
+    glView_->setTraces(spectrumData_,
+                       persistenceEnabled_ ? &phosphorData_ : nullptr,
+                       peakHoldEnabled_ ? &peakHold_ : nullptr,
+                       minHoldEnabled_ ? &minHold_ : nullptr);
+    glView_->update();
+}
+
 void SpectrumDisplay::setDisplayMode(DisplayMode mode) {
     displayMode_ = mode;
+    waterfall_.resize(waterfallRect().size());
+    if (glView_) {
+        glView_->setPanes(displayMode_ != WATERFALL, displayMode_ != SPECTRUM);
+    }
     update();
 }
 
 void SpectrumDisplay::setAveraging(int samples) {
     averaging_ = qBound(1, samples, 32);
-    averageBuffer_.clear();
-    averagedData_.clear();
+    resetAveraging(spectrumData_.size());
+}
+
+void SpectrumDisplay::setAverageMode(AverageMode mode) {
+    averageMode_ = mode;
+    resetAveraging(spectrumData_.size());
+}
+
+void SpectrumDisplay::setPeakHold(bool enable) {
+    peakHoldEnabled_ = enable;
+    update();
+}
+
+void SpectrumDisplay::setMinHold(bool enable) {
+    minHoldEnabled_ = enable;
+    update();
+}
+
+void SpectrumDisplay::resetHolds() {
+    // Restart both holds from the current trace
+    std::copy(spectrumData_.begin(), spectrumData_.end(), peakHold_.begin());
+    std::copy(spectrumData_.begin(), spectrumData_.end(), minHold_.begin());
+    update();
+}
+
+void SpectrumDisplay::resetAveraging(size_t length) {
+    // All buffers are sized here so updateSpectrum never allocates
+    if (spectrumData_.size() != length) {
+        spectrumData_.assign(length, minDb_);
+        peakHold_.assign(length, -200.0f);
+        minHold_.assign(length, 200.0f);
+    }
+    averageSum_.assign(length, 0.0f);
+    averageRing_.assign(averageMode_ == RUNNING_SUM ? length * averaging_ : 0, 0.0f);
+    ringIndex_ = 0;
+    ringCount_ = 0;
 }
 
 void SpectrumDisplay::setIntensity(float intensity) {
     intensity_ = qBound(0.1f, intensity, 2.0f);
+    waterfall_.setColorScheme(colorScheme_, intensity_);
+    if (glView_) {
+        glView_->setColorScheme(colorScheme_, intensity_);
+    }
     update();
 }
 
 void SpectrumDisplay::clear() {
     spectrumData_.clear();
-    averagedData_.clear();
-    averageBuffer_.clear();
+    averageSum_.clear();
+    averageRing_.clear();
+    peakHold_.clear();
+    minHold_.clear();
+    ringIndex_ = 0;
+    ringCount_ = 0;
     phosphorData_.clear();
-    waterfallImage_ = QImage();
-    waterfallPos_ = 0;
+    waterfall_.clear();
+    if (glView_) {
+        glView_->clearWaterfall();
+    }
     update();
 }
 
@@ -135,6 +325,10 @@ void SpectrumDisplay::setPhosphorDecay(float rate) {
 
 void SpectrumDisplay::setColorScheme(int scheme) {
     colorScheme_ = scheme;
+    waterfall_.setColorScheme(colorScheme_, intensity_);
+    if (glView_) {
+        glView_->setColorScheme(colorScheme_, intensity_);
+    }
     update();
 }
 
@@ -149,6 +343,11 @@ QSize SpectrumDisplay::minimumSizeHint() const {
 void SpectrumDisplay::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
     
+    // Nothing to do under the GL view
+    if (glView_) {
+        return;
+    }
+    
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
     
@@ -166,11 +365,8 @@ void SpectrumDisplay::paintEvent(QPaintEvent* event) {
         QRect spectrumRect = displayRect;
         spectrumRect.setHeight(displayRect.height() / 2);
         
-        QRect waterfallRect = displayRect;
-        waterfallRect.setTop(displayRect.height() / 2);
-        
         drawSpectrum(painter, spectrumRect);
-        drawWaterfall(painter, waterfallRect);
+        drawWaterfall(painter, waterfallRect());
     }
     
     // Draw grid overlay
@@ -200,21 +396,29 @@ void SpectrumDisplay::drawSpectrum(QPainter& painter, const QRect& rect) {
         drawPhosphor(painter, rect);
     }
     
-    // Draw current spectrum
-    QPainterPath spectrumPath;
-    
-    float xScale = static_cast<float>(rect.width()) / spectrumData_.size();
+    // Reduce to one min/max pair per pixel column, so the path length follows
+    // the widget and not the FFT size
+    WaterfallRenderer::decimate(spectrumData_.data(), spectrumData_.size(), rect.width(),
+                                traceMin_, traceMax_);
     
-    for (size_t i = 0; i < spectrumData_.size(); i++) {
-        float x = rect.left() + i * xScale;
-        float y = rect.bottom() - dbToPixel(spectrumData_[i], rect.height());
-        
-        if (i == 0) {
-            spectrumPath.moveTo(x, y);
+    // Min/max envelope: noise shows as a band instead of aliasing away
+    QPainterPath envelopePath;
+    QPainterPath spectrumPath;
+    for (int x = 0; x < rect.width(); x++) {
+        float y = rect.bottom() - dbToPixel(traceMax_[x], rect.height());
+        if (x == 0) {
+            envelopePath.moveTo(rect.left() + x, y);
+            spectrumPath.moveTo(rect.left() + x, y);
         } else {
-            spectrumPath.lineTo(x, y);
+            envelopePath.lineTo(rect.left() + x, y);
+            spectrumPath.lineTo(rect.left() + x, y);
         }
     }
+    for (int x = rect.width() - 1; x >= 0; x--) {
+        envelopePath.lineTo(rect.left() + x, rect.bottom() - dbToPixel(traceMin_[x], rect.height()));
+    }
+    envelopePath.closeSubpath();
+    painter.fillPath(envelopePath, QColor(0, 255, 0, 120));
     
     // Draw spectrum line
     painter.setPen(QPen(QColor(0, 255, 0), 2));
@@ -230,16 +434,40 @@ void SpectrumDisplay::drawSpectrum(QPainter& painter, const QRect& rect) {
     fillGradient.setColorAt(1.0, QColor(0, 255, 0, 0));
     
     painter.fillPath(spectrumPath, fillGradient);
+    
+    // Hold traces on top
+    if (minHoldEnabled_) {
+        WaterfallRenderer::decimate(minHold_.data(), minHold_.size(), rect.width(),
+                                    traceMin_, traceMax_);
+        drawHold(painter, rect, traceMin_, QColor(0, 160, 255));
+    }
+    if (peakHoldEnabled_) {
+        WaterfallRenderer::decimate(peakHold_.data(), peakHold_.size(), rect.width(),
+                                    traceMin_, traceMax_);
+        drawHold(painter, rect, traceMax_, QColor(255, 200, 0));
+    }
 }
 
-void SpectrumDisplay::drawWaterfall(QPainter& painter, const QRect& rect) {
-    if (!waterfallImage_.isNull()) {
-        // Scale image to fit rect
-        QImage scaled = waterfallImage_.scaled(rect.size(), 
-                                              Qt::IgnoreAspectRatio, 
-                                              Qt::SmoothTransformation);
-        painter.drawImage(rect, scaled);
+void SpectrumDisplay::drawHold(QPainter& painter, const QRect& rect,
+                               const std::vector<float>& columns, const QColor& color) {
+    // One value per pixel column, already decimated
+    QPainterPath holdPath;
+    for (int x = 0; x < rect.width(); x++) {
+        float y = rect.bottom() - dbToPixel(columns[x], rect.height());
+        if (x == 0) {
+            holdPath.moveTo(rect.left() + x, y);
+        } else {
+            holdPath.lineTo(rect.left() + x, y);
+        }
     }
+    
+    painter.setPen(QPen(color, 1));
+    painter.drawPath(holdPath);
+}
+
+void SpectrumDisplay::drawWaterfall(QPainter& painter, const QRect& rect) {
+    // The renderer is kept at the rect size, so this is an unscaled blit
+    waterfall_.draw(painter, rect);
 }
 
 void SpectrumDisplay::drawGrid(QPainter& painter, const QRect& rect) {
@@ -271,6 +499,15 @@ void SpectrumDisplay::drawGrid(QPainter& painter, const QRect& rect) {
         painter.drawText(rect.left() + 5, y + 3, 
                         QString("%1 dB").arg(static_cast<int>(db)));
     }
+    
+    // Frequency scale along the bottom, when the view has one
+    if (axisHigh_ > axisLow_) {
+        for (int i = 1; i < numVLines; i++) {
+            int x = rect.left() + (rect.width() * i) / numVLines;
+            double freq = axisLow_ + (axisHigh_ - axisLow_) * i / numVLines;
+            painter.drawText(x + 3, rect.bottom() - 4, QString("%1").arg(freq / 1e6, 0, 'f', 3));
+        }
+    }
 }
 
 void SpectrumDisplay::drawPhosphor(QPainter& painter, const QRect& rect) {
@@ -278,18 +515,17 @@ void SpectrumDisplay::drawPhosphor(QPainter& painter, const QRect& rect) {
         phosphorData_.resize(spectrumData_.size(), minDb_);
     }
     
-    // Draw phosphor persistence
+    // Draw phosphor persistence, peak per pixel column
+    WaterfallRenderer::decimate(phosphorData_.data(), phosphorData_.size(), rect.width(),
+                                traceMin_, traceMax_);
     QPainterPath phosphorPath;
-    float xScale = static_cast<float>(rect.width()) / phosphorData_.size();
-    
-    for (size_t i = 0; i < phosphorData_.size(); i++) {
-        float x = rect.left() + i * xScale;
-        float y = rect.bottom() - dbToPixel(phosphorData_[i], rect.height());
+    for (int x = 0; x < rect.width(); x++) {
+        float y = rect.bottom() - dbToPixel(traceMax_[x], rect.height());
         
-        if (i == 0) {
-            phosphorPath.moveTo(x, y);
+        if (x == 0) {
+            phosphorPath.moveTo(rect.left() + x, y);
         } else {
-            phosphorPath.lineTo(x, y);
+            phosphorPath.lineTo(rect.left() + x, y);
         }
     }
     
@@ -299,21 +535,17 @@ void SpectrumDisplay::drawPhosphor(QPainter& painter, const QRect& rect) {
 }
 
 void SpectrumDisplay::updateWaterfall() {
-    if (waterfallImage_.isNull() || static_cast<size_t>(waterfallImage_.width()) != spectrumData_.size()) {
-        // Initialize waterfall image
-        waterfallImage_ = QImage(spectrumData_.size(), 256, QImage::Format_RGB32);
-        waterfallImage_.fill(Qt::black);
-        waterfallPos_ = 0;
-    }
-    
-    // Add new line to waterfall
-    for (size_t i = 0; i < spectrumData_.size(); i++) {
-        QColor color = valueToColor(spectrumData_[i]);
-        waterfallImage_.setPixelColor(i, waterfallPos_, color);
+    waterfall_.resize(waterfallRect().size());
+    waterfall_.setRange(minDb_, maxDb_);
+    waterfall_.addLine(spectrumData_.data(), spectrumData_.size());
+}
+
+QRect SpectrumDisplay::waterfallRect() const {
+    QRect displayRect = rect();
+    if (displayMode_ == BOTH) {
+        displayRect.setTop(displayRect.height() / 2);
     }
-    
-    // Advance position
-    waterfallPos_ = (waterfallPos_ + 1) % waterfallImage_.height();
+    return displayRect;
 }
 
 void SpectrumDisplay::updatePhosphor() {
@@ -332,40 +564,6 @@ void SpectrumDisplay::updatePhosphor() {
     }
 }
 
-QColor SpectrumDisplay::valueToColor(float value) {
-    // Normalize value to 0-1 range
-    float normalized = (value - minDb_) / (maxDb_ - minDb_);
-    normalized = qBound(0.0f, normalized, 1.0f);
-    normalized *= intensity_;
-    
-    // Apply color scheme
-    switch (colorScheme_) {
-        case 0: // Classic green phosphor
-            return QColor(0, static_cast<int>(255 * normalized), 0);
-            
-        case 1: // Heat map
-            if (normalized < 0.25f) {
-                return QColor(0, 0, static_cast<int>(255 * normalized * 4));
-            } else if (normalized < 0.5f) {
-                return QColor(0, static_cast<int>(255 * (normalized - 0.25f) * 4), 255);
-            } else if (normalized < 0.75f) {
-                return QColor(static_cast<int>(255 * (normalized - 0.5f) * 4), 255, 
-                            255 - static_cast<int>(255 * (normalized - 0.5f) * 4));
-            } else {
-                return QColor(255, 255 - static_cast<int>(255 * (normalized - 0.75f) * 4), 0);
-            }
-            
-        case 2: // Grayscale
-            {
-                int gray = static_cast<int>(255 * normalized);
-                return QColor(gray, gray, gray);
-            }
-            
-        default:
-            return QColor(0, static_cast<int>(255 * normalized), 0);
-    }
-}
-
 float SpectrumDisplay::dbToPixel(float db, int height) {
     float normalized = (db - minDb_) / (maxDb_ - minDb_);
     return height * qBound(0.0f, normalized, 1.0f);
@@ -374,7 +572,11 @@ float SpectrumDisplay::dbToPixel(float db, int height) {
 void SpectrumDisplay::resizeEvent(QResizeEvent* event) {
     QWidget::resizeEvent(event);
     
-    // Reset waterfall image on resize
-    waterfallImage_ = QImage();
-    waterfallPos_ = 0;
+    // Waterfall image follows the widget so painting never rescales it
+    waterfall_.resize(waterfallRect().size());
+    if (glView_) {
+        glView_->setGeometry(rect());
+    }
+    
+    spanSelector_->move(width() - spanSelector_->width() - 5, 5);
 }
@@ -5,7 +5,13 @@
 #include <QImage>
 #include <QTimer>
 #include <vector>
-#include <deque>
+#include "WaterfallRenderer.h"
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+QT_END_NAMESPACE
+
+class GLSpectrumView;
 
 class SpectrumDisplay : public QWidget {
     Q_OBJECT
@@ -22,11 +28,21 @@ public:
     };
     Q_ENUM(DisplayMode)
     
+    enum AverageMode {
+        RUNNING_SUM,    // boxcar over the last averaging() frames
+        EXPONENTIAL     // single pole with the same effective length
+    };
+    Q_ENUM(AverageMode)
+    
     explicit SpectrumDisplay(QWidget* parent = nullptr);
     
     DisplayMode displayMode() const { return displayMode_; }
     int averaging() const { return averaging_; }
     float intensity() const { return intensity_; }
+    AverageMode averageMode() const { return averageMode_; }
+    bool peakHold() const { return peakHoldEnabled_; }
+    bool minHold() const { return minHoldEnabled_; }
+    bool accelerated() const { return glView_ != nullptr; }
     
     QSize sizeHint() const override;
     QSize minimumSizeHint() const override;
@@ -35,6 +51,10 @@ public slots:
     void updateSpectrum(const float* data, size_t length);
     void setDisplayMode(DisplayMode mode);
     void setAveraging(int samples);
+    void setAverageMode(AverageMode mode);
+    void setPeakHold(bool enable);
+    void setMinHold(bool enable);
+    void resetHolds();
     void setIntensity(float intensity);
     void clear();
     
@@ -45,6 +65,21 @@ public slots:
     void setAutoRange(bool enable) { autoRange_ = enable; }
     void setDbRange(float min, float max) { minDb_ = min; maxDb_ = max; autoRange_ = false; }
     
+    // Capture rate, used to label the zoom span selector
+    void setSampleRate(uint32_t sampleRate);
+    
+    // Frequencies at the left and right edges, labelled on the grid. Set for
+    // views that are not one capture around the tuned frequency (sweeps);
+    // equal values remove the labels and bring back the span selector.
+    void setFrequencyAxis(double lowHz, double highHz);
+    
+    // Render through OpenGL; falls back to QPainter if no context can be made
+    void setAccelerated(bool enable);
+    
+signals:
+    // Zoom decimation picked with the span selector, 1 for the full capture
+    void zoomChanged(int decimation);
+    
 protected:
     void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
@@ -56,12 +91,38 @@ private:
     
     // Spectrum data
     std::vector<float> spectrumData_;
-    std::vector<float> averagedData_;
-    std::deque<std::vector<float>> averageBuffer_;
+    
+    // Averaging: the ring holds the last averaging_ raw frames back to back and
+    // averageSum_ their sum (or the exponential average), so a frame costs O(bins)
+    AverageMode averageMode_;
+    std::vector<float> averageRing_;
+    std::vector<float> averageSum_;
+    size_t ringIndex_;
+    size_t ringCount_;
+    
+    // Hold traces, updated in the averaging pass
+    std::vector<float> peakHold_;
+    std::vector<float> minHold_;
+    bool peakHoldEnabled_;
+    bool minHoldEnabled_;
+    
+    // Zoom span selector
+    QComboBox* spanSelector_;
+    uint32_t sampleRate_;
+    
+    // Labelled frequency axis, Hz; empty when equal
+    double axisLow_;
+    double axisHigh_;
+    
+    // OpenGL renderer, covers the widget when set
+    GLSpectrumView* glView_;
     
     // Waterfall data
-    QImage waterfallImage_;
-    int waterfallPos_;
+    WaterfallRenderer waterfall_;
+    
+    // Spectrum trace reduced to the widget width
+    std::vector<float> traceMin_;
+    std::vector<float> traceMax_;
     
     // Phosphor persistence
     std::vector<float> phosphorData_;
@@ -85,11 +146,16 @@ private:
     void drawWaterfall(QPainter& painter, const QRect& rect);
     void drawGrid(QPainter& painter, const QRect& rect);
     void drawPhosphor(QPainter& painter, const QRect& rect);
+    void drawHold(QPainter& painter, const QRect& rect, const std::vector<float>& columns,
+                  const QColor& color);
     
     // Helper methods
-    QColor valueToColor(float value);
+    void populateSpanSelector();
+    QRect waterfallRect() const;
+    void resetAveraging(size_t length);
     void updateWaterfall();
     void updatePhosphor();
+    void updateGLView();
     float dbToPixel(float db, int height);
 };
 
@@ -0,0 +1,129 @@
+#include "WaterfallRenderer.h"
+#include <QPainter>
+#include <algorithm>
+
+WaterfallRenderer::WaterfallRenderer()
+    : newestRow_(0)
+    , minDb_(-120.0f)
+    , dbScale_(255.0f / 110.0f) {
+    
+    setColorScheme(0, 1.0f);
+}
+
+void WaterfallRenderer::resize(const QSize& size) {
+    if (size == image_.size()) {
+        return;
+    }
+    
+    if (size.isEmpty()) {
+        image_ = QImage();
+    } else {
+        image_ = QImage(size, QImage::Format_RGB32);
+        image_.fill(Qt::black);
+    }
+    newestRow_ = 0;
+}
+
+void WaterfallRenderer::clear() {
+    if (!image_.isNull()) {
+        image_.fill(Qt::black);
+    }
+    newestRow_ = 0;
+}
+
+void WaterfallRenderer::setColorScheme(int scheme, float intensity) {
+    for (int i = 0; i < 256; i++) {
+        float normalized = std::min(1.0f, (i / 255.0f) * intensity);
+        palette_[i] = schemeColor(scheme, normalized);
+    }
+}
+
+void WaterfallRenderer::setRange(float minDb, float maxDb) {
+    minDb_ = minDb;
+    dbScale_ = (maxDb > minDb) ? 255.0f / (maxDb - minDb) : 0.0f;
+}
+
+void WaterfallRenderer::addLine(const float* data, size_t length) {
+    if (image_.isNull() || length == 0) {
+        return;
+    }
+    
+    const int width = image_.width();
+    decimate(data, length, width, columnMin_, columnMax_);
+    
+    // Newest row on top: step the ring backwards
+    newestRow_ = (newestRow_ + image_.height() - 1) % image_.height();
+    QRgb* line = reinterpret_cast<QRgb*>(image_.scanLine(newestRow_));
+    
+    // Peaks are what matter in a waterfall, so each column shows its maximum
+    for (int x = 0; x < width; x++) {
+        int index = static_cast<int>((columnMax_[x] - minDb_) * dbScale_);
+        line[x] = palette_[std::max(0, std::min(255, index))];
+    }
+}
+
+void WaterfallRenderer::draw(QPainter& painter, const QRect& rect) const {
+    if (image_.isNull()) {
+        return;
+    }
+    
+    // Rows newestRow_..end, then 0..newestRow_-1, both at 1:1 scale
+    const int height = std::min(rect.height(), image_.height());
+    const int width = std::min(rect.width(), image_.width());
+    const int firstPart = std::min(height, image_.height() - newestRow_);
+    
+    painter.drawImage(QRect(rect.left(), rect.top(), width, firstPart),
+                      image_, QRect(0, newestRow_, width, firstPart));
+    if (firstPart < height) {
+        painter.drawImage(QRect(rect.left(), rect.top() + firstPart, width, height - firstPart),
+                          image_, QRect(0, 0, width, height - firstPart));
+    }
+}
+
+void WaterfallRenderer::decimate(const float* data, size_t length, int width,
+                                 std::vector<float>& minOut, std::vector<float>& maxOut) {
+    minOut.resize(width);
+    maxOut.resize(width);
+    if (length == 0) {
+        return;
+    }
+    
+    for (int x = 0; x < width; x++) {
+        size_t begin = static_cast<size_t>(x) * length / width;
+        size_t end = std::max(begin + 1, static_cast<size_t>(x + 1) * length / width);
+        
+        float low = data[begin];
+        float high = data[begin];
+        for (size_t i = begin + 1; i < end; i++) {
+            low = std::min(low, data[i]);
+            high = std::max(high, data[i]);
+        }
+        minOut[x] = low;
+        maxOut[x] = high;
+    }
+}
+
+QRgb WaterfallRenderer::schemeColor(int scheme, float normalized) {
+    switch (scheme) {
+        case 1: // Heat map
+            if (normalized < 0.25f) {
+                return qRgb(0, 0, static_cast<int>(255 * normalized * 4));
+            } else if (normalized < 0.5f) {
+                return qRgb(0, static_cast<int>(255 * (normalized - 0.25f) * 4), 255);
+            } else if (normalized < 0.75f) {
+                return qRgb(static_cast<int>(255 * (normalized - 0.5f) * 4), 255,
+                            255 - static_cast<int>(255 * (normalized - 0.5f) * 4));
+            } else {
+                return qRgb(255, 255 - static_cast<int>(255 * (normalized - 0.75f) * 4), 0);
+            }
+        
+        case 2: // Grayscale
+            {
+                int gray = static_cast<int>(255 * normalized);
+                return qRgb(gray, gray, gray);
+            }
+        
+        default: // Classic green phosphor
+            return qRgb(0, static_cast<int>(255 * normalized), 0);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef WATERFALLRENDERER_H
+#define WATERFALLRENDERER_H
+
+#include <QImage>
+#include <QRect>
+#include <array>
+#include <vector>
+
+class QPainter;
+
+// CPU waterfall: one image row per spectrum frame, written straight through
+// scanLine() from a 256-entry colour table. The image always matches the target
+// rectangle and is used as a ring, so painting is two unscaled blits.
+class WaterfallRenderer {
+public:
+    WaterfallRenderer();
+    
+    // Resizing drops the history
+    void resize(const QSize& size);
+    QSize size() const { return image_.size(); }
+    void clear();
+    
+    void setColorScheme(int scheme, float intensity);
+    void setRange(float minDb, float maxDb);
+    
+    // One spectrum frame in dB, reduced to the image width
+    void addLine(const float* data, size_t length);
+    void draw(QPainter& painter, const QRect& rect) const;
+    
+    // Min/max reduction of length bins to width pixel columns. With fewer bins
+    // than columns each column takes its nearest bin.
+    static void decimate(const float* data, size_t length, int width,
+                         std::vector<float>& minOut, std::vector<float>& maxOut);
+    
+    // Colour scheme as used by SpectrumDisplay: 0 green phosphor, 1 heat map, 2 grayscale
+    static QRgb schemeColor(int scheme, float normalized);
+    
+private:
+    QImage image_;
+    int newestRow_;
+    std::array<QRgb, 256> palette_;
+    float minDb_;
+    float dbScale_;             // palette entries per dB
+    std::vector<float> columnMin_;
+    std::vector<float> columnMax_;
+};
+
+#endif // WATERFALLRENDERER_H
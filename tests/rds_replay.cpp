@@ -0,0 +1,236 @@
+// Replays the RDS corpus through RDSDecoder, once as decoded groups and once as
+// an encoded bitstream with bit errors, checks the decoded PS/RT/PTYN/PIN/ECC/
+// TA/AF/TMC/EON against the corpus 'expect' lines and reports throughput.
+//
+// usage: rds_replay <corpus> [passes]
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "decoders/RDSDecoder.h"
+
+using Results = QMap<QString, QStringList>;
+
+static const uint16_t OFFSET_A = 0x0FC;
+static const uint16_t OFFSET_B = 0x198;
+static const uint16_t OFFSET_C = 0x168;
+static const uint16_t OFFSET_C_PRIME = 0x350;
+static const uint16_t OFFSET_D = 0x1B4;
+
+struct Corpus {
+    std::vector<uint16_t> blocks;   // 4 per group
+    Results expected;
+    
+    size_t groups() const { return blocks.size() / 4; }
+};
+
+static bool loadCorpus(const QString& path, Corpus& corpus) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::cerr << "Cannot open " << path.toStdString() << std::endl;
+        return false;
+    }
+    
+    QTextStream in(&file);
+    int lineNumber = 0;
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        
+        if (line.startsWith("expect ")) {
+            QString key = line.section(' ', 1, 1);
+            corpus.expected[key].append(line.section(' ', 2));
+            continue;
+        }
+        
+        QStringList words = line.split(' ', Qt::SkipEmptyParts);
+        bool ok = words.size() == 4;
+        for (const QString& word : words) {
+            bool wordOk = false;
+            corpus.blocks.push_back(word.toUShort(&wordOk, 16));
+            ok = ok && wordOk;
+        }
+        if (!ok) {
+            std::cerr << path.toStdString() << ":" << lineNumber << ": expected 4 hex blocks"
+                      << std::endl;
+            return false;
+        }
+    }
+    
+    return corpus.groups() > 0;
+}
+
+// Information word plus check bits, i.e. the remainder of info * x^10 by
+// g(x) = x^10+x^8+x^7+x^5+x^4+x^3+1, with the block's offset word added
+static uint32_t encodeBlock(uint16_t info, uint16_t offset) {
+    uint32_t word = static_cast<uint32_t>(info) << 10;
+    uint32_t remainder = word;
+    for (int bit = 25; bit >= 10; bit--) {
+        if (remainder & (1u << bit)) {
+            remainder ^= 0x5B9u << (bit - 10);
+        }
+    }
+    return word | ((remainder ^ offset) & 0x3FF);
+}
+
+// One bit per byte as replayBits() takes them. A copy of the first group goes
+// in front so block sync is found before the corpus starts. Every 7th block
+// gets a single bit error and every 11th a 2 bit burst; both must be corrected.
+static std::vector<uint8_t> encodeBitstream(const Corpus& corpus) {
+    std::vector<uint16_t> blocks(corpus.blocks.begin(), corpus.blocks.begin() + 4);
+    blocks.insert(blocks.end(), corpus.blocks.begin(), corpus.blocks.end());
+    
+    std::vector<uint8_t> bits;
+    bits.reserve(blocks.size() * 26);
+    for (size_t k = 0; k < blocks.size(); k++) {
+        size_t position = k % 4;
+        bool versionB = (blocks[k - position + 1] >> 11) & 0x01;
+        const uint16_t offsets[4] = {OFFSET_A, OFFSET_B, versionB ? OFFSET_C_PRIME : OFFSET_C,
+                                     OFFSET_D};
+        uint32_t block = encodeBlock(blocks[k], offsets[position]);
+        
+        if (k >= 4 && k % 7 == 3) {
+            block ^= 1u << ((k * 5) % 26);
+        } else if (k >= 4 && k % 11 == 5) {
+            block ^= 3u << ((k * 3) % 25);
+        }
+        
+        for (int bit = 25; bit >= 0; bit--) {
+            bits.push_back((block >> bit) & 1);
+        }
+    }
+    return bits;
+}
+
+static QString formatFrequencies(const QList<float>& frequencies) {
+    QStringList list;
+    for (float freq : frequencies) {
+        list << QString::number(freq, 'f', 1);
+    }
+    return list.join(' ');
+}
+
+static Results decode(const Corpus& corpus, const std::vector<uint8_t>* bits) {
+    RDSDecoder decoder;
+    Results results;
+    QMap<uint16_t, QString> networks;
+    
+    QObject::connect(&decoder, &RDSDecoder::tmcMessageReceived,
+                     [&](const RDSDecoder::TMCMessage& message) {
+        QString text = QString("%1@%2 x%3 %4 d%5")
+                           .arg(message.event).arg(message.location).arg(message.extent)
+                           .arg(message.direction ? "-" : "+").arg(message.duration);
+        for (uint32_t field : message.optionalContent) {
+            text += QString(" %1").arg(field, 7, 16, QChar('0')).toUpper();
+        }
+        results["tmc"] << text;
+    });
+    
+    QObject::connect(&decoder, &RDSDecoder::otherNetworkUpdated,
+                     [&](uint16_t pi, const RDSDecoder::OtherNetwork& network) {
+        networks[pi] = QString("%1 %2 pty %3: %4")
+                           .arg(QString("%1").arg(pi, 4, 16, QChar('0')).toUpper())
+                           .arg(network.ps).arg(network.pty)
+                           .arg(formatFrequencies(network.frequencies));
+    });
+    
+    QObject::connect(&decoder, &DigitalDecoder::dataDecoded, [&](const QVariantMap& data) {
+        if (data["type"].toString() != "RDS_AF") {
+            return;
+        }
+        QList<float> frequencies;
+        for (const QVariant& freq : data["frequencies"].toList()) {
+            frequencies << freq.toFloat();
+        }
+        QString method = data["method"].toString();
+        if (method == "B") {
+            method += " " + QString::number(data["tuned"].toFloat(), 'f', 1);
+        }
+        results["af"] = QStringList(method + ": " + formatFrequencies(frequencies));
+    });
+    
+    if (bits) {
+        decoder.replayBits(bits->data(), bits->size());
+    } else {
+        decoder.replayGroups(corpus.blocks.data(), corpus.groups());
+    }
+    
+    uint16_t pin = decoder.getProgramItemNumber();
+    results["ps"] << decoder.getProgramService();
+    results["rt"] << decoder.getRadioText();
+    results["ptyn"] << decoder.getProgramTypeNameLabel();
+    results["pin"] << QString("%1 %2:%3").arg((pin >> 11) & 0x1F)
+                          .arg((pin >> 6) & 0x1F, 2, 10, QChar('0'))
+                          .arg(pin & 0x3F, 2, 10, QChar('0'));
+    results["ecc"] << QString("%1").arg(decoder.getExtendedCountryCode(), 2, 16, QChar('0'))
+                          .toUpper();
+    results["ta"] << QString::number(decoder.hasTrafficAnnouncement() ? 1 : 0);
+    results["eon"] = networks.values();
+    return results;
+}
+
+static bool check(const char* label, const Results& expected, const Results& results) {
+    bool ok = true;
+    for (auto it = expected.constBegin(); it != expected.constEnd(); ++it) {
+        const QStringList actual = results.value(it.key());
+        if (actual != it.value()) {
+            std::cerr << label << ": " << it.key().toStdString() << " expected ["
+                      << it.value().join(" | ").toStdString() << "] got ["
+                      << actual.join(" | ").toStdString() << "]" << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <corpus> [passes]" << std::endl;
+        return 2;
+    }
+    
+    Corpus corpus;
+    if (!loadCorpus(QString::fromLocal8Bit(argv[1]), corpus)) {
+        return 2;
+    }
+    const int passes = (argc > 2) ? std::max(1, atoi(argv[2])) : 200;
+    const std::vector<uint8_t> bits = encodeBitstream(corpus);
+    
+    bool ok = check("groups", corpus.expected, decode(corpus, nullptr));
+    ok = check("bits", corpus.expected, decode(corpus, &bits)) && ok;
+    
+    // Throughput: the whole corpus over and over through one decoder
+    RDSDecoder groupDecoder;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < passes; i++) {
+        groupDecoder.replayGroups(corpus.blocks.data(), corpus.groups());
+    }
+    double groupSeconds = std::max<qint64>(timer.nsecsElapsed(), 1) * 1e-9;
+    
+    RDSDecoder bitDecoder;
+    timer.restart();
+    for (int i = 0; i < passes; i++) {
+        bitDecoder.replayBits(bits.data(), bits.size());
+    }
+    double bitSeconds = std::max<qint64>(timer.nsecsElapsed(), 1) * 1e-9;
+    
+    std::cout << corpus.groups() << " groups, " << passes << " passes" << std::endl;
+    std::cout << "groups: " << static_cast<uint64_t>(passes * corpus.groups() / groupSeconds)
+              << " groups/s" << std::endl;
+    std::cout << "bits:   " << static_cast<uint64_t>(passes * (bits.size() / 104) / bitSeconds)
+              << " groups/s (sync and error correction included)" << std::endl;
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    
+    return ok ? 0 : 1;
+}